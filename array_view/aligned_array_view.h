@@ -0,0 +1,188 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+#include "array_view.h"
+#include "batch.h"
+
+/*
+// A view whose rows are contiguous and each start at a multiple of Align bytes, as over a buffer
+// whose rows are padded to a multiple of the vector register width
+template <typename T, size_t Rank = 1, size_t Align = AV_VECTOR_SIZE>
+class aligned_array_view
+{
+public:
+	static constexpr size_t rank = Rank;
+	static constexpr size_t alignment = Align;
+	using offset_type            = offset<Rank>;
+	using bounds_type            = bounds<Rank>;
+	using size_type              = size_t;
+	using value_type             = T;
+	using pointer                = T*;
+	using reference              = T&;
+
+	constexpr aligned_array_view() noexcept;
+
+	// Each asserts the alignment of the data and of the stride of each row
+	aligned_array_view(pointer ptr, bounds_type bounds);
+	aligned_array_view(pointer ptr, bounds_type bounds, offset_type stride);  // stride[Rank-1] == 1
+	template <typename U>
+	explicit aligned_array_view(const array_view<U, Rank>& rhs);
+	template <typename U>
+	explicit aligned_array_view(const strided_array_view<U, Rank>& rhs);
+
+	template <typename U, size_t A>           // only if A >= Align
+	aligned_array_view(const aligned_array_view<U, Rank, A>& rhs) noexcept;
+
+	// observers
+	constexpr bounds_type bounds() const noexcept;
+	constexpr size_type   size()   const noexcept;
+	constexpr offset_type stride() const noexcept;
+	pointer               data()   const noexcept;  // assumed aligned
+	constexpr strided_array_view<T, Rank> view() const noexcept;
+	operator strided_array_view<U, Rank>() const noexcept;
+
+	// element access
+	constexpr reference operator[](const offset_type& idx) const;
+
+	// slicing and sectioning
+	template <size_t R = Rank>                // only if Rank > 1
+	aligned_array_view<T, Rank-1, Align> operator[](ptrdiff_t slice) const;
+
+	strided_array_view<T, Rank> section(const offset_type& origin, const bounds_type& section_bounds) const;
+	strided_array_view<T, Rank> section(const offset_type& origin) const;
+};
+
+// The least extent of at least `n` elements of T that is a multiple of Align bytes, for padding rows
+template <typename T, size_t Align = AV_VECTOR_SIZE>
+constexpr ptrdiff_t aligned_extent(ptrdiff_t n) noexcept;
+
+// Whether `view` meets the requirements of an aligned_array_view, setting `result` to it if so
+template <size_t Align, typename View>
+bool try_align(const View& view, aligned_array_view<typename View::value_type, View::rank, Align>& result);
+*/
+
+namespace av
+{
+
+template <typename T, size_t Rank = 1, size_t Align = AV_VECTOR_SIZE>
+class aligned_array_view;
+
+template <typename T, size_t Rank, size_t Align>
+struct view_alignment<aligned_array_view<T, Rank, Align>> : std::integral_constant<size_t, Align> {};
+
+namespace {
+
+	// Whether the data of `view` starts at a multiple of Align bytes, and each row does too
+	template <size_t Align, typename T, size_t Rank>
+	bool rows_aligned(const strided_array_view<T, Rank>& view) noexcept
+	{
+		if (reinterpret_cast<std::uintptr_t>(view.data()) % Align != 0) return false;
+		if (view.stride()[Rank-1] != 1 && view.bounds()[Rank-1] > 1) return false;
+		for (size_t dim=0; dim+1<Rank; ++dim) {
+			if ((view.stride()[dim] * std::ptrdiff_t(sizeof(T))) % std::ptrdiff_t(Align) != 0) return false;
+		}
+		return true;
+	}
+
+} // namespace
+
+// Alignment is checked once, as the view is made, after which it holds of every row of the view and
+// of every slice of it, so kernels over the rows need no runtime checks or peeling to use aligned
+// vector loads.  Sections may start anywhere in a row, so are plain strided views.
+template <typename T, size_t Rank, size_t Align>
+class aligned_array_view
+{
+public:
+	static_assert(Align > 0 && (Align & (Align - 1)) == 0, "Alignment must be a power of two");
+	static_assert(Align >= alignof(T), "Alignment must be at least that of the elements");
+
+	static constexpr size_t rank = Rank;
+	static constexpr size_t alignment = Align;
+	using offset_type            = offset<Rank>;
+	using bounds_type            = av::bounds<Rank>;
+	using size_type              = size_t;
+	using value_type             = T;
+	using pointer                = T*;
+	using reference              = T&;
+
+	constexpr aligned_array_view() noexcept {}
+
+	aligned_array_view(pointer ptr, bounds_type bounds)
+		: aligned_array_view(array_view<T, Rank>(ptr, bounds)) {}
+
+	aligned_array_view(pointer ptr, bounds_type bounds, offset_type stride)
+		: aligned_array_view(strided_array_view<T, Rank>(ptr, bounds, stride)) {}
+
+	template <typename U>
+	explicit aligned_array_view(const array_view<U, Rank>& rhs)
+		: aligned_array_view(strided_array_view<U, Rank>(rhs)) {}
+
+	template <typename U>
+	explicit aligned_array_view(const strided_array_view<U, Rank>& rhs) : view_(rhs)
+	{
+		assert(rows_aligned<Align>(view_) && "Data and rows of an aligned_array_view must be aligned");
+	}
+
+	template <typename U, size_t A, typename = std::enable_if_t<A >= Align>>
+	aligned_array_view(const aligned_array_view<U, Rank, A>& rhs) noexcept : view_(rhs.view()) {}
+
+	// observers
+	constexpr bounds_type bounds() const noexcept { return view_.bounds(); }
+	constexpr size_type   size()   const noexcept { return view_.size(); }
+	constexpr offset_type stride() const noexcept { return view_.stride(); }
+	pointer               data()   const noexcept { return assume_aligned<Align>(view_.data()); }
+	constexpr strided_array_view<T, Rank> view() const noexcept { return view_; }
+
+	template <typename U, typename = std::enable_if_t<std::is_convertible<T(*)[], U(*)[]>::value>>
+	operator strided_array_view<U, Rank>() const noexcept { return view_; }
+
+	// element access
+	constexpr reference operator[](const offset_type& idx) const { return view_[idx]; }
+
+	// slicing and sectioning
+	template <size_t R = Rank, typename = std::enable_if_t< R>=2 >>
+	aligned_array_view<T, Rank-1, Align> operator[](std::ptrdiff_t slice) const
+	{ return aligned_array_view<T, Rank-1, Align>(view_[slice], typename aligned_array_view<T, Rank-1, Align>::aligned_tag{}); }
+
+	strided_array_view<T, Rank> section(const offset_type& origin, const bounds_type& section_bounds) const
+	{ return view_.section(origin, section_bounds); }
+
+	strided_array_view<T, Rank> section(const offset_type& origin) const
+	{ return view_.section(origin); }
+
+private:
+	template <typename U, size_t R, size_t A> friend class aligned_array_view;
+
+	// For a view already known to be aligned
+	struct aligned_tag {};
+	aligned_array_view(const strided_array_view<T, Rank>& view, aligned_tag) noexcept : view_(view) {}
+
+	strided_array_view<T, Rank> view_;
+};
+
+template <typename T, size_t Align = AV_VECTOR_SIZE>
+constexpr std::ptrdiff_t aligned_extent(std::ptrdiff_t n) noexcept
+{
+	static_assert(Align % sizeof(T) == 0, "Alignment must be a multiple of the element size");
+	return (n + std::ptrdiff_t(Align / sizeof(T)) - 1) / std::ptrdiff_t(Align / sizeof(T)) * std::ptrdiff_t(Align / sizeof(T));
+}
+
+template <size_t Align, typename View>
+bool try_align(const View& view, aligned_array_view<typename View::value_type, View::rank, Align>& result)
+{
+	const strided_array_view<typename View::value_type, View::rank> sav(view);
+	if (!rows_aligned<Align>(sav)) return false;
+
+	result = aligned_array_view<typename View::value_type, View::rank, Align>(sav);
+	return true;
+}
+
+}
@@ -0,0 +1,112 @@
+#include "array_view/aligned_array_view.h"
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace av;
+
+namespace {
+
+	bool is_aligned(const void* ptr, size_t align)
+	{
+		return reinterpret_cast<uintptr_t>(ptr) % align == 0;
+	}
+
+	// A buffer whose first element is aligned to 64 bytes
+	struct padded_buffer
+	{
+		explicit padded_buffer(size_t n) : storage(n + 16)
+		{
+			size_t skip = 0;
+			while (!is_aligned(storage.data() + skip, 64)) ++skip;
+			data = storage.data() + skip;
+		}
+
+		vector<float> storage;
+		float* data;
+	};
+
+} // namespace
+
+TEST(aligned_array_view_test, PaddedRows)
+{
+	// Rows of 13 floats, padded to a multiple of 32 bytes
+	const ptrdiff_t rows = 5, columns = 13;
+	const ptrdiff_t pitch = aligned_extent<float, 32>(columns);
+	EXPECT_EQ(16, pitch);
+	EXPECT_EQ(8, (aligned_extent<float, 32>(8)));
+	EXPECT_EQ(0, (aligned_extent<float, 32>(0)));
+
+	padded_buffer buffer(size_t(rows * pitch));
+	iota(buffer.data, buffer.data + rows * pitch, 0.f);
+
+	const aligned_array_view<float, 2, 32> av(buffer.data, {rows, columns}, {pitch, 1});
+	EXPECT_EQ((bounds<2>{rows, columns}), av.bounds());
+	EXPECT_EQ((offset<2>{pitch, 1}), av.stride());
+	EXPECT_EQ(buffer.data, av.data());
+	EXPECT_EQ(float(3 * pitch + 4), (av[{3, 4}]));
+
+	// Every slice keeps its alignment..
+	for (ptrdiff_t i=0; i<rows; ++i)
+	{
+		const aligned_array_view<float, 1, 32> row = av[i];
+		EXPECT_TRUE(is_aligned(row.data(), 32));
+		EXPECT_EQ(columns, row.bounds()[0]);
+		EXPECT_EQ(float(i * pitch + 12), (row[{12}]));
+	}
+
+	// ..while a section is a plain strided view
+	const strided_array_view<float, 2> section = av.section({1, 3}, {2, 2});
+	EXPECT_EQ(float(pitch + 3), (section[{0, 0}]));
+
+	// A view may drop to a lower alignment, add const, or convert to a strided view
+	const aligned_array_view<const float, 2, 16> lower = av;
+	EXPECT_EQ(av.data(), lower.data());
+	const strided_array_view<const float, 2> sav = av;
+	EXPECT_EQ((av[{4, 12}]), (sav[{4, 12}]));
+}
+
+TEST(aligned_array_view_test, TryAlign)
+{
+	padded_buffer buffer(64 * 64);
+
+	// Contiguous rows of 16 floats start at each multiple of 64 bytes
+	aligned_array_view<float, 2, 64> result;
+	EXPECT_TRUE((try_align<64>(array_view<float, 2>(buffer.data, {8, 16}), result)));
+	EXPECT_EQ(buffer.data, result.data());
+
+	// Rows of 12 floats do not, nor does data offset by an element, nor strided rows
+	EXPECT_FALSE((try_align<64>(array_view<float, 2>(buffer.data, {8, 12}), result)));
+	aligned_array_view<float, 2, 16> lower;
+	EXPECT_TRUE((try_align<16>(array_view<float, 2>(buffer.data, {8, 12}), lower)));
+	EXPECT_FALSE((try_align<64>(array_view<float, 2>(buffer.data + 1, {8, 16}), result)));
+	EXPECT_FALSE((try_align<64>(strided_array_view<float, 2>(buffer.data, {8, 8}, {16, 2}), result)));
+}
+
+TEST(aligned_array_view_test, Copy)
+{
+	// Copies between aligned views, as pass their alignment on to the copy of each row
+	const ptrdiff_t rows = 6, columns = 21, pitch = aligned_extent<float>(columns);
+	padded_buffer from(size_t(rows * pitch)), to(size_t(rows * pitch));
+	iota(from.data, from.data + rows * pitch, 1.f);
+	fill(to.data, to.data + rows * pitch, 0.f);
+
+	const aligned_array_view<const float, 2> src(from.data, {rows, columns}, {pitch, 1});
+	const aligned_array_view<float, 2> dst(to.data, {rows, columns}, {pitch, 1});
+	EXPECT_EQ(size_t(AV_VECTOR_SIZE), (view_alignment<aligned_array_view<float, 2>>::value));
+	EXPECT_EQ(alignof(float), (view_alignment<array_view<float, 2>>::value));
+
+	copy(src, dst);
+	for (const offset<2>& idx : dst.bounds()) {
+		ASSERT_EQ((src[idx]), (dst[idx]));
+	}
+	EXPECT_EQ(0.f, to.data[columns]);  // padding is untouched
+
+	float sum = 0;
+	for_each_element(src, [&](float value) { sum += value; });
+	EXPECT_GT(sum, 0.f);
+}
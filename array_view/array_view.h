@@ -28,9 +28,43 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <initializer_list>
+#include <type_traits>
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <vector>
+
+// Software prefetching in the copy and traversal kernels. The distance is the number of elements
+// ahead to prefetch along a strided walk, see `prefetch_distance`.
+#ifndef AV_PREFETCH_DISTANCE
+#define AV_PREFETCH_DISTANCE 8
+#endif
+
+#ifndef AV_CACHE_LINE_SIZE
+#define AV_CACHE_LINE_SIZE 64
+#endif
+
+#ifndef AV_PAGE_SIZE
+#define AV_PAGE_SIZE 4096
+#endif
+
+// Pointers that do not alias, in the kernels over views known to be disjoint
+#if defined(__GNUC__) || defined(_MSC_VER)
+#define AV_RESTRICT __restrict
+#else
+#define AV_RESTRICT
+#endif
+
+#ifdef AV_INSTRUMENT
+#include "instrument.h"
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 /*
 template <size_t Rank>
@@ -121,9 +155,22 @@ public:
 	constexpr size_type size() const noexcept;
 	constexpr bool      contains(const offset<Rank>& idx) const noexcept;
 
+	// linear (row-major) indices
+	constexpr value_type   linearize(const offset<Rank>& idx) const noexcept;
+	constexpr offset<Rank> delinearize(value_type linear) const noexcept;
+
+	// over spans of indices.  With `stride`, linear indices are converted to and from element
+	// offsets (as for a strided_array_view of these bounds) rather than row-major indices.
+	void linearize(const array_view<const offset<Rank>, 1>& idx, const array_view<value_type, 1>& out) const;
+	void linearize(const array_view<const offset<Rank>, 1>& idx, const offset<Rank>& stride,
+	               const array_view<value_type, 1>& out) const;
+	void delinearize(const array_view<const value_type, 1>& linear, const array_view<offset<Rank>, 1>& out) const;
+	void delinearize(const array_view<const value_type, 1>& linear, const offset<Rank>& stride,
+	                 const array_view<value_type, 1>& out) const;
+
 	// iterators
-	const_iterator begin() const noexcept;
-	const_iterator end() const noexcept;
+	constexpr const_iterator begin() const noexcept;
+	constexpr const_iterator end() const noexcept;
 
 	// element access
 	constexpr reference       operator[](size_type n);
@@ -172,21 +219,21 @@ public:
 	using pointer           = unspecified;
 	using reference         = const offset<Rank>;
 
-	bounds_iterator& operator++();
-	bounds_iterator  operator++(int);
-	bounds_iterator& operator--();
-	bounds_iterator  operator--(int);
+	constexpr bounds_iterator& operator++();
+	constexpr bounds_iterator  operator++(int);
+	constexpr bounds_iterator& operator--();
+	constexpr bounds_iterator  operator--(int);
 
-	bounds_iterator  operator+(difference_type n) const;
-	bounds_iterator& operator+=(difference_type n);
-	bounds_iterator  operator-(difference_type n) const;
-	bounds_iterator& operator-=(difference_type n);
+	constexpr bounds_iterator  operator+(difference_type n) const;
+	constexpr bounds_iterator& operator+=(difference_type n);
+	constexpr bounds_iterator  operator-(difference_type n) const;
+	constexpr bounds_iterator& operator-=(difference_type n);
 
-	difference_type  operator-(const bounds_iterator& rhs) const;
+	constexpr difference_type  operator-(const bounds_iterator& rhs) const;
 
-	reference operator*() const;
-	pointer   operator->() const;
-	reference operator[](difference_type n) const;
+	constexpr reference operator*() const;
+	constexpr pointer   operator->() const;
+	constexpr reference operator[](difference_type n) const;
 };
 
 template <typename T, size_t Rank = 1>
@@ -232,6 +279,11 @@ public:
  	template <size_t R = Rank>                // only if Rank > 1
  	constexpr array_view<T, Rank-1> operator[](ptrdiff_t slice) const;
 
+ 	// The elements at `index` in dimension Dim (or `dim`), without it (extension).  Only if Rank > 1
+ 	template <size_t Dim>
+ 	constexpr strided_array_view<T, Rank-1> slice(ptrdiff_t index) const;
+ 	constexpr strided_array_view<T, Rank-1> slice(size_t dim, ptrdiff_t index) const;
+
   	constexpr strided_array_view<T, Rank>
   	section(const offset_type& origin, const bounds_type& section_bounds) const;
 
@@ -268,6 +320,7 @@ public:
 	constexpr bounds_type bounds() const noexcept;
 	constexpr size_type   size()   const noexcept;
 	constexpr offset_type stride() const noexcept;
+	constexpr pointer     data()   const noexcept;
 
 	// element access
 	constexpr reference operator[](const offset_type& idx) const;
@@ -276,12 +329,59 @@ public:
  	template <size_t R = Rank>                // Only if Rank > 1
 	constexpr strided_array_view<T, Rank-1> operator[](ptrdiff_t slice) const;
 
+	template <size_t Dim>                     // Only if Rank > 1 (extension)
+	constexpr strided_array_view<T, Rank-1> slice(ptrdiff_t index) const;
+	constexpr strided_array_view<T, Rank-1> slice(size_t dim, ptrdiff_t index) const;
+
 	constexpr strided_array_view<T, Rank>
 	section(const offset_type& origin, const bounds_type& section_bounds) const;
 
 	constexpr strided_array_view<T, Rank>
 	section(const offset_type& origin) const;
 };
+
+// reshaping (extension)
+template <size_t NewRank, typename T, size_t Rank>
+constexpr array_view<T, NewRank> reshape(const array_view<T, Rank>& view, const bounds<NewRank>& new_bounds);
+template <size_t NewRank, typename T, size_t Rank>
+constexpr strided_array_view<T, NewRank> reshape(const strided_array_view<T, Rank>& view, const bounds<NewRank>& new_bounds);
+template <typename T, size_t Rank, size_t NewRank>
+constexpr bool try_reshape(const strided_array_view<T, Rank>& view, const bounds<NewRank>& new_bounds,
+                           strided_array_view<T, NewRank>& result);
+
+template <typename T, size_t Rank>
+constexpr array_view<T, 1> flatten(const array_view<T, Rank>& view);
+template <typename T, size_t Rank>
+constexpr strided_array_view<T, 1> flatten(const strided_array_view<T, Rank>& view);
+
+// projection (extension)
+template <typename S, typename C, typename M, size_t Rank>
+constexpr strided_array_view<M, Rank> project(const array_view<S, Rank>& view, M C::* member);
+template <typename S, typename C, typename M, size_t Rank>
+constexpr strided_array_view<M, Rank> project(const strided_array_view<S, Rank>& view, M C::* member);
+
+// element-wise copy and traversal (extension)
+constexpr ptrdiff_t automatic_prefetch = -1;
+constexpr ptrdiff_t prefetch_distance(size_t element_size, ptrdiff_t stride) noexcept;
+
+template <typename SrcView, typename DstView>
+void copy(const SrcView& src, const DstView& dst, ptrdiff_t prefetch = automatic_prefetch);
+
+template <typename View, typename Fn>
+void for_each_element(const View& view, Fn fn, ptrdiff_t prefetch = automatic_prefetch);
+
+// alignment (extension)
+template <typename View>
+struct view_alignment;                    // bytes at which each row of a View starts, by default alignof(value_type)
+
+template <size_t Align, typename T>
+T* assume_aligned(T* ptr) noexcept;
+
+// aliasing (extension)
+enum class overlap { disjoint, identical, partial };
+
+template <typename AView, typename BView>
+overlap may_overlap(const AView& a, const BView& b) noexcept;
 */
 
 namespace av
@@ -318,11 +418,11 @@ public:
 
 	// arithmetic
 	template <size_t R = Rank, typename = std::enable_if_t<R == 1>>
-	constexpr offset& operator++()    { return ++(*this)[0]; }
+	constexpr offset& operator++()    { ++(*this)[0]; return *this; }
 	template <size_t R = Rank, typename = std::enable_if_t<R == 1>>
 	constexpr offset  operator++(int) { return offset<Rank>{(*this)[0]++}; }
 	template <size_t R = Rank, typename = std::enable_if_t<R == 1>>
-	constexpr offset& operator--()    { return --(*this)[0]; }
+	constexpr offset& operator--()    { --(*this)[0]; return *this; }
 	template <size_t R = Rank, typename = std::enable_if_t<R == 1>>
 	constexpr offset  operator--(int) { return offset<Rank>{(*this)[0]--}; }
 
@@ -343,7 +443,8 @@ public:
 	constexpr offset& operator/=(value_type v);
 
 private:
-	std::array<value_type, rank> offset_ = {};
+	// Not std::array, as its elements are not mutable in a constant expression until C++17
+	value_type offset_[rank] = {};
 };
 
 template <size_t Rank>
@@ -351,7 +452,9 @@ constexpr offset<Rank>::offset(std::initializer_list<value_type> il)
 {
 	// Note `il` is not a constant expression, hence the runtime assert for now
 	assert(il.size() == Rank);
-	std::copy(il.begin(), il.end(), offset_.data());
+	for (size_type i=0; i<Rank; ++i) {
+		offset_[i] = il.begin()[i];
+	}
 }
 
 // arithmetic
@@ -457,9 +560,20 @@ public:
 	constexpr size_type size() const noexcept;
 	constexpr bool      contains(const offset<Rank>& idx) const noexcept;
 
+	// linear indices
+	constexpr value_type   linearize(const offset<Rank>& idx) const noexcept;
+	constexpr offset<Rank> delinearize(value_type linear) const noexcept;
+
+	void linearize(const array_view<const offset<Rank>, 1>& idx, const array_view<value_type, 1>& out) const;
+	void linearize(const array_view<const offset<Rank>, 1>& idx, const offset<Rank>& stride,
+	               const array_view<value_type, 1>& out) const;
+	void delinearize(const array_view<const value_type, 1>& linear, const array_view<offset<Rank>, 1>& out) const;
+	void delinearize(const array_view<const value_type, 1>& linear, const offset<Rank>& stride,
+	                 const array_view<value_type, 1>& out) const;
+
 	// iterators
-	const_iterator begin() const noexcept { return const_iterator{*this}; };
-	const_iterator end() const noexcept {
+	constexpr const_iterator begin() const noexcept { return const_iterator{*this}; };
+	constexpr const_iterator end() const noexcept {
 		iterator iter{*this};
 		return iter._setOffTheEnd();
 	}
@@ -476,9 +590,9 @@ public:
 	constexpr bounds& operator/=(value_type v);
 
 private:
-	std::array<value_type, rank> bounds_ = {};
+	value_type bounds_[rank] = {};
 
-	void postcondition() { /* todo */ };
+	constexpr void postcondition() { /* todo */ };
 };
 
 // construction
@@ -487,7 +601,9 @@ constexpr bounds<Rank>::bounds(const std::initializer_list<value_type> il)
 {
 	assert(il.size() == Rank);
 
-	std::copy(il.begin(), il.end(), bounds_.data());
+	for (size_type i=0; i<Rank; ++i) {
+		bounds_[i] = il.begin()[i];
+	}
 	postcondition();
 }
 
@@ -511,6 +627,34 @@ constexpr bool bounds<Rank>::contains(const offset<Rank>& idx) const noexcept
 	return true;
 }
 
+// linear indices
+template <size_t Rank>
+constexpr std::ptrdiff_t bounds<Rank>::linearize(const offset<Rank>& idx) const noexcept
+{
+	assert(contains(idx));
+
+	value_type linear{};
+	for (size_type i=0; i<Rank; ++i) {
+		linear = linear * bounds_[i] + idx[i];
+	}
+	return linear;
+}
+
+template <size_t Rank>
+constexpr offset<Rank> bounds<Rank>::delinearize(value_type linear) const noexcept
+{
+	assert(0 <= linear && linear < static_cast<value_type>(size()));
+
+	offset<Rank> idx;
+	for (int i=(Rank-1); i>0; --i)
+	{
+		idx[i] = linear % bounds_[i];
+		linear /= bounds_[i];
+	}
+	idx[0] = linear;
+	return idx;
+}
+
 // iterators
 // todo
 
@@ -598,11 +742,11 @@ constexpr bounds<Rank> operator/(const bounds<Rank>& lhs, std::ptrdiff_t v)
 { return bounds<Rank>{lhs} /= v; }
 
 template <size_t Rank>
-bounds_iterator<Rank> begin(const bounds<Rank>& b) noexcept 
+constexpr bounds_iterator<Rank> begin(const bounds<Rank>& b) noexcept 
 { return b.begin(); }
 
 template <size_t Rank>
-bounds_iterator<Rank> end(const bounds<Rank>& b) noexcept 
+constexpr bounds_iterator<Rank> end(const bounds<Rank>& b) noexcept 
 { return b.end(); }
 
 
@@ -618,47 +762,53 @@ public:
 
 	static_assert(Rank > 0, "Size of Rank must be greater than 0");
 
-	bounds_iterator(const bounds<Rank> bounds, offset<Rank> off = offset<Rank>()) noexcept
+	constexpr bounds_iterator(const bounds<Rank> bounds, offset<Rank> off = offset<Rank>()) noexcept
 	 : bounds_(bounds), offset_(off) {}
 
-	bool operator==(const bounds_iterator& rhs) const { 
+	constexpr bool operator==(const bounds_iterator& rhs) const { 
 		// Requires *this and rhs are iterators over the same bounds object.
 		return offset_ == rhs.offset_;
 	}
 
-	bounds_iterator& operator++();
-	bounds_iterator  operator++(int);
-	bounds_iterator& operator--();
-	bounds_iterator  operator--(int);
+	constexpr bounds_iterator& operator++();
+	constexpr bounds_iterator  operator++(int);
+	constexpr bounds_iterator& operator--();
+	constexpr bounds_iterator  operator--(int);
 
-	bounds_iterator  operator+(difference_type n) const;
-	bounds_iterator& operator+=(difference_type n);
-	bounds_iterator  operator-(difference_type n) const;
-	bounds_iterator& operator-=(difference_type n);
+	constexpr bounds_iterator  operator+(difference_type n) const;
+	constexpr bounds_iterator& operator+=(difference_type n);
+	constexpr bounds_iterator  operator-(difference_type n) const;
+	constexpr bounds_iterator& operator-=(difference_type n);
 
-	difference_type  operator-(const bounds_iterator& rhs) const;
+	constexpr difference_type  operator-(const bounds_iterator& rhs) const;
 
 	// Note this iterator is not a true random access iterator, nor meets N4512
 	// + operator* returns a value type (and not a reference)
 	// + operator-> returns a pointer to the current value type, which breaks N4512 as this
 	//   must be considered invalidated after any subsequent operation on this iterator
-	reference operator*() const { return offset_; }
-	pointer   operator->() const { return &offset_; }
+	constexpr reference operator*() const { return offset_; }
+	constexpr pointer   operator->() const { return &offset_; }
 
-	reference operator[](difference_type n) const { 
+	constexpr reference operator[](difference_type n) const { 
 		bounds_iterator<Rank> iter(*this);
 		return (iter += n).offset_;
 	}
 
-	bounds_iterator& _setOffTheEnd();
+	constexpr bounds_iterator& _setOffTheEnd();
 
 private:
+	constexpr bounds_iterator& setBeforeTheStart();
+
+	// The position of the current offset in the sequence of iteration, where the off-the-end value
+	// is at bounds_.size() and the before-the-start value is at -1
+	constexpr difference_type linearOffset() const;
+
 	bounds<Rank> bounds_;
 	offset<Rank> offset_;
 };
 
 template <size_t Rank>
-bounds_iterator<Rank> bounds_iterator<Rank>::operator++(int)
+constexpr bounds_iterator<Rank> bounds_iterator<Rank>::operator++(int)
 {
 	bounds_iterator tmp(*this);
 	++(*this);
@@ -666,7 +816,7 @@ bounds_iterator<Rank> bounds_iterator<Rank>::operator++(int)
 }
 
 template <size_t Rank>
-bounds_iterator<Rank>& bounds_iterator<Rank>::operator++()
+constexpr bounds_iterator<Rank>& bounds_iterator<Rank>::operator++()
 {
 	// watchit: dim must be signed in order to fail the condition dim>=0
 	for (int dim=(Rank-1); dim>=0; --dim)
@@ -684,7 +834,7 @@ bounds_iterator<Rank>& bounds_iterator<Rank>::operator++()
 }
 
 template <size_t Rank>
-bounds_iterator<Rank>& bounds_iterator<Rank>::operator--()
+constexpr bounds_iterator<Rank>& bounds_iterator<Rank>::operator--()
 {
 	// watchit: dim must be signed in order to fail the condition dim>=0
 	for (int dim=(Rank-1); dim>=0; --dim)
@@ -696,15 +846,11 @@ bounds_iterator<Rank>& bounds_iterator<Rank>::operator--()
 	}
 	
 	// before-the-start value
-	for (int dim=0; dim<Rank-1; ++dim) {
-		offset_[dim] = 0;
-	}
-	offset_[Rank-1] = -1;
-	return *this;
+	return setBeforeTheStart();
 }
 
 template <size_t Rank>
-bounds_iterator<Rank> bounds_iterator<Rank>::operator--(int)
+constexpr bounds_iterator<Rank> bounds_iterator<Rank>::operator--(int)
 {
 	bounds_iterator tmp(*this);
 	--(*this);
@@ -712,7 +858,7 @@ bounds_iterator<Rank> bounds_iterator<Rank>::operator--(int)
 }
 
 template <size_t Rank>
-bounds_iterator<Rank>& bounds_iterator<Rank>::_setOffTheEnd()
+constexpr bounds_iterator<Rank>& bounds_iterator<Rank>::_setOffTheEnd()
 {
 	for (size_t dim=0; dim<Rank-1; ++dim) {
 		offset_[dim] = bounds_[dim]-1;
@@ -723,79 +869,99 @@ bounds_iterator<Rank>& bounds_iterator<Rank>::_setOffTheEnd()
 }
 
 template <size_t Rank>
-bounds_iterator<Rank>& bounds_iterator<Rank>::operator+=(difference_type n)
+constexpr bounds_iterator<Rank>& bounds_iterator<Rank>::setBeforeTheStart()
 {
-	for (int dim=(Rank-1); dim>=0; --dim)
-	{
-		difference_type remainder = (n + offset_[dim]) % bounds_[dim];
-		n = (n + offset_[dim]) / bounds_[dim];
-		offset_[dim] = remainder;
+	for (size_t dim=0; dim<Rank-1; ++dim) {
+		offset_[dim] = 0;
 	}
-	assert(n == 0);  // no overflow
+	offset_[Rank-1] = -1;
+
+	return *this;
+}
+
+template <size_t Rank>
+constexpr bounds_iterator<Rank>& bounds_iterator<Rank>::operator+=(difference_type n)
+{
+	difference_type linear = linearOffset() + n;
+	const difference_type size = static_cast<difference_type>(bounds_.size());
+	assert(-1 <= linear && linear <= size);  // no overflow
+
+	if (linear == size) return _setOffTheEnd();
+	if (linear == -1) return setBeforeTheStart();
+
+	offset_ = bounds_.delinearize(linear);
 	return *this;
 }
 
 template <size_t Rank>
-bounds_iterator<Rank> bounds_iterator<Rank>::operator+(difference_type n) const
+constexpr bounds_iterator<Rank> bounds_iterator<Rank>::operator+(difference_type n) const
 {
 	bounds_iterator<Rank> iter(*this);
 	return iter += n;
 }
 
 template <size_t Rank>
-bounds_iterator<Rank>& bounds_iterator<Rank>::operator-=(difference_type n)
+constexpr bounds_iterator<Rank>& bounds_iterator<Rank>::operator-=(difference_type n)
 {
-	// take (diminished) radix compliment 
-	auto diminishedRadixComplement = [&]() {
-		for (int dim=(Rank-1); dim>=0; --dim)
-		{
-			offset_[dim] = bounds_[dim] - offset_[dim];
-		}
-	};
-
-	diminishedRadixComplement();
-	*this += n;
-	diminishedRadixComplement();
-
-	return *this;
+	return *this += -n;
 }
 
+
 template <size_t Rank>
-bounds_iterator<Rank> bounds_iterator<Rank>::operator-(difference_type n) const
+constexpr bounds_iterator<Rank> bounds_iterator<Rank>::operator-(difference_type n) const
 {
 	bounds_iterator<Rank> iter(*this);
 	return iter -= n;
 }
 
+template <size_t Rank>
+constexpr typename bounds_iterator<Rank>::difference_type
+bounds_iterator<Rank>::operator-(const bounds_iterator& rhs) const
+{
+	// Requires *this and rhs are iterators over the same bounds object.
+	return linearOffset() - rhs.linearOffset();
+}
+
+template <size_t Rank>
+constexpr typename bounds_iterator<Rank>::difference_type bounds_iterator<Rank>::linearOffset() const
+{
+	difference_type linear{};
+	for (size_t dim=0; dim<Rank; ++dim) {
+		linear = linear * bounds_[dim] + offset_[dim];
+	}
+	return linear;
+}
+
 // Free functions
 
 template <size_t Rank>
-bool operator==(const bounds_iterator<Rank>& lhs, const bounds_iterator<Rank>& rhs)
+constexpr bool operator==(const bounds_iterator<Rank>& lhs, const bounds_iterator<Rank>& rhs)
 { return lhs.operator==(rhs); }
 
 template <size_t Rank>
-bool operator!=(const bounds_iterator<Rank>& lhs, const bounds_iterator<Rank>& rhs)
+constexpr bool operator!=(const bounds_iterator<Rank>& lhs, const bounds_iterator<Rank>& rhs)
 { return !lhs.operator==(rhs); }
 
 template <size_t Rank>
-bool operator<(const bounds_iterator<Rank>& lhs, const bounds_iterator<Rank>& rhs)
+constexpr bool operator<(const bounds_iterator<Rank>& lhs, const bounds_iterator<Rank>& rhs)
 { return rhs - lhs > 0; }
 
 template <size_t Rank>
-bool operator<=(const bounds_iterator<Rank>& lhs, const bounds_iterator<Rank>& rhs)
+constexpr bool operator<=(const bounds_iterator<Rank>& lhs, const bounds_iterator<Rank>& rhs)
 { return !(lhs > rhs); }
 
 template <size_t Rank>
-bool operator>(const bounds_iterator<Rank>& lhs, const bounds_iterator<Rank>& rhs)
+constexpr bool operator>(const bounds_iterator<Rank>& lhs, const bounds_iterator<Rank>& rhs)
 { return rhs < lhs; }
 
 template <size_t Rank>
-bool operator>=(const bounds_iterator<Rank>& lhs, const bounds_iterator<Rank>& rhs)
+constexpr bool operator>=(const bounds_iterator<Rank>& lhs, const bounds_iterator<Rank>& rhs)
 { return !(lhs < rhs); }
 
 template <size_t Rank>
-bounds_iterator<Rank> operator+(typename bounds_iterator<Rank>::difference_type n,
-                                const bounds_iterator<Rank>& rhs);
+constexpr bounds_iterator<Rank> operator+(typename bounds_iterator<Rank>::difference_type n,
+                                          const bounds_iterator<Rank>& rhs)
+{ return rhs + n; }
 
 namespace {
 
@@ -824,6 +990,66 @@ namespace {
 		return data[off];
 	}
 
+	// Calls `fn` with the index to the first element of each row (the innermost dimension) of `b`
+	template <size_t Rank, typename Fn>
+	void for_each_row(const bounds<Rank>& b, Fn&& fn)
+	{
+		if (b.size() == 0) return;
+
+		bounds<Rank> rows{b};
+		rows[Rank-1] = 1;
+		for (const offset<Rank>& idx : rows) {
+			fn(idx);
+		}
+	}
+
+	inline void prefetch_address(const void* ptr) noexcept
+	{
+	#if defined(__GNUC__)
+		__builtin_prefetch(ptr);
+	#else
+		(void)ptr;
+	#endif
+	}
+
+	// Walks `n` steps along a row, calling fn(i) at each.  Each stream (a pointer and the stride it is
+	// walked by) is prefetched the given number of elements ahead, or not at all if zero.
+	template <typename T, typename Fn>
+	void walk_row(std::ptrdiff_t n, T* ptr, std::ptrdiff_t stride, std::ptrdiff_t ahead, Fn&& fn)
+	{
+		std::ptrdiff_t i = 0;
+		if (ahead > 0) {
+			for (; i<n-ahead; ++i) {
+				prefetch_address(ptr + (i + ahead) * stride);
+				fn(i);
+			}
+		}
+		for (; i<n; ++i) {
+			fn(i);
+		}
+	}
+
+	template <typename S, typename D, typename Fn>
+	void walk_row(std::ptrdiff_t n, S* src, std::ptrdiff_t src_stride, std::ptrdiff_t src_ahead,
+	                                D* dst, std::ptrdiff_t dst_stride, std::ptrdiff_t dst_ahead, Fn&& fn)
+	{
+		if (src_ahead == 0) return walk_row(n, dst, dst_stride, dst_ahead, fn);
+		if (dst_ahead == 0) return walk_row(n, src, src_stride, src_ahead, fn);
+
+		std::ptrdiff_t i = 0;
+		for (; i<n-std::max(src_ahead, dst_ahead); ++i) {
+			prefetch_address(src + (i + src_ahead) * src_stride);
+			prefetch_address(dst + (i + dst_ahead) * dst_stride);
+			fn(i);
+		}
+		for (; i<n; ++i) {
+			fn(i);
+		}
+	}
+
+	template <typename S, typename M>
+	using projected_t = std::conditional_t<std::is_const<S>::value, const M, M>;
+
 } // namespace
 
 template <typename T, size_t Rank = 1>
@@ -884,11 +1110,21 @@ public:
  	constexpr offset_type stride() const noexcept;
  	constexpr pointer     data()   const noexcept { return data_; }
 
+#ifdef AV_INSTRUMENT
+ 	reference operator[](const instrument::located_index<offset_type>& located) const
+ 	{
+		const offset_type& idx = located.index;
+		assert(bounds().contains(idx) == true);
+		instrument::detail::record(stats_, "array_view", *this, located.at, &view_access(data_, idx, stride()));
+		return view_access(data_, idx, stride());
+ 	}
+#else
  	constexpr reference operator[](const offset_type& idx) const
  	{
 		assert(bounds().contains(idx) == true); 
 		return view_access(data_, idx, stride());
  	}
+#endif
 
 	// slicing and sectioning
  	template <size_t R = Rank, typename = std::enable_if_t< R>=2 >>
@@ -906,6 +1142,19 @@ public:
   		return array_view<T, Rank-1>(data_ + off, new_bounds);
   	}
 
+ 	template <size_t Dim, size_t R = Rank, typename = std::enable_if_t< R>=2 >>
+ 	constexpr strided_array_view<T, Rank-1> slice(std::ptrdiff_t index) const
+ 	{
+ 		static_assert(Dim < Rank, "Dimension to slice must be less than the rank");
+ 		return strided_array_view<T, Rank>(*this).slice(Dim, index);
+ 	}
+
+ 	template <size_t R = Rank, typename = std::enable_if_t< R>=2 >>
+ 	constexpr strided_array_view<T, Rank-1> slice(size_t dim, std::ptrdiff_t index) const
+ 	{
+ 		return strided_array_view<T, Rank>(*this).slice(dim, index);
+ 	}
+
   	constexpr strided_array_view<T, Rank>
   	section(const offset_type& origin, const bounds_type& section_bounds) const
   	{
@@ -925,6 +1174,9 @@ public:
 private:
 	pointer data_;
 	bounds_type bounds_;
+#ifdef AV_INSTRUMENT
+	mutable instrument::detail::view_record* stats_ = nullptr;
+#endif
 };
 
 template <typename T, size_t Rank>
@@ -961,7 +1213,7 @@ public:
 		: data_{rhs.data()}, bounds_{rhs.bounds()}, stride_{rhs.stride()} {}
 	template <typename U, typename = std::enable_if_t<is_viewable_value<U, value_type>::value>>
 	constexpr strided_array_view(const strided_array_view<U, Rank>& rhs) noexcept
-		: data_{rhs.data_}, bounds_{rhs.bounds()}, stride_{rhs.stride()} {}
+		: data_{rhs.data()}, bounds_{rhs.bounds()}, stride_{rhs.stride()} {}
 
 	constexpr strided_array_view(pointer ptr, bounds_type bounds, offset_type stride)
 		: data_(ptr), bounds_(bounds), stride_(stride)
@@ -973,13 +1225,24 @@ public:
 	constexpr bounds_type bounds() const noexcept { return bounds_; }
 	constexpr size_type   size()   const noexcept { return bounds_.size(); }
 	constexpr offset_type stride() const noexcept { return stride_; }
+	constexpr pointer     data()   const noexcept { return data_; }
 
 	// element access
+#ifdef AV_INSTRUMENT
+	reference operator[](const instrument::located_index<offset_type>& located) const
+	{
+		const offset_type& idx = located.index;
+		assert(bounds().contains(idx) == true);
+		instrument::detail::record(stats_, "strided_array_view", *this, located.at, &view_access(data_, idx, stride_));
+		return view_access(data_, idx, stride_);
+	}
+#else
 	constexpr reference operator[](const offset_type& idx) const
 	{
 		assert(bounds().contains(idx) == true);
 		return view_access(data_, idx, stride_);
 	}
+#endif
 
 	// slicing and sectioning
  	template <size_t R = Rank, typename = std::enable_if_t< R>=2 >>
@@ -1002,6 +1265,30 @@ public:
   		return strided_array_view<T, Rank-1>(data_ + off, new_bounds, new_stride);
 	}
 
+	template <size_t Dim, size_t R = Rank, typename = std::enable_if_t< R>=2 >>
+	constexpr strided_array_view<T, Rank-1> slice(std::ptrdiff_t index) const
+	{
+		static_assert(Dim < Rank, "Dimension to slice must be less than the rank");
+		return slice(Dim, index);
+	}
+
+	// As operator[] does for dimension 0, the remaining dimensions keep their extents and strides
+	template <size_t R = Rank, typename = std::enable_if_t< R>=2 >>
+	constexpr strided_array_view<T, Rank-1> slice(size_t dim, std::ptrdiff_t index) const
+	{
+		assert(dim < Rank && 0 <= index && index < bounds()[dim]);
+
+		av::bounds<Rank-1> new_bounds{};
+		av::offset<Rank-1> new_stride{};
+		for (size_t i=0; i<rank-1; ++i)
+		{
+			new_bounds[i] = bounds()[i < dim ? i : i+1];
+			new_stride[i] = stride()[i < dim ? i : i+1];
+		}
+
+		return strided_array_view<T, Rank-1>(data_ + index * stride()[dim], new_bounds, new_stride);
+	}
+
 	constexpr strided_array_view<T, Rank>
 	section(const offset_type& origin, const bounds_type& section_bounds) const
 	{
@@ -1022,6 +1309,559 @@ private:
 	pointer     data_;
 	bounds_type bounds_;
 	offset_type stride_;
+#ifdef AV_INSTRUMENT
+	mutable instrument::detail::view_record* stats_ = nullptr;
+#endif
 };
 
+
+// Linear indices
+
+namespace {
+
+	// The bound on the magnitude of values converted exactly between integers and doubles below
+	constexpr std::ptrdiff_t exact_double_limit = std::ptrdiff_t{1} << 51;
+
+#if defined(__AVX2__)
+	// Conversions between integers and doubles of magnitude below 2^51, by way of the bits of a
+	// double of 1.5 * 2^52, where the integer fills the low bits of the mantissa
+	inline __m256d int64_to_double(__m256i v)
+	{
+		const __m256d magic = _mm256_set1_pd(6755399441055744.0);
+		return _mm256_sub_pd(_mm256_castsi256_pd(_mm256_add_epi64(v, _mm256_castpd_si256(magic))), magic);
+	}
+
+	inline __m256i double_to_int64(__m256d v)
+	{
+		const __m256d magic = _mm256_set1_pd(6755399441055744.0);
+		return _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(v, magic)), _mm256_castpd_si256(magic));
+	}
+
+	// Delinearizes four linear indices at a time, passing the index in each dimension to
+	// store(i, idx) for the indices from i.  Division in double precision is exact for these
+	// magnitudes, and unlike integer division is vectorized.  Returns the number of indices done.
+	template <size_t Rank, typename Store>
+	std::ptrdiff_t delinearize_by_4(const std::ptrdiff_t* linear, std::ptrdiff_t n, const bounds<Rank>& b, Store store)
+	{
+		__m256d extent[Rank];
+		for (size_t dim=0; dim<Rank; ++dim) {
+			extent[dim] = _mm256_set1_pd(static_cast<double>(b[dim]));
+		}
+
+		std::ptrdiff_t i = 0;
+		for (; i+4<=n; i+=4)
+		{
+			__m256d x = int64_to_double(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(linear + i)));
+			__m256d idx[Rank];
+			for (size_t dim=Rank-1; dim>0; --dim)
+			{
+				const __m256d q = _mm256_floor_pd(_mm256_div_pd(x, extent[dim]));
+				idx[dim] = _mm256_sub_pd(x, _mm256_mul_pd(q, extent[dim]));
+				x = q;
+			}
+			idx[0] = x;
+			store(i, idx);
+		}
+		return i;
+	}
+#endif
+
+} // namespace
+
+// The span forms run over all of the indices with the same bounds and strides, so they can make
+// use of the vector units, and do without the bounds checks of the single forms.
+template <size_t Rank>
+void bounds<Rank>::linearize(const array_view<const offset<Rank>, 1>& idx, const array_view<value_type, 1>& out) const
+{
+	offset<Rank> stride;
+	stride[Rank-1] = 1;
+	for (size_t i=Rank-1; i>0; --i) {
+		stride[i-1] = stride[i] * bounds_[i];
+	}
+	linearize(idx, stride, out);
+}
+
+template <size_t Rank>
+void bounds<Rank>::linearize(const array_view<const offset<Rank>, 1>& idx, const offset<Rank>& stride,
+                             const array_view<value_type, 1>& out) const
+{
+	assert(idx.size() == out.size());
+
+	const offset<Rank>* in = idx.data();
+	value_type* first = out.data();
+	const std::ptrdiff_t n = static_cast<std::ptrdiff_t>(idx.size());
+	for (std::ptrdiff_t i=0; i<n; ++i)
+	{
+		assert(contains(in[i]));
+		value_type linear{};
+		for (size_t dim=0; dim<Rank; ++dim) {
+			linear += in[i][dim] * stride[dim];
+		}
+		first[i] = linear;
+	}
+}
+
+template <size_t Rank>
+void bounds<Rank>::delinearize(const array_view<const value_type, 1>& linear, const array_view<offset<Rank>, 1>& out) const
+{
+	assert(linear.size() == out.size());
+
+	const value_type* in = linear.data();
+	offset<Rank>* first = out.data();
+	const std::ptrdiff_t n = static_cast<std::ptrdiff_t>(linear.size());
+	std::ptrdiff_t i = 0;
+
+#ifndef NDEBUG
+	for (std::ptrdiff_t j=0; j<n; ++j) {
+		assert(0 <= in[j] && in[j] < static_cast<value_type>(size()));
+	}
+#endif
+
+#if defined(__AVX2__)
+	if (static_cast<value_type>(size()) < exact_double_limit)
+	{
+		i = delinearize_by_4(in, n, *this, [&](std::ptrdiff_t at, const __m256d* idx) {
+			alignas(32) value_type values[Rank][4];
+			for (size_t dim=0; dim<Rank; ++dim) {
+				_mm256_store_si256(reinterpret_cast<__m256i*>(values[dim]), double_to_int64(idx[dim]));
+			}
+			for (std::ptrdiff_t k=0; k<4; ++k) {
+				for (size_t dim=0; dim<Rank; ++dim) first[at + k][dim] = values[dim][k];
+			}
+		});
+	}
+#endif
+
+	for (; i<n; ++i) {
+		first[i] = delinearize(in[i]);
+	}
+}
+
+template <size_t Rank>
+void bounds<Rank>::delinearize(const array_view<const value_type, 1>& linear, const offset<Rank>& stride,
+                               const array_view<value_type, 1>& out) const
+{
+	assert(linear.size() == out.size());
+
+	const value_type* in = linear.data();
+	value_type* first = out.data();
+	const std::ptrdiff_t n = static_cast<std::ptrdiff_t>(linear.size());
+	std::ptrdiff_t i = 0;
+
+#ifndef NDEBUG
+	for (std::ptrdiff_t j=0; j<n; ++j) {
+		assert(0 <= in[j] && in[j] < static_cast<value_type>(size()));
+	}
+#endif
+
+#if defined(__AVX2__)
+	// The offsets must also be exact, as must each term of them
+	value_type span = 0;
+	for (size_t dim=0; dim<Rank; ++dim) {
+		span += (bounds_[dim] - 1) * (stride[dim] < 0 ? -stride[dim] : stride[dim]);
+	}
+
+	if (static_cast<value_type>(size()) < exact_double_limit && span < exact_double_limit)
+	{
+		__m256d strides[Rank];
+		for (size_t dim=0; dim<Rank; ++dim) {
+			strides[dim] = _mm256_set1_pd(static_cast<double>(stride[dim]));
+		}
+
+		i = delinearize_by_4(in, n, *this, [&](std::ptrdiff_t at, const __m256d* idx) {
+			__m256d off = _mm256_mul_pd(idx[0], strides[0]);
+			for (size_t dim=1; dim<Rank; ++dim) {
+				off = _mm256_add_pd(off, _mm256_mul_pd(idx[dim], strides[dim]));
+			}
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(first + at), double_to_int64(off));
+		});
+	}
+#endif
+
+	for (; i<n; ++i)
+	{
+		value_type rest = in[i], off = 0;
+		for (size_t dim=Rank-1; dim>0; --dim)
+		{
+			off += (rest % bounds_[dim]) * stride[dim];
+			rest /= bounds_[dim];
+		}
+		first[i] = off + rest * stride[0];
+	}
+}
+
+
+// Reshaping
+
+// Views of contiguous data can always be reshaped, provided the size is unchanged
+template <size_t NewRank, typename T, size_t Rank>
+constexpr array_view<T, NewRank> reshape(const array_view<T, Rank>& view, const bounds<NewRank>& new_bounds)
+{
+	assert(view.size() == new_bounds.size() && "reshape requires the new bounds to be of the same size");
+	return array_view<T, NewRank>(view.data(), new_bounds);
+}
+
+// A strided view can be reshaped without a copy only if each group of dimensions that is merged
+// (or split) is itself contiguous with respect to the strides. Returns false if this is not the
+// case, leaving `result` unmodified.  The approach is as used by NumPy.
+template <typename T, size_t Rank, size_t NewRank>
+constexpr bool try_reshape(const strided_array_view<T, Rank>& view, const bounds<NewRank>& new_bounds,
+                           strided_array_view<T, NewRank>& result)
+{
+	if (view.size() != new_bounds.size()) return false;
+
+	offset<NewRank> new_stride{};
+
+	// Any strides will do for an empty view
+	if (view.size() == 0) {
+		result = strided_array_view<T, NewRank>(view.data(), new_bounds,
+		                                        array_view<T, NewRank>(view.data(), new_bounds).stride());
+		return true;
+	}
+
+	// Dimensions of extent 1 place no constraint on the strides, so drop them
+	std::ptrdiff_t old_bounds[Rank] = {};
+	std::ptrdiff_t old_stride[Rank] = {};
+	size_t old_rank = 0;
+	for (size_t i=0; i<Rank; ++i)
+	{
+		if (view.bounds()[i] != 1) {
+			old_bounds[old_rank] = view.bounds()[i];
+			old_stride[old_rank] = view.stride()[i];
+			++old_rank;
+		}
+	}
+
+	// Match up groups of old dimensions [oi, oj) with groups of new dimensions [ni, nj) of equal size
+	size_t oi = 0, oj = 1, ni = 0, nj = 1;
+	while (ni < NewRank && oi < old_rank)
+	{
+		std::ptrdiff_t np = new_bounds[ni];
+		std::ptrdiff_t op = old_bounds[oi];
+		while (np != op)
+		{
+			if (np < op)
+				np *= new_bounds[nj++];
+			else
+				op *= old_bounds[oj++];
+		}
+
+		for (size_t k=oi; k+1<oj; ++k) {
+			if (old_stride[k] != old_bounds[k+1] * old_stride[k+1]) return false;
+		}
+
+		new_stride[nj-1] = old_stride[oj-1];
+		for (size_t k=nj-1; k>ni; --k) {
+			new_stride[k-1] = new_stride[k] * new_bounds[k];
+		}
+
+		ni = nj++;
+		oi = oj++;
+	}
+
+	// Any trailing dimensions are of extent 1
+	std::ptrdiff_t last_stride = (ni >= 1) ? new_stride[ni-1] : 1;
+	for (size_t k=ni; k<NewRank; ++k) {
+		new_stride[k] = last_stride;
+	}
+
+	result = strided_array_view<T, NewRank>(view.data(), new_bounds, new_stride);
+	return true;
+}
+
+template <size_t NewRank, typename T, size_t Rank>
+constexpr strided_array_view<T, NewRank> reshape(const strided_array_view<T, Rank>& view,
+                                                 const bounds<NewRank>& new_bounds)
+{
+	strided_array_view<T, NewRank> result{};
+	bool reshaped = try_reshape(view, new_bounds, result);
+	assert(reshaped && "reshape requires the strides of the view to permit reshaping without a copy");
+	(void)reshaped;
+	return result;
+}
+
+template <typename T, size_t Rank>
+constexpr array_view<T, 1> flatten(const array_view<T, Rank>& view)
+{
+	return array_view<T, 1>(view.data(), static_cast<std::ptrdiff_t>(view.size()));
+}
+
+template <typename T, size_t Rank>
+constexpr strided_array_view<T, 1> flatten(const strided_array_view<T, Rank>& view)
+{
+	return reshape<1>(view, bounds<1>(static_cast<std::ptrdiff_t>(view.size())));
+}
+
+// Projection
+
+// Views a single data member of each element of `view`.  The member must be such that the stride
+// between elements remains a whole number of members.
+template <typename S, typename C, typename M, size_t Rank,
+          typename = std::enable_if_t<std::is_same<std::remove_cv_t<S>, C>::value>>
+constexpr strided_array_view<projected_t<S, M>, Rank>
+project(const strided_array_view<S, Rank>& view, M C::* member)
+{
+	static_assert(sizeof(C) % sizeof(M) == 0, "Size of the struct must be a multiple of the size of the member");
+
+	constexpr std::ptrdiff_t scale = sizeof(C) / sizeof(M);
+	projected_t<S, M>* data = view.data() ? &(view.data()->*member) : nullptr;
+	return strided_array_view<projected_t<S, M>, Rank>(data, view.bounds(), view.stride() * scale);
+}
+
+template <typename S, typename C, typename M, size_t Rank,
+          typename = std::enable_if_t<std::is_same<std::remove_cv_t<S>, C>::value>>
+constexpr strided_array_view<projected_t<S, M>, Rank>
+project(const array_view<S, Rank>& view, M C::* member)
+{
+	return project(strided_array_view<S, Rank>(view), member);
+}
+
+// Alignment
+
+// The alignment, in bytes, at which each row of a view of type View is known to start.  Views that
+// guarantee more than the alignment of their elements specialize this, and `copy` and
+// `for_each_element` pass it on to the compiler.
+template <typename View>
+struct view_alignment : std::integral_constant<size_t, alignof(typename View::value_type)> {};
+
+// Returns `ptr`, which the compiler may then assume to be aligned to Align bytes
+template <size_t Align, typename T>
+T* assume_aligned(T* ptr) noexcept
+{
+	static_assert(Align > 0 && (Align & (Align - 1)) == 0, "Alignment must be a power of two");
+	assert(reinterpret_cast<std::uintptr_t>(ptr) % Align == 0);
+#if defined(__GNUC__)
+	return static_cast<T*>(__builtin_assume_aligned(ptr, Align));
+#else
+	return ptr;
+#endif
+}
+
+// Aliasing
+
+enum class overlap
+{
+	disjoint,   // no element of either view shares a byte with an element of the other
+	identical,  // each index of both views is the same element
+	partial     // otherwise, as elements of the views may share bytes
+};
+
+namespace {
+
+	inline std::ptrdiff_t stride_gcd(std::ptrdiff_t a, std::ptrdiff_t b) noexcept
+	{
+		while (b != 0)
+		{
+			const std::ptrdiff_t r = a % b;
+			a = b;
+			b = r;
+		}
+		return a < 0 ? -a : a;
+	}
+
+	// The bytes [first, last) that the elements of a view lie within, and the greatest common
+	// divisor of its strides in bytes, which the offset between any two elements is a multiple of
+	struct byte_extent
+	{
+		std::uintptr_t first;
+		std::uintptr_t last;
+		std::ptrdiff_t step;
+	};
+
+	template <typename T, size_t Rank>
+	byte_extent byte_extent_of(const strided_array_view<T, Rank>& view) noexcept
+	{
+		const std::ptrdiff_t size = sizeof(T);
+		std::ptrdiff_t low = 0, high = 0, step = 0;
+		for (size_t dim=0; dim<Rank; ++dim)
+		{
+			if (view.bounds()[dim] < 2) continue;
+			const std::ptrdiff_t span = (view.bounds()[dim] - 1) * view.stride()[dim] * size;
+			(span < 0 ? low : high) += span;
+			step = stride_gcd(step, view.stride()[dim] * size);
+		}
+		const std::uintptr_t origin = reinterpret_cast<std::uintptr_t>(view.data());
+		return {origin + low, origin + high + size, step};
+	}
+
+	template <typename A, typename B, size_t Rank>
+	bool same_elements(const strided_array_view<A, Rank>& a, const strided_array_view<B, Rank>& b) noexcept
+	{
+		if (sizeof(A) != sizeof(B) || static_cast<const void*>(a.data()) != static_cast<const void*>(b.data())) return false;
+		if (a.bounds() != b.bounds()) return false;
+		for (size_t dim=0; dim<Rank; ++dim) {
+			if (a.bounds()[dim] > 1 && a.stride()[dim] != b.stride()[dim]) return false;
+		}
+		return true;
+	}
+
+	template <typename A, typename B, size_t RankA, size_t RankB>
+	bool same_elements(const strided_array_view<A, RankA>&, const strided_array_view<B, RankB>&) noexcept
+	{
+		return false;
+	}
+
+} // namespace
+
+// Whether two views may share any bytes, from their data, bounds and strides alone.  Views whose
+// byte ranges do not meet are disjoint, as are views whose elements interleave without meeting, such
+// as the odd and even columns of an array, or two members projected from the same array of structs.
+// The result is exact for such views, and otherwise conservative: `partial` views may still share no
+// bytes.
+template <typename AView, typename BView>
+overlap may_overlap(const AView& a, const BView& b) noexcept
+{
+	using A = typename AView::value_type;
+	using B = typename BView::value_type;
+	const strided_array_view<const A, AView::rank> sa(a);
+	const strided_array_view<const B, BView::rank> sb(b);
+
+	if (sa.size() == 0 || sb.size() == 0) return overlap::disjoint;
+
+	const byte_extent ea = byte_extent_of(sa);
+	const byte_extent eb = byte_extent_of(sb);
+	if (ea.last <= eb.first || eb.last <= ea.first) return overlap::disjoint;
+
+	if (same_elements(sa, sb)) return overlap::identical;
+
+	// Elements of both views start at their first element plus a multiple of the step common to
+	// both, so views whose elements start at different offsets modulo the step, far enough apart
+	// that neither reaches the other, never meet
+	const std::ptrdiff_t step = stride_gcd(ea.step, eb.step);
+	if (step > 0)
+	{
+		const std::ptrdiff_t apart = static_cast<std::ptrdiff_t>(reinterpret_cast<std::uintptr_t>(sb.data()) -
+		                                                          reinterpret_cast<std::uintptr_t>(sa.data()));
+		const std::ptrdiff_t d = (apart % step + step) % step;
+		if (d >= std::ptrdiff_t(sizeof(A)) && step - d >= std::ptrdiff_t(sizeof(B))) return overlap::disjoint;
+	}
+	return overlap::partial;
+}
+
+// Copy and traversal
+
+constexpr std::ptrdiff_t automatic_prefetch = -1;
+
+// The number of elements ahead to prefetch when walking elements of size `element_size` spaced
+// `stride` elements apart, or zero for none.  Walks within a couple of cache lines per step are left
+// to the hardware prefetcher.  As that never crosses a page boundary, walks of a page or more per
+// step look twice as far ahead, to cover the additional TLB miss.
+constexpr std::ptrdiff_t prefetch_distance(size_t element_size, std::ptrdiff_t stride) noexcept
+{
+	const std::ptrdiff_t step = (stride < 0 ? -stride : stride) * static_cast<std::ptrdiff_t>(element_size);
+	return step <= 2 * AV_CACHE_LINE_SIZE ? 0 :
+	       step <  AV_PAGE_SIZE           ? AV_PREFETCH_DISTANCE : 2 * AV_PREFETCH_DISTANCE;
+}
+
+namespace {
+
+	template <typename T>
+	constexpr std::ptrdiff_t prefetch_ahead(std::ptrdiff_t prefetch, std::ptrdiff_t stride) noexcept
+	{
+		// A distance given explicitly is taken for any row that is not contiguous
+		return prefetch == automatic_prefetch ? prefetch_distance(sizeof(T), stride) :
+		       stride == 1 || stride == -1 ? 0 : prefetch;
+	}
+
+} // namespace
+
+namespace {
+
+	// A row of views known to be disjoint, so the compiler may vectorize without checking
+	template <typename S, typename D>
+	void copy_disjoint_row(S* AV_RESTRICT first, D* AV_RESTRICT out, std::ptrdiff_t n)
+	{
+		for (std::ptrdiff_t i=0; i<n; ++i) {
+			out[i] = first[i];
+		}
+	}
+
+} // namespace
+
+// Copies each element of `src` to the same index in `dst`, which must be of the same bounds. Each
+// row is copied as a tight loop, so together with `project` this converts between an array of
+// structs and a struct of arrays, in either direction.  Rows that are not contiguous are prefetched
+// `prefetch` elements ahead where it is given, or else by the distance of `prefetch_distance`, which
+// leaves rows of small stride to the hardware.
+//
+// The views may overlap: as given by `may_overlap`, disjoint views are copied with rows known not
+// to alias, identical views element by element in place, and views that partially overlap by way
+// of a temporary copy of `src`.
+template <typename SrcView, typename DstView>
+void copy(const SrcView& src, const DstView& dst, std::ptrdiff_t prefetch = automatic_prefetch)
+{
+	constexpr size_t Rank = SrcView::rank;
+	static_assert(Rank == DstView::rank, "Rank of the source and destination views must match");
+
+	using S = typename SrcView::value_type;
+	using D = typename DstView::value_type;
+	strided_array_view<S, Rank> from(src);
+	strided_array_view<D, Rank> to(dst);
+
+	assert(from.bounds() == to.bounds());
+
+	const overlap aliasing = may_overlap(from, to);
+	if (aliasing == overlap::identical && std::is_same<std::remove_cv_t<S>, D>::value) return;
+	if (aliasing == overlap::partial)
+	{
+		std::vector<std::remove_cv_t<S>> buffer(from.size());
+		const array_view<std::remove_cv_t<S>, Rank> temporary(buffer.data(), from.bounds());
+		copy(from, temporary, prefetch);
+		copy(temporary, to, prefetch);
+		return;
+	}
+
+	const std::ptrdiff_t n = from.bounds()[Rank-1];
+	const std::ptrdiff_t from_stride = from.stride()[Rank-1];
+	const std::ptrdiff_t to_stride = to.stride()[Rank-1];
+	const std::ptrdiff_t from_ahead = prefetch_ahead<S>(prefetch, from_stride);
+	const std::ptrdiff_t to_ahead = prefetch_ahead<D>(prefetch, to_stride);
+
+	for_each_row(from.bounds(), [&](const offset<Rank>& idx) {
+		S* first = assume_aligned<view_alignment<SrcView>::value>(&view_access(from.data(), idx, from.stride()));
+		D* out = assume_aligned<view_alignment<DstView>::value>(&view_access(to.data(), idx, to.stride()));
+
+		if (from_stride == 1 && to_stride == 1 && aliasing == overlap::disjoint) {
+			copy_disjoint_row(first, out, n);
+		}
+		else if (from_stride == 1 && to_stride == 1) {
+			for (std::ptrdiff_t i=0; i<n; ++i) {
+				out[i] = first[i];
+			}
+		}
+		else {
+			walk_row(n, first, from_stride, from_ahead, out, to_stride, to_ahead, [&](std::ptrdiff_t i) {
+				out[i * to_stride] = first[i * from_stride];
+			});
+		}
+	});
+}
+
+// Calls fn(element) for each element of `view`, in the order of its bounds.  Rows that are not
+// contiguous are prefetched as for `copy`.
+template <typename View, typename Fn>
+void for_each_element(const View& view, Fn fn, std::ptrdiff_t prefetch = automatic_prefetch)
+{
+	constexpr size_t Rank = View::rank;
+	using T = typename View::value_type;
+	strided_array_view<T, Rank> sav(view);
+
+	const std::ptrdiff_t n = sav.bounds()[Rank-1];
+	const std::ptrdiff_t stride = sav.stride()[Rank-1];
+	const std::ptrdiff_t ahead = prefetch_ahead<T>(prefetch, stride);
+
+	for_each_row(sav.bounds(), [&](const offset<Rank>& idx) {
+		T* first = assume_aligned<view_alignment<View>::value>(&view_access(sav.data(), idx, sav.stride()));
+
+		if (stride == 1) {
+			for (std::ptrdiff_t i=0; i<n; ++i) {
+				fn(first[i]);
+			}
+		}
+		else {
+			walk_row(n, first, stride, ahead, [&](std::ptrdiff_t i) { fn(first[i * stride]); });
+		}
+	});
+}
+
 }
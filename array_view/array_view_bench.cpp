@@ -0,0 +1,1079 @@
+#include "array_view/aligned_array_view.h"
+#include "array_view/array_view.h"
+#include "array_view/atomic_array_view.h"
+#include "array_view/batch.h"
+#include "array_view/chunked_array.h"
+#include "array_view/decomposition.h"
+#include "array_view/dynamic_array_view.h"
+#include "array_view/gemm.h"
+#include "array_view/index_array_view.h"
+#include "array_view/io.h"
+#include "array_view/pipeline.h"
+#include "array_view/sampler.h"
+#include "array_view/scan.h"
+#include "array_view/morton.h"
+#include "array_view/numa.h"
+#include "array_view/pages.h"
+#include "array_view/parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace av;
+
+namespace {
+
+// A benchmark runs its workload once per call, returning the number of items processed
+struct benchmark
+{
+	string name;
+	function<size_t()> run;
+};
+
+// Prevents the compiler from optimising away the result of a workload, by letting the value escape
+// to code it cannot see
+template <typename T>
+void keep(const T& value)
+{
+#if defined(__GNUC__)
+	asm volatile("" : : "g"(&value) : "memory");
+#else
+	static const void* volatile sink;
+	sink = &value;
+#endif
+}
+
+// The times per item of repeated runs of a benchmark, as the best (for comparing approaches within a
+// run) and the median and median absolute deviation (for comparing runs, being robust to outliers)
+struct measurement
+{
+	double best;
+	double median;
+	double mad;
+};
+
+double median_of(vector<double> values)
+{
+	sort(values.begin(), values.end());
+	const size_t n = values.size();
+	return n % 2 ? values[n/2] : 0.5 * (values[n/2 - 1] + values[n/2]);
+}
+
+// Each sample runs the workload for at least 5ms, so that short workloads are not at the mercy of
+// the timer or of a single interruption
+measurement measure(const benchmark& bench, int repetitions)
+{
+	bench.run();  // warm up
+
+	const chrono::duration<double, nano> min_sample = chrono::milliseconds(5);
+	vector<double> samples;
+	for (int i=0; i<repetitions; ++i)
+	{
+		size_t items = 0;
+		chrono::duration<double, nano> elapsed{0};
+		auto start = chrono::steady_clock::now();
+		while (elapsed < min_sample)
+		{
+			items += bench.run();
+			elapsed = chrono::steady_clock::now() - start;
+		}
+		samples.push_back(elapsed.count() / max<size_t>(items, 1));
+	}
+
+	const double median = median_of(samples);
+	vector<double> deviations;
+	for (double sample : samples) deviations.push_back(fabs(sample - median));
+	return {*min_element(samples.begin(), samples.end()), median, median_of(deviations)};
+}
+
+vector<int> random_ints(size_t n, int modulo)
+{
+	vector<int> values(n);
+	unsigned s = 1;
+	generate(values.begin(), values.end(), [&] { s = s * 1664525u + 1013904223u; return int((s >> 8) % modulo); });
+	return values;
+}
+
+// The basic operations of views, which every kernel over them relies on, and which the baseline of
+// av_perf_check covers
+
+void core_benchmarks(vector<benchmark>& benchmarks)
+{
+	const ptrdiff_t N = 64;
+	auto data = make_shared<vector<int>>(size_t(N * N * N), 1);
+	const size_t items = data->size();
+
+	benchmarks.push_back({"core/view_access", [=] {
+		const array_view<const int, 3> view(*data, {N, N, N});
+		int sum = 0;
+		for (ptrdiff_t i=0; i<N; ++i) {
+			for (ptrdiff_t j=0; j<N; ++j) {
+				for (ptrdiff_t k=0; k<N; ++k) sum += view[{i, j, k}];
+			}
+		}
+		keep(sum);
+		return items;
+	}});
+	benchmarks.push_back({"core/bounds_iterator", [=] {
+		ptrdiff_t sum = 0;
+		for (const offset<3>& idx : bounds<3>{N, N, N}) sum += idx[2];
+		keep(sum);
+		return items;
+	}});
+	benchmarks.push_back({"core/section_traversal", [=] {
+		const array_view<const int, 3> view(*data, {N, N, N});
+		const strided_array_view<const int, 3> section = view.section({1, 1, 1}, {N-2, N-2, N-2});
+		int sum = 0;
+		for (const offset<3>& idx : section.bounds()) sum += section[idx];
+		keep(sum);
+		return size_t(section.size());
+	}});
+	benchmarks.push_back({"core/slicing", [=] {
+		const array_view<const int, 3> view(*data, {N, N, N});
+		int sum = 0;
+		for (ptrdiff_t i=0; i<N; ++i)
+		{
+			for (ptrdiff_t j=0; j<N; ++j)
+			{
+				const array_view<const int, 1> row = view[i][j];
+				const strided_array_view<const int, 1> column = view.slice<2>(j)[i];
+				for (ptrdiff_t k=0; k<N; ++k) sum += row[k] + column[k];
+			}
+		}
+		keep(sum);
+		return 2 * items;
+	}});
+}
+
+// Histogramming
+
+void histogram_benchmarks(vector<benchmark>& benchmarks)
+{
+	const size_t n = 1 << 22;
+	const unsigned max_threads = max(4u, thread::hardware_concurrency());
+
+	for (int nbins : {16, 1 << 16})
+	{
+		auto samples = make_shared<vector<int>>(random_ints(n, nbins));
+		auto hist = make_shared<vector<float>>(nbins);
+
+		for (unsigned threads=1; threads<=max_threads; threads*=2)
+		{
+			for (auto strategy : {scatter_strategy::shared_atomic, scatter_strategy::privatized})
+			{
+				string name = "histogram/bins:" + to_string(nbins) + "/threads:" + to_string(threads) +
+				              (strategy == scatter_strategy::shared_atomic ? "/atomic" : "/privatized");
+
+				benchmarks.push_back({name, [=] {
+					array_view<float, 1> bins(*hist);
+					const int* s = samples->data();
+					parallel_histogram(bins, n, [s](size_t i) { return offset<1>(s[i]); }, threads, strategy);
+					keep((*hist)[0]);
+					return n;
+				}});
+			}
+		}
+	}
+}
+
+// Column-wise walks of a large 2D array, with and without software prefetching
+
+void prefetch_benchmarks(vector<benchmark>& benchmarks)
+{
+	const ptrdiff_t N = 4096;
+	auto vec = make_shared<vector<float>>(N * N, 1.f);
+	auto dense = make_shared<vector<float>>(N * N);
+
+	for (ptrdiff_t prefetch : {ptrdiff_t{0}, automatic_prefetch})
+	{
+		string suffix = prefetch == 0 ? "/no_prefetch" : "/prefetch";
+
+		benchmarks.push_back({"column_walk/sum" + suffix, [=] {
+			strided_array_view<float, 2> columns(vec->data(), {N,N}, {1,N});
+			float sum = 0.f;
+			for_each_element(columns, [&](float v) { sum += v; }, prefetch);
+			keep(sum);
+			return size_t(N * N);
+		}});
+
+		benchmarks.push_back({"column_walk/copy" + suffix, [=] {
+			strided_array_view<float, 2> columns(vec->data(), {N,N}, {1,N});
+			copy(columns, array_view<float, 2>(*dense, {N,N}), prefetch);
+			keep((*dense)[0]);
+			return size_t(N * N);
+		}});
+	}
+}
+
+// Stencils over row-major data, visited in row-major and in Morton order, the latter by iterator and
+// by morton_order::for_each
+
+template <typename Order>
+struct by_iterator
+{
+	const Order& order;
+
+	template <typename Fn> void operator()(Fn fn) const { for (const auto& idx : order) fn(idx); }
+};
+
+template <typename Order>
+by_iterator<Order> iterate(const Order& order) { return {order}; }
+
+template <size_t Rank>
+struct by_for_each
+{
+	morton_order<Rank> order;
+
+	template <typename Fn> void operator()(Fn fn) const { order.for_each(fn); }
+};
+
+template <typename Traverse>
+size_t box_filter_2d(const Traverse& traverse, array_view<const float, 2> src, array_view<float, 2> dst)
+{
+	// The interior, offset by {1,1}
+	traverse([&](const offset<2>& idx)
+	{
+		const offset<2> centre = idx + offset<2>{1,1};
+		float sum = 0.f;
+		for (ptrdiff_t i=-1; i<=1; ++i) {
+			for (ptrdiff_t j=-1; j<=1; ++j) {
+				sum += src[centre + offset<2>{i,j}];
+			}
+		}
+		dst[centre] = sum * (1.f / 9.f);
+	});
+	return dst.size();
+}
+
+template <typename Traverse>
+size_t laplacian_3d(const Traverse& traverse, array_view<const float, 3> src, array_view<float, 3> dst)
+{
+	traverse([&](const offset<3>& idx)
+	{
+		const offset<3> c = idx + offset<3>{1,1,1};
+		dst[c] = src[c + offset<3>{-1,0,0}] + src[c + offset<3>{1,0,0}] +
+		         src[c + offset<3>{0,-1,0}] + src[c + offset<3>{0,1,0}] +
+		         src[c + offset<3>{0,0,-1}] + src[c + offset<3>{0,0,1}] - 6.f * src[c];
+	});
+	return dst.size();
+}
+
+// Every second access strides by a row, which Morton order keeps within a few cache lines
+template <typename Traverse>
+size_t transpose_2d(const Traverse& traverse, array_view<const float, 2> src, array_view<float, 2> dst)
+{
+	traverse([&](const offset<2>& idx) { dst[{idx[1], idx[0]}] = src[idx]; });
+	return dst.size();
+}
+
+void morton_benchmarks(vector<benchmark>& benchmarks)
+{
+	const ptrdiff_t N = 2048;
+	auto src2d = make_shared<vector<float>>(N * N, 1.f);
+	auto dst2d = make_shared<vector<float>>(N * N);
+	const bounds<2> interior2d = {N-2, N-2};
+
+	benchmarks.push_back({"stencil2d/row_major", [=] {
+		return box_filter_2d(iterate(interior2d), array_view<const float, 2>(*src2d, {N,N}),
+		                                          array_view<float, 2>(*dst2d, {N,N}));
+	}});
+	benchmarks.push_back({"stencil2d/morton", [=] {
+		return box_filter_2d(iterate(morton_order<2>(interior2d)), array_view<const float, 2>(*src2d, {N,N}),
+		                                                            array_view<float, 2>(*dst2d, {N,N}));
+	}});
+	benchmarks.push_back({"stencil2d/morton_for_each", [=] {
+		return box_filter_2d(by_for_each<2>{morton_order<2>(interior2d)}, array_view<const float, 2>(*src2d, {N,N}),
+		                                                                   array_view<float, 2>(*dst2d, {N,N}));
+	}});
+
+	const bounds<2> square = {N, N};
+	benchmarks.push_back({"transpose/row_major", [=] {
+		return transpose_2d(iterate(square), array_view<const float, 2>(*src2d, {N,N}), array_view<float, 2>(*dst2d, {N,N}));
+	}});
+	benchmarks.push_back({"transpose/morton", [=] {
+		return transpose_2d(iterate(morton_order<2>(square)), array_view<const float, 2>(*src2d, {N,N}),
+		                                                       array_view<float, 2>(*dst2d, {N,N}));
+	}});
+	benchmarks.push_back({"transpose/morton_for_each", [=] {
+		return transpose_2d(by_for_each<2>{morton_order<2>(square)}, array_view<const float, 2>(*src2d, {N,N}),
+		                                                              array_view<float, 2>(*dst2d, {N,N}));
+	}});
+
+	const ptrdiff_t M = 192;
+	auto src3d = make_shared<vector<float>>(M * M * M, 1.f);
+	auto dst3d = make_shared<vector<float>>(M * M * M);
+	const bounds<3> interior3d = {M-2, M-2, M-2};
+
+	benchmarks.push_back({"stencil3d/row_major", [=] {
+		return laplacian_3d(iterate(interior3d), array_view<const float, 3>(*src3d, {M,M,M}),
+		                                         array_view<float, 3>(*dst3d, {M,M,M}));
+	}});
+	benchmarks.push_back({"stencil3d/morton", [=] {
+		return laplacian_3d(iterate(morton_order<3>(interior3d)), array_view<const float, 3>(*src3d, {M,M,M}),
+		                                                           array_view<float, 3>(*dst3d, {M,M,M}));
+	}});
+	benchmarks.push_back({"stencil3d/morton_for_each", [=] {
+		return laplacian_3d(by_for_each<3>{morton_order<3>(interior3d)}, array_view<const float, 3>(*src3d, {M,M,M}),
+		                                                                  array_view<float, 3>(*dst3d, {M,M,M}));
+	}});
+}
+
+// A 2D transform, C * X * C^T, of each of many 8x8 blocks, one block at a time and batched
+
+template <typename Value, typename In, typename Out>
+void transform_block(const float (&c)[8][8], const In& in, const Out& out)
+{
+	Value tmp[8][8];
+	for (ptrdiff_t i=0; i<8; ++i) {
+		for (ptrdiff_t j=0; j<8; ++j)
+		{
+			Value sum(0.f);
+			for (ptrdiff_t k=0; k<8; ++k) sum += Value(c[i][k]) * in[{k,j}];
+			tmp[i][j] = sum;
+		}
+	}
+	for (ptrdiff_t i=0; i<8; ++i) {
+		for (ptrdiff_t j=0; j<8; ++j)
+		{
+			Value sum(0.f);
+			for (ptrdiff_t k=0; k<8; ++k) sum += tmp[i][k] * Value(c[j][k]);
+			out[{i,j}] = sum;
+		}
+	}
+}
+
+void batch_benchmarks(vector<benchmark>& benchmarks)
+{
+	const ptrdiff_t N = 1024;
+	auto src = make_shared<vector<float>>(N * N, 1.f);
+	auto dst = make_shared<vector<float>>(N * N);
+	auto origins = make_shared<vector<offset<2>>>();
+	for (ptrdiff_t i=0; i<N; i+=8) {
+		for (ptrdiff_t j=0; j<N; j+=8) {
+			origins->push_back({i, j});
+		}
+	}
+	const bounds<2> block = {8, 8};
+
+	// The DCT-II basis
+	struct basis_matrix { float c[8][8]; };
+	auto basis = make_shared<basis_matrix>();
+	for (int i=0; i<8; ++i) {
+		for (int j=0; j<8; ++j) {
+			basis->c[i][j] = float(cos((2*j + 1) * i * 3.14159265358979 / 16) * (i == 0 ? sqrt(0.125) : 0.5));
+		}
+	}
+
+	benchmarks.push_back({"blocks8x8/per_section", [=] {
+		array_view<const float, 2> in(*src, {N,N});
+		array_view<float, 2> out(*dst, {N,N});
+		for (const offset<2>& origin : *origins) {
+			transform_block<float>(basis->c, in.section(origin, block), out.section(origin, block));
+		}
+		keep((*dst)[N+1]);
+		return size_t(N * N);
+	}});
+
+	benchmarks.push_back({"blocks8x8/batched", [=] {
+		transform_batch<default_lanes<float>>(array_view<const float, 2>(*src, {N,N}), array_view<float, 2>(*dst, {N,N}),
+		                                      array_view<const offset<2>, 1>(*origins), block,
+		                                      [=](auto in, auto out) {
+			transform_block<lanes<float, default_lanes<float>>>(basis->c, in, out);
+		});
+		keep((*dst)[N+1]);
+		return size_t(N * N);
+	}});
+}
+
+// Writing a 64MB array to a file, from contiguous and strided views, against copying to a dense
+// buffer before writing.  The file is truncated by each write, so mostly measures the page cache.
+
+void io_benchmarks(vector<benchmark>& benchmarks)
+{
+	const ptrdiff_t N = 4096;
+	auto vec = make_shared<vector<float>>(N * N, 1.f);
+	auto dense = make_shared<vector<float>>(N * N);
+	const char* tmpdir = getenv("TMPDIR");
+	const string path = string(tmpdir ? tmpdir : "/tmp") + "/av_bench_io";
+
+	benchmarks.push_back({"write/contiguous", [=] {
+		av::write(path, array_view<const float, 2>(*vec, {N,N}));
+		return size_t(N * N);
+	}});
+
+	benchmarks.push_back({"write/columns", [=] {
+		av::write(path, strided_array_view<const float, 2>(vec->data(), {N,N}, {1,N}));
+		return size_t(N * N);
+	}});
+
+	benchmarks.push_back({"write/columns_copied", [=] {
+		copy(strided_array_view<const float, 2>(vec->data(), {N,N}, {1,N}), array_view<float, 2>(*dense, {N,N}));
+		av::write(path, array_view<const float, 2>(*dense, {N,N}));
+		return size_t(N * N);
+	}});
+
+	benchmarks.push_back({"write/half_rows", [=] {
+		av::write(path, array_view<const float, 2>(*vec, {N,N}).section({0,0}, {N,N/2}));
+		return size_t(N * N/2);
+	}});
+}
+
+// Access to a smooth 128^3 volume held compressed in 16^3 chunks, against the dense volume
+
+void chunked_benchmarks(vector<benchmark>& benchmarks)
+{
+	const ptrdiff_t N = 128;
+	const bounds<3> b = {N, N, N};
+	auto dense = make_shared<vector<int>>(b.size());
+	array_view<int, 3> dense_view(*dense, b);
+	for (const offset<3>& idx : b) {
+		dense_view[idx] = int(100 * idx[0] + idx[1] + idx[2] / 8);
+	}
+	// The cache holds a plane of chunks, so that row-major order decompresses each chunk once
+	auto chunked = make_shared<chunked_array<int, 3>>(dense_view, bounds<3>{16, 16, 16}, 64);
+
+	char ratio[32];
+	snprintf(ratio, sizeof(ratio), "/ratio:%.1f", chunked->compression_ratio());
+
+	auto random = make_shared<vector<offset<3>>>();
+	const vector<int> coordinates = random_ints(3 * 4096, int(N));
+	for (size_t i=0; i<coordinates.size(); i+=3) {
+		random->push_back({coordinates[i], coordinates[i+1], coordinates[i+2]});
+	}
+
+	auto row_major_sum = [b](const auto& array) {
+		int sum = 0;
+		for (const offset<3>& idx : b) sum += array[idx];
+		keep(sum);
+		return b.size();
+	};
+	auto random_sum = [random](const auto& array) {
+		int sum = 0;
+		for (const offset<3>& idx : *random) sum += array[idx];
+		keep(sum);
+		return random->size();
+	};
+	auto section_read = [](const auto& read) {
+		vector<int> out(48 * 48 * 48);
+		read(array_view<int, 3>(out, {48, 48, 48}));
+		keep(out[0]);
+		return out.size();
+	};
+
+	benchmarks.push_back({"element/row_major/dense", [=] { return row_major_sum(array_view<const int, 3>(*dense, b)); }});
+	benchmarks.push_back({"element/row_major/chunked" + string(ratio), [=] { return row_major_sum(*chunked); }});
+	benchmarks.push_back({"element/random/dense", [=] { return random_sum(array_view<const int, 3>(*dense, b)); }});
+	benchmarks.push_back({"element/random/chunked" + string(ratio), [=] { return random_sum(*chunked); }});
+
+	benchmarks.push_back({"section48/dense", [=] {
+		return section_read([&](array_view<int, 3> out) {
+			copy(array_view<const int, 3>(*dense, b).section({40,40,40}, out.bounds()), out);
+		});
+	}});
+	benchmarks.push_back({"section48/chunked" + string(ratio), [=] {
+		return section_read([&](array_view<int, 3> out) { chunked->read({40,40,40}, out); });
+	}});
+}
+
+// Slabs through a load -> filter -> reduce pipeline, small enough for the cost of handing slabs
+// between stages to show
+
+void pipeline_benchmarks(vector<benchmark>& benchmarks)
+{
+	for (ptrdiff_t slab_size : {ptrdiff_t{64}, ptrdiff_t{4096}})
+	{
+		benchmarks.push_back({"pipeline/slab:" + to_string(slab_size), [=] {
+			const size_t total = size_t{1} << 22;
+			size_t produced = 0;
+			float sum = 0.f;
+
+			slab_pipeline<float> pipeline({slab_size}, 8);
+			pipeline
+				.source("load", [&](array_view<float> slab) {
+					if (produced >= total) return false;
+					for (ptrdiff_t i=0; i<slab_size; ++i) slab[i] = float(i);
+					produced += slab_size;
+					return true;
+				})
+				.stage("filter", [=](array_view<float> slab) {
+					for (ptrdiff_t i=0; i<slab_size; ++i) slab[i] *= 0.5f;
+				})
+				.stage("reduce", [&](array_view<float> slab) {
+					for (ptrdiff_t i=0; i<slab_size; ++i) sum += slab[i];
+				});
+			pipeline.run();
+
+			keep(sum);
+			return total;
+		}});
+	}
+}
+
+// Converting random linear indices of a 3D bounds to offsets and to element offsets, one at a
+// time and over the whole span
+
+void linearize_benchmarks(vector<benchmark>& benchmarks)
+{
+	const bounds<3> b = {300, 200, 100};
+	const size_t n = 1 << 20;
+	auto linear = make_shared<vector<ptrdiff_t>>();
+	for (int value : random_ints(n, int(b.size()))) linear->push_back(value);
+	auto idx = make_shared<vector<offset<3>>>(n);
+	auto offsets = make_shared<vector<ptrdiff_t>>(n);
+	const offset<3> stride = {40000, 200, 2};
+
+	benchmarks.push_back({"delinearize/single", [=] {
+		for (size_t i=0; i<n; ++i) (*idx)[i] = b.delinearize((*linear)[i]);
+		keep((*idx)[n-1][0]);
+		return n;
+	}});
+	benchmarks.push_back({"delinearize/span", [=] {
+		b.delinearize(*linear, *idx);
+		keep((*idx)[n-1][0]);
+		return n;
+	}});
+	benchmarks.push_back({"delinearize/strided_span", [=] {
+		b.delinearize(*linear, stride, *offsets);
+		keep((*offsets)[n-1]);
+		return n;
+	}});
+	benchmarks.push_back({"linearize/span", [=] {
+		b.linearize(*idx, *offsets);
+		keep((*offsets)[n-1]);
+		return n;
+	}});
+}
+
+// Products of square matrices, by the triple loop over operator[] and by gemm, whose time is per
+// multiply-add
+
+template <typename T>
+void gemm_benchmarks(vector<benchmark>& benchmarks, const char* type)
+{
+	const ptrdiff_t N = 256;
+	auto a = make_shared<vector<T>>(N * N, T(1));
+	auto b = make_shared<vector<T>>(N * N, T(2));
+	auto c = make_shared<vector<T>>(N * N);
+	const size_t items = size_t(N * N * N);
+
+	benchmarks.push_back({string("gemm256/") + type + "/naive", [=] {
+		const array_view<const T, 2> av(*a, {N, N}), bv(*b, {N, N});
+		const array_view<T, 2> cv(*c, {N, N});
+		for (ptrdiff_t i=0; i<N; ++i) {
+			for (ptrdiff_t j=0; j<N; ++j) {
+				T sum = 0;
+				for (ptrdiff_t k=0; k<N; ++k) sum += av[{i,k}] * bv[{k,j}];
+				cv[{i,j}] = sum;
+			}
+		}
+		keep((*c)[N+1]);
+		return items;
+	}});
+	benchmarks.push_back({string("gemm256/") + type + "/gemm", [=] {
+		gemm(array_view<const T, 2>(*a, {N, N}), array_view<const T, 2>(*b, {N, N}), array_view<T, 2>(*c, {N, N}));
+		keep((*c)[N+1]);
+		return items;
+	}});
+	benchmarks.push_back({string("gemm256/") + type + "/gemm_transposed_a", [=] {
+		const strided_array_view<const T, 2> at(a->data(), {N, N}, {1, N});
+		gemm(at, array_view<const T, 2>(*b, {N, N}), array_view<T, 2>(*c, {N, N}));
+		keep((*c)[N+1]);
+		return items;
+	}});
+}
+
+// Cumulative sums along each dimension of a 2D array, by a loop over its bounds and by the scans
+
+void scan_benchmarks(vector<benchmark>& benchmarks)
+{
+	const ptrdiff_t N = 1024;
+	auto src = make_shared<vector<float>>(N * N, 1.f);
+	auto dst = make_shared<vector<float>>(N * N);
+	const size_t items = size_t(N * N);
+
+	for (size_t dim : {0, 1})
+	{
+		const string suffix = dim == 0 ? "/columns" : "/rows";
+		benchmarks.push_back({"scan" + suffix + "/bounds_iterator", [=] {
+			const array_view<const float, 2> in(*src, {N, N});
+			const array_view<float, 2> out(*dst, {N, N});
+			for (const offset<2>& idx : in.bounds())
+			{
+				offset<2> prev = idx;
+				--prev[dim];
+				out[idx] = (idx[dim] == 0 ? 0.f : out[prev]) + in[idx];
+			}
+			keep((*dst)[N+1]);
+			return items;
+		}});
+		benchmarks.push_back({"scan" + suffix + "/inclusive_scan", [=] {
+			const array_view<const float, 2> in(*src, {N, N});
+			const array_view<float, 2> out(*dst, {N, N});
+			if (dim == 0) inclusive_scan<0>(in, out);
+			else inclusive_scan<1>(in, out);
+			keep((*dst)[N+1]);
+			return items;
+		}});
+	}
+
+	auto long_src = make_shared<vector<int64_t>>(size_t{1} << 24, 1);
+	auto long_dst = make_shared<vector<int64_t>>(long_src->size());
+	benchmarks.push_back({"scan/long/serial", [=] {
+		inclusive_scan<0>(array_view<const int64_t>(*long_src), array_view<int64_t>(*long_dst), 1);
+		keep(long_dst->back());
+		return long_src->size();
+	}});
+	benchmarks.push_back({"scan/long/threaded", [=] {
+		inclusive_scan<0>(array_view<const int64_t>(*long_src), array_view<int64_t>(*long_dst));
+		keep(long_dst->back());
+		return long_src->size();
+	}});
+}
+
+// Scaling rows padded to the vector register width in place, as plain strided views and as aligned
+// views
+
+void aligned_benchmarks(vector<benchmark>& benchmarks)
+{
+	const ptrdiff_t rows = 64, columns = 1001, pitch = aligned_extent<float>(columns);
+	auto buffer = make_shared<vector<float>>(size_t(rows * pitch + 64), 1.f);
+	float* data = buffer->data();
+	while (reinterpret_cast<uintptr_t>(data) % AV_VECTOR_SIZE != 0) ++data;
+	const size_t items = size_t(rows * columns);
+
+	benchmarks.push_back({"padded_rows/scale/strided", [=] {
+		for_each_element(strided_array_view<float, 2>(data, {rows, columns}, {pitch, 1}),
+		                 [](float& value) { value = value * 0.5f + 0.5f; });
+		keep(buffer->at(100));
+		return items;
+	}});
+	benchmarks.push_back({"padded_rows/scale/aligned", [=] {
+		for_each_element(aligned_array_view<float, 2>(data, {rows, columns}, {pitch, 1}),
+		                 [](float& value) { value = value * 0.5f + 0.5f; });
+		keep(buffer->at(100));
+		return items;
+	}});
+}
+
+// Copying between disjoint views, as rows known not to alias, and between views that partially
+// overlap, by way of a temporary
+
+void overlap_benchmarks(vector<benchmark>& benchmarks)
+{
+	const ptrdiff_t rows = 512, columns = 1000;
+	auto vec = make_shared<vector<int>>(size_t(2 * rows * columns + 1));
+	const size_t items = size_t(rows * columns);
+
+	benchmarks.push_back({"copy_rows/disjoint", [=] {
+		const array_view<int, 2> from(vec->data(), {rows, columns});
+		const array_view<int, 2> to(vec->data() + rows * columns, {rows, columns});
+		copy(from, to);
+		keep((*vec)[100]);
+		return items;
+	}});
+	benchmarks.push_back({"copy_rows/overlapping", [=] {
+		const array_view<int, 2> from(vec->data(), {rows, columns});
+		const array_view<int, 2> to(vec->data() + 1, {rows, columns});
+		copy(from, to);
+		keep((*vec)[100]);
+		return items;
+	}});
+}
+
+// Parallel passes over a large array, first written by one thread, and placed a slab per node by
+// numa_array.  The two differ only on machines of more than one node.
+
+void numa_benchmarks(vector<benchmark>& benchmarks)
+{
+	const ptrdiff_t rows = 4096, columns = 4096;
+	const unsigned threads = max(1u, thread::hardware_concurrency());
+	const unsigned per_node = max(1u, threads / unsigned(numa_nodes().size()));
+	auto serial = make_shared<vector<float>>(size_t(rows * columns), 1.f);
+	auto placed = make_shared<numa_array<float, 2>>(bounds<2>{rows, columns});
+	for_each_element(placed->view(), [](float& value) { value = 1.f; });
+	const size_t items = size_t(rows * columns);
+
+	benchmarks.push_back({"numa_scale/one_thread_init", [=] {
+		float* data = serial->data();
+		parallel_partition(size_t(rows), threads, [=](unsigned, size_t first, size_t last) {
+			for (size_t i = first * columns; i < last * columns; ++i) data[i] *= 1.0001f;
+		});
+		keep((*serial)[0]);
+		return items;
+	}});
+	benchmarks.push_back({"numa_scale/numa_array", [=] {
+		parallel_for_slabs(*placed, [](array_view<float, 2> section, ptrdiff_t) {
+			for_each_element(section, [](float& value) { value *= 1.0001f; });
+		}, per_node);
+		keep((placed->view()[{0, 0}]));
+		return items;
+	}});
+}
+
+
+// Random reads over 128MB, spanning far more base pages than the TLB holds entries for, but few
+// enough huge pages that most translations hit
+void huge_page_benchmarks(vector<benchmark>& benchmarks)
+{
+	const ptrdiff_t n = ptrdiff_t(32) << 20;
+	const size_t gathers = size_t(1) << 20;
+	auto indices = make_shared<vector<uint32_t>>(gathers);
+	uint32_t state = 2463534242u;
+	for (uint32_t& index : *indices) {
+		state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+		index = state % uint32_t(n);
+	}
+
+	for (page_size_hint hint : {page_size_hint::normal, page_size_hint::transparent_huge})
+	{
+		auto array = make_shared<numa_array<float>>(bounds<1>{n}, numa_placement::first_touch, 1, hint);
+		for_each_element(array->view(), [](float& value) { value = 1.f; });
+		const string name = hint == page_size_hint::normal ? "normal" : "transparent_huge";
+
+		benchmarks.push_back({"tlb_gather/" + name, [=] {
+			const float* data = array->view().data();
+			float sum = 0;
+			for (uint32_t index : *indices) sum += data[index];
+			keep(sum);
+			return gathers;
+		}});
+	}
+}
+
+
+// Refreshing the ghost cells of 16 blocks between iterations of a stencil: by copying every block
+// again from the whole domain, and by exchanging only the faces
+void halo_benchmarks(vector<benchmark>& benchmarks)
+{
+	const bounds<2> domain = {2048, 2048};
+	auto parent = make_shared<vector<float>>(size_t(domain.size()), 1.f);
+	auto blocks = make_shared<block_array<float, 2>>(decomposition<2>(domain, 16, {1, 1}));
+	const size_t items = size_t(domain.size());
+
+	benchmarks.push_back({"halo/scatter", [=] {
+		blocks->scatter(array_view<const float, 2>(*parent, domain));
+		keep((blocks->local({0, 0})[{1, 1}]));
+		return items;
+	}});
+	benchmarks.push_back({"halo/exchange", [=] {
+		blocks->exchange();
+		keep((blocks->local({0, 0})[{1, 1}]));
+		return items;
+	}});
+}
+
+
+// Summing a 3D array held as a dynamic_array_view: by a generic loop over an index of runtime rank,
+// and through visit, by for_each_element on a view of static rank
+void dynamic_rank_benchmarks(vector<benchmark>& benchmarks)
+{
+	const ptrdiff_t N = 128;
+	auto data = make_shared<vector<float>>(size_t(N * N * N), 1.f);
+	const size_t items = data->size();
+
+	benchmarks.push_back({"dynamic_rank/operator[]", [=] {
+		const dynamic_array_view<const float> view(data->data(), {N, N, N});
+		ptrdiff_t idx[max_dynamic_rank] = {};
+		float sum = 0;
+		for (size_t i=0; i<view.size(); ++i)
+		{
+			sum += view[idx];
+			for (size_t dim=view.rank(); dim-- > 0; ) {
+				if (++idx[dim] < view.bounds(dim)) break;
+				idx[dim] = 0;
+			}
+		}
+		keep(sum);
+		return items;
+	}});
+	benchmarks.push_back({"dynamic_rank/visit", [=] {
+		const dynamic_array_view<const float> view(data->data(), {N, N, N});
+		const float sum = visit([](auto v) {
+			float total = 0;
+			for_each_element(v, [&total](float value) { total += value; });
+			return total;
+		}, view);
+		keep(sum);
+		return items;
+	}});
+}
+
+// Bilinear samples of a 1024x1024 image at random coordinates: by four operator[] calls with edge
+// checks, and by the batched sampler.  Then trilinear samples of a 128^3 volume by the sampler.
+void sampler_benchmarks(vector<benchmark>& benchmarks)
+{
+	const ptrdiff_t N = 1024, M = 128, n = ptrdiff_t(1) << 20;
+	auto image = make_shared<vector<float>>(size_t(N * N), 1.f);
+	auto volume = make_shared<vector<float>>(size_t(M * M * M), 1.f);
+	auto out = make_shared<vector<float>>(size_t(n));
+
+	// Coordinates over each, and a little beyond its edges
+	unsigned state = 1;
+	auto random_coords = [&](size_t count, ptrdiff_t extent) {
+		auto coords = make_shared<vector<float>>(count);
+		for (float& c : *coords) {
+			state = state * 1664525u + 1013904223u;
+			c = float(state >> 8) / float(1u << 24) * float(extent + 2) - 1.f;
+		}
+		return coords;
+	};
+	auto coords2 = random_coords(size_t(n * 2), N);
+	auto coords3 = random_coords(size_t(n * 3), M);
+
+	benchmarks.push_back({"sample/bilinear/operator[]", [=] {
+		const array_view<const float, 2> view(*image, {N, N});
+		const float* c = coords2->data();
+		for (ptrdiff_t i=0; i<n; ++i)
+		{
+			const float x = c[2*i], y = c[2*i + 1];
+			const float fx = floor(x), fy = floor(y);
+			const ptrdiff_t x0 = min(max(ptrdiff_t(fx), ptrdiff_t(0)), N-1), x1 = min(max(ptrdiff_t(fx) + 1, ptrdiff_t(0)), N-1);
+			const ptrdiff_t y0 = min(max(ptrdiff_t(fy), ptrdiff_t(0)), N-1), y1 = min(max(ptrdiff_t(fy) + 1, ptrdiff_t(0)), N-1);
+			const float wx = x - fx, wy = y - fy;
+			(*out)[size_t(i)] = (1 - wx) * ((1 - wy) * view[{x0, y0}] + wy * view[{x0, y1}]) +
+			                    wx * ((1 - wy) * view[{x1, y0}] + wy * view[{x1, y1}]);
+		}
+		keep((*out)[0]);
+		return size_t(n);
+	}});
+	benchmarks.push_back({"sample/bilinear/sampler", [=] {
+		const sampler<float, 2> s(array_view<const float, 2>(*image, {N, N}));
+		s(array_view<const float, 2>(*coords2, {n, 2}), array_view<float, 1>(*out, {n}));
+		keep((*out)[0]);
+		return size_t(n);
+	}});
+	benchmarks.push_back({"sample/trilinear/sampler", [=] {
+		const sampler<float, 3> s(array_view<const float, 3>(*volume, {M, M, M}));
+		s(array_view<const float, 2>(*coords3, {n, 3}), array_view<float, 1>(*out, {n}));
+		keep((*out)[0]);
+		return size_t(n);
+	}});
+}
+
+void indirect_benchmarks(vector<benchmark>& benchmarks)
+{
+	// Elements of a lookup table that stays in cache, and rows of a larger table, as an embedding lookup
+	const ptrdiff_t n = ptrdiff_t(1) << 20, L = ptrdiff_t(1) << 14, R = ptrdiff_t(1) << 16, C = 64, rows = ptrdiff_t(1) << 14;
+	auto table = make_shared<vector<float>>(size_t(R * C), 1.f);
+	auto out = make_shared<vector<float>>(size_t(n));
+	auto elements = make_shared<vector<ptrdiff_t>>(size_t(n));
+	auto picks = make_shared<vector<ptrdiff_t>>(size_t(rows));
+
+	unsigned state = 1;
+	auto random_below = [&](ptrdiff_t bound) {
+		state = state * 1664525u + 1013904223u;
+		return ptrdiff_t((state >> 8) % unsigned(bound));
+	};
+	for (ptrdiff_t& e : *elements) e = random_below(L);
+	for (ptrdiff_t& r : *picks) r = random_below(R);
+
+	benchmarks.push_back({"take/elements/operator[]", [=] {
+		const array_view<const float, 1> view(table->data(), {L});
+		for (ptrdiff_t i=0; i<n; ++i) (*out)[size_t(i)] = view[{(*elements)[size_t(i)]}];
+		keep((*out)[0]);
+		return size_t(n);
+	}});
+	benchmarks.push_back({"take/elements/take", [=] {
+		take(array_view<const float, 1>(table->data(), {L}), *elements, 0, array_view<float, 1>(*out, {n}));
+		keep((*out)[0]);
+		return size_t(n);
+	}});
+	benchmarks.push_back({"put/elements/operator[]", [=] {
+		const array_view<float, 1> view(table->data(), {L});
+		for (ptrdiff_t i=0; i<n; ++i) view[{(*elements)[size_t(i)]}] = (*out)[size_t(i)];
+		keep((*table)[0]);
+		return size_t(n);
+	}});
+	benchmarks.push_back({"put/elements/put", [=] {
+		put(array_view<float, 1>(table->data(), {L}), *elements, 0, array_view<const float, 1>(*out, {n}));
+		keep((*table)[0]);
+		return size_t(n);
+	}});
+	benchmarks.push_back({"take/rows/operator[]", [=] {
+		const array_view<const float, 2> view(*table, {R, C});
+		const array_view<float, 2> to(*out, {rows, C});
+		for (ptrdiff_t i=0; i<rows; ++i) {
+			for (ptrdiff_t j=0; j<C; ++j) to[{i, j}] = view[{(*picks)[size_t(i)], j}];
+		}
+		keep((*out)[0]);
+		return size_t(rows * C);
+	}});
+	benchmarks.push_back({"take/rows/take", [=] {
+		take(array_view<const float, 2>(*table, {R, C}), *picks, 0, array_view<float, 2>(*out, {rows, C}));
+		keep((*out)[0]);
+		return size_t(rows * C);
+	}});
+}
+
+// Results as JSON, one benchmark per line, which is also the format of a baseline
+bool write_json(const char* path, const vector<pair<string, measurement>>& results)
+{
+	FILE* file = fopen(path, "w");
+	if (!file) return false;
+
+	fprintf(file, "{\n  \"benchmarks\": [\n");
+	for (size_t i=0; i<results.size(); ++i)
+	{
+		fprintf(file, "    {\"name\": \"%s\", \"median_ns\": %.6g, \"mad_ns\": %.6g, \"best_ns\": %.6g}%s\n",
+		        results[i].first.c_str(), results[i].second.median, results[i].second.mad, results[i].second.best,
+		        i + 1 < results.size() ? "," : "");
+	}
+	fprintf(file, "  ]\n}\n");
+	return fclose(file) == 0;
+}
+
+// Reads the benchmarks of a file written by write_json, failing if it holds none
+bool read_json(const char* path, vector<pair<string, measurement>>& results)
+{
+	FILE* file = fopen(path, "r");
+	if (!file) return false;
+
+	const size_t first = results.size();
+	char line[1024];
+	while (fgets(line, sizeof(line), file))
+	{
+		char name[256];
+		measurement m;
+		if (sscanf(line, " {\"name\": \"%255[^\"]\", \"median_ns\": %lf, \"mad_ns\": %lf, \"best_ns\": %lf",
+		           name, &m.median, &m.mad, &m.best) == 4) {
+			results.emplace_back(name, m);
+		}
+	}
+	fclose(file);
+	return results.size() > first;
+}
+
+// A benchmark regresses when its median is slower than that of the baseline by more than
+// `threshold` (a fraction), and by more than the noise of either run, taken as 3 sigma-scaled MADs
+// of each combined (a MAD times 1.4826 estimates the standard deviation of normally distributed
+// times).  So that a noisy machine reports no regression rather than a false one.
+bool regressed(const measurement& current, const measurement& baseline, double threshold)
+{
+	const double noise = 3 * 1.4826 * sqrt(current.mad * current.mad + baseline.mad * baseline.mad);
+	const double slower = current.median - baseline.median;
+	return slower > threshold * baseline.median && slower > noise;
+}
+
+} // namespace
+
+// Usage: av_bench [options] [filter], running only those benchmarks whose name contains `filter`
+//   --repetitions N     runs of each benchmark to measure (default 5)
+//   --json FILE         writes the results to FILE, as a baseline for later runs
+//   --baseline FILE     compares the results with those of FILE, failing if any regressed or is
+//                       not in it
+//   --threshold PERCENT the slowdown past which a benchmark has regressed (default 10)
+int main(int argc, char* argv[])
+{
+	const char* filter = "";
+	const char* json = nullptr;
+	const char* baseline_path = nullptr;
+	int repetitions = 5;
+	double threshold = 0.10;
+	for (int i=1; i<argc; ++i)
+	{
+		const bool has_value = i + 1 < argc;
+		if (!strcmp(argv[i], "--repetitions") && has_value) repetitions = max(1, atoi(argv[++i]));
+		else if (!strcmp(argv[i], "--json") && has_value) json = argv[++i];
+		else if (!strcmp(argv[i], "--baseline") && has_value) baseline_path = argv[++i];
+		else if (!strcmp(argv[i], "--threshold") && has_value) threshold = atof(argv[++i]) / 100;
+		else filter = argv[i];
+	}
+
+	vector<pair<string, measurement>> baseline;
+	if (baseline_path && !read_json(baseline_path, baseline))
+	{
+		FILE* file = fopen(baseline_path, "r");
+		if (file) {
+			fclose(file);
+			fprintf(stderr, "No benchmarks in the baseline %s\n", baseline_path);
+		}
+		else {
+			fprintf(stderr, "No baseline %s, run av_perf_baseline (or av_bench --json) on this machine first\n", baseline_path);
+		}
+		return 2;
+	}
+
+	vector<benchmark> benchmarks;
+	core_benchmarks(benchmarks);
+	histogram_benchmarks(benchmarks);
+	prefetch_benchmarks(benchmarks);
+	morton_benchmarks(benchmarks);
+	batch_benchmarks(benchmarks);
+	io_benchmarks(benchmarks);
+	chunked_benchmarks(benchmarks);
+	pipeline_benchmarks(benchmarks);
+	linearize_benchmarks(benchmarks);
+	gemm_benchmarks<float>(benchmarks, "float");
+	gemm_benchmarks<double>(benchmarks, "double");
+	scan_benchmarks(benchmarks);
+	aligned_benchmarks(benchmarks);
+	overlap_benchmarks(benchmarks);
+	numa_benchmarks(benchmarks);
+	huge_page_benchmarks(benchmarks);
+	halo_benchmarks(benchmarks);
+	dynamic_rank_benchmarks(benchmarks);
+	sampler_benchmarks(benchmarks);
+	indirect_benchmarks(benchmarks);
+
+	vector<pair<string, measurement>> results;
+	int regressions = 0, unmatched = 0;
+	for (const benchmark& bench : benchmarks)
+	{
+		if (!strstr(bench.name.c_str(), filter)) continue;
+		measurement m = measure(bench, repetitions);
+		auto base = find_if(baseline.begin(), baseline.end(), [&](const pair<string, measurement>& b) { return b.first == bench.name; });
+
+		// A regression must hold of a second measurement, as one by the machine being busy need not
+		if (base != baseline.end() && regressed(m, base->second, threshold))
+		{
+			const measurement again = measure(bench, repetitions);
+			if (again.median < m.median) m = again;
+		}
+
+		results.emplace_back(bench.name, m);
+		printf("%-48s %10.3f ns/item  (median %.3f, MAD %.3f)", bench.name.c_str(), m.best, m.median, m.mad);
+
+		if (baseline_path)
+		{
+			if (base == baseline.end())
+			{
+				++unmatched;
+				printf("  NO BASELINE");
+			}
+			else
+			{
+				const bool slower = regressed(m, base->second, threshold);
+				regressions += slower;
+				printf("  %+6.1f%% against %.3f%s", 100 * (m.median / base->second.median - 1), base->second.median,
+				       slower ? "  REGRESSED" : "");
+			}
+		}
+		printf("\n");
+	}
+
+	if (json && !write_json(json, results)) {
+		fprintf(stderr, "Cannot write %s\n", json);
+		return 2;
+	}
+	fflush(stdout);
+	if (unmatched > 0) {
+		fprintf(stderr, "%d benchmark%s not in the baseline, which av_perf_baseline rewrites\n", unmatched, unmatched > 1 ? "s are" : " is");
+	}
+	if (regressions > 0) {
+		fprintf(stderr, "%d benchmark%s regressed past %.0f%% of the baseline\n", regressions, regressions > 1 ? "s" : "", 100 * threshold);
+	}
+	if (unmatched > 0 || regressions > 0) return 1;
+}
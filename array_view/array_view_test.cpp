@@ -71,6 +71,41 @@ TEST(bounds, contains)
 	EXPECT_FALSE(b.contains({0,0,-1}));
 }
 
+TEST(bounds_test, linearize)
+{
+	bounds<3> b = {2,3,4};
+	EXPECT_EQ(0, b.linearize({0,0,0}));
+	EXPECT_EQ(23, b.linearize({1,2,3}));
+	EXPECT_EQ(17, b.linearize({1,1,1}));
+	EXPECT_EQ((offset<3>{1,1,1}), b.delinearize(17));
+
+	// Spans of every index in turn, of a length that is not a multiple of any vector width
+	bounds<3> c = {5,7,3};
+	vector<offset<3>> idx(c.begin(), c.end());
+	vector<ptrdiff_t> linear(idx.size());
+	c.linearize(idx, linear);
+	for (size_t i=0; i<linear.size(); ++i) EXPECT_EQ(ptrdiff_t(i), linear[i]);
+
+	vector<offset<3>> back(idx.size());
+	c.delinearize(linear, back);
+	EXPECT_EQ(idx, back);
+
+	// To element offsets of a strided view, including negative strides
+	const offset<3> stride = {-40, 6, 1};
+	vector<ptrdiff_t> offsets(idx.size()), expected(idx.size());
+	c.linearize(idx, stride, expected);
+	c.delinearize(linear, stride, offsets);
+	EXPECT_EQ(expected, offsets);
+	EXPECT_EQ(-4*40 + 6*6 + 2, offsets.back());
+
+	bounds<1> d = {9};
+	vector<ptrdiff_t> single = {8, 0, 3, 3, 7};
+	vector<offset<1>> single_idx(single.size());
+	d.delinearize(single, single_idx);
+	EXPECT_EQ(3, single_idx[2][0]);
+	EXPECT_EQ(7, single_idx[4][0]);
+}
+
 TEST(bounds_iterator_test, increment)
 {
 	bounds<3> b = {4,5,6};
@@ -145,6 +180,109 @@ TEST(bounds_iterator_test, difference)
 	EXPECT_EQ(5, off[2]);
 }
 
+TEST(bounds_iterator_test, distance)
+{
+	bounds<3> b = {4,5,9};
+	bounds_iterator<3> iter(b, {2,4,7});
+
+	EXPECT_EQ(25, (iter + 25) - iter);
+	EXPECT_EQ(-25, (iter - 25) - iter);
+	EXPECT_EQ(ptrdiff_t(b.size()), end(b) - begin(b));
+	EXPECT_EQ(end(b), 25 + (end(b) - 25));
+	EXPECT_TRUE(iter < iter + 1);
+	EXPECT_TRUE(end(b) > begin(b));
+	EXPECT_EQ(ptrdiff_t(b.size()), distance(begin(b), end(b)));
+}
+
+namespace {
+
+	// std::array is not mutable in constant expressions until C++17
+	template <typename T, size_t N>
+	struct table
+	{
+		T entries[N];
+	};
+
+	// The offsets of a 3x3x3 stencil, relative to its centre
+	constexpr table<offset<3>, 27> make_stencil()
+	{
+		table<offset<3>, 27> stencil{};
+		size_t i = 0;
+		for (const offset<3>& idx : bounds<3>{3,3,3}) {
+			stencil.entries[i++] = idx - offset<3>{1,1,1};
+		}
+		return stencil;
+	}
+
+	// Bilinear interpolation weights for each of 4x4 sub-pixel positions, in fixed point
+	constexpr table<int, 4*4*4> make_bilinear_weights()
+	{
+		table<int, 4*4*4> weights{};
+		bounds<2> positions = {4,4};
+		for (bounds_iterator<2> iter = positions.begin(); iter != positions.end(); ++iter)
+		{
+			const ptrdiff_t fx = (*iter)[0], fy = (*iter)[1];
+			const ptrdiff_t base = (iter - positions.begin()) * 4;
+			weights.entries[base + 0] = int((4 - fx) * (4 - fy));
+			weights.entries[base + 1] = int((4 - fx) * fy);
+			weights.entries[base + 2] = int(fx * (4 - fy));
+			weights.entries[base + 3] = int(fx * fy);
+		}
+		return weights;
+	}
+
+	constexpr int ramp[3*4] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+	constexpr int sum_of(const strided_array_view<const int, 2>& view)
+	{
+		int sum = 0;
+		for (const offset<2>& idx : view.bounds()) {
+			sum += view[idx];
+		}
+		return sum;
+	}
+
+} // namespace
+
+TEST(ConstantExpression, Tables)
+{
+	constexpr table<offset<3>, 27> stencil = make_stencil();
+	static_assert(stencil.entries[0] == offset<3>{-1,-1,-1}, "");
+	static_assert(stencil.entries[13] == offset<3>{0,0,0}, "");
+	static_assert(stencil.entries[26] == offset<3>{1,1,1}, "");
+	static_assert(stencil.entries[5] == offset<3>{-1,0,1}, "");
+
+	constexpr table<int, 4*4*4> weights = make_bilinear_weights();
+	static_assert(weights.entries[0] == 16, "");
+	static_assert(weights.entries[4*(1*4 + 2) + 3] == 2, "");
+	for (int i=0; i<4*4; ++i) {
+		EXPECT_EQ(16, weights.entries[4*i] + weights.entries[4*i + 1] +
+		              weights.entries[4*i + 2] + weights.entries[4*i + 3]);
+	}
+}
+
+TEST(ConstantExpression, Views)
+{
+	constexpr array_view<const int, 2> view(ramp, {3,4});
+	static_assert(view.size() == 12, "");
+	static_assert(view.stride() == offset<2>{4,1}, "");
+	static_assert(view[{2,1}] == 9, "");
+	static_assert(view[1][3] == 7, "");
+	static_assert(view.slice<1>(2)[1] == 6, "");
+	static_assert(view.section({1,1})[{1,2}] == 11, "");
+	static_assert(flatten(view)[10] == 10, "");
+	static_assert(reshape<2>(view, {6,2})[{4,1}] == 9, "");
+	static_assert(sum_of(view) == 66, "");
+	static_assert(sum_of(view.section({1,2}, {2,2})) == 6 + 7 + 10 + 11, "");
+
+	constexpr bounds_iterator<2> iter = begin(view.bounds()) + 7;
+	static_assert(*iter == offset<2>{1,3}, "");
+	static_assert(iter[-2] == offset<2>{1,1}, "");
+	static_assert(end(view.bounds()) - iter == 5, "");
+
+	EXPECT_EQ(66, sum_of(view));
+}
+
 class ArrayViewTest : public ::testing::Test {
 public:
 	ArrayViewTest() :
@@ -249,6 +387,39 @@ void testSlicing(const ArrayView& av, const offset<3>& testStride)
 	EXPECT_EQ(start3, av[x][y][z]);
 }
 
+template <typename ArrayView>
+void testSlicingAnyDimension(const ArrayView& av, const offset<3>& testStride)
+{
+	// A slice in dimension 0 is the same as operator[]
+	strided_array_view<int, 2> sliced0 = av.template slice<0>(2);
+	EXPECT_EQ(av[2].data(), sliced0.data());
+	EXPECT_EQ(av[2].bounds(), sliced0.bounds());
+
+	// A plane in y, keeping the strides of x and z
+	int y = 5;
+	strided_array_view<int, 2> sliced1 = av.template slice<1>(y);
+	EXPECT_EQ((bounds<2>{av.bounds()[0], av.bounds()[2]}), sliced1.bounds());
+	EXPECT_EQ((offset<2>{testStride[0], testStride[2]}), sliced1.stride());
+	for (const offset<2>& idx : sliced1.bounds()) {
+		EXPECT_EQ((av[{idx[0], y, idx[1]}]), sliced1[idx]);
+	}
+
+	// and in z, chosen at runtime
+	int z = 3;
+	strided_array_view<int, 2> sliced2 = av.slice(2, z);
+	EXPECT_EQ((bounds<2>{av.bounds()[0], av.bounds()[1]}), sliced2.bounds());
+	for (const offset<2>& idx : sliced2.bounds()) {
+		EXPECT_EQ((av[{idx[0], idx[1], z}]), sliced2[idx]);
+	}
+
+	// Cascade to a single line, and a single element
+	strided_array_view<int, 1> line = av.slice(2, z).template slice<0>(1);
+	for (ptrdiff_t j=0; j<av.bounds()[1]; ++j) {
+		EXPECT_EQ((av[{1, j, z}]), line[j]);
+	}
+	EXPECT_EQ((av[{1, 4, z}]), line[4]);
+}
+
 TEST_F(ArrayViewTest, Constructors)
 {
 	int start{};
@@ -268,6 +439,7 @@ TEST_F(ArrayViewTest, Observers)
 TEST_F(ArrayViewTest, Slicing)
 {
 	testSlicing(av, testStride);
+	testSlicingAnyDimension(av, testStride);
 }
 
 TEST_F(ArrayViewTest, Sectioning)
@@ -317,6 +489,7 @@ TEST_F(StridedArrayViewTest, Observers)
 TEST_F(StridedArrayViewTest, Slicing)
 {
 	testSlicing(sav, testStride);
+	testSlicingAnyDimension(sav, testStride);
 }
 
 TEST_F(StridedArrayViewTest, Sectioning)
@@ -354,6 +527,7 @@ TEST_F(StridedDataTest, Observers)
 TEST_F(StridedDataTest, Slicing)
 {
 	testSlicing(strided_sav, testStride);
+	testSlicingAnyDimension(strided_sav, testStride);
 }
 
 TEST_F(StridedDataTest, Sectioning)
@@ -372,6 +546,276 @@ TEST_F(StridedDataTest, Sectioning)
 	testSectioning(sectioned, remainingBounds, origin, testStride);
 }
 
+TEST_F(ArrayViewTest, Reshape)
+{
+	array_view<int, 2> reshaped = reshape<2>(av, {4*8, 12});
+	EXPECT_EQ(av.data(), reshaped.data());
+	EXPECT_EQ((bounds<2>{32, 12}), reshaped.bounds());
+
+	int start{};
+	for (auto& idx : reshaped.bounds()) {
+		EXPECT_EQ(start++, reshaped[idx]);
+	}
+
+	array_view<int, 4> split = reshape<4>(av, {4, 8, 3, 4});
+	EXPECT_EQ((av[{2,5,7}]), (split[{2,5,1,3}]));
+
+	array_view<int, 1> flat = flatten(av);
+	EXPECT_EQ(av.size(), flat.size());
+	EXPECT_EQ((av[{3,7,11}]), flat[static_cast<ptrdiff_t>(av.size()) - 1]);
+}
+
+TEST_F(StridedArrayViewTest, Reshape)
+{
+	// Contiguous strides permit any reshape
+	strided_array_view<int, 2> reshaped = reshape<2>(sav, {4, 8*12});
+	EXPECT_EQ((offset<2>{96, 1}), reshaped.stride());
+	EXPECT_EQ((sav[{3,2,1}]), (reshaped[{3,25}]));
+
+	strided_array_view<int, 1> flat = flatten(sav);
+	EXPECT_EQ(1, flat.stride()[0]);
+	EXPECT_EQ(sav.size(), flat.size());
+
+	// Sections are not contiguous across the merged dimensions
+	strided_array_view<int, 3> sectioned = sav.section({1,2,3}, {2,3,4});
+	strided_array_view<int, 2> result;
+	EXPECT_FALSE(try_reshape(sectioned, bounds<2>{6, 4}, result));
+	EXPECT_FALSE(try_reshape(sectioned, bounds<2>{2, 12}, result));
+	EXPECT_FALSE(try_reshape(sectioned, bounds<2>{3, 8}, result));
+
+	// ..but may still be split, or have unit dimensions added and removed
+	strided_array_view<int, 4> split;
+	ASSERT_TRUE(try_reshape(sectioned, bounds<4>{2, 3, 2, 2}, split));
+	EXPECT_EQ((offset<4>{96, 12, 2, 1}), split.stride());
+	EXPECT_EQ((sectioned[{1,2,3}]), (split[{1,2,1,1}]));
+
+	strided_array_view<int, 5> padded;
+	ASSERT_TRUE(try_reshape(sectioned, bounds<5>{1, 2, 3, 1, 4}, padded));
+	EXPECT_EQ((sectioned[{1,1,2}]), (padded[{0,1,1,0,2}]));
+
+	// Sizes must match
+	EXPECT_FALSE(try_reshape(sectioned, bounds<1>{23}, flat));
+}
+
+TEST_F(StridedDataTest, Reshape)
+{
+	// Every other element is a uniform stride, so dimensions still merge
+	strided_array_view<int, 2> rows = reshape<2>(strided_sav, {4*8, 6});
+	EXPECT_EQ((offset<2>{12, 2}), rows.stride());
+	EXPECT_EQ((strided_sav[{3,1,4}]), (rows[{25,4}]));
+
+	strided_array_view<int, 1> flat = flatten(strided_sav);
+	EXPECT_EQ(2, flat.stride()[0]);
+	EXPECT_EQ((strided_sav[{3,7,5}]), flat[4*8*6 - 1]);
+
+	// ..but not once a section leaves gaps between rows
+	strided_array_view<int, 3> sectioned = strided_sav.section({0,0,1});
+	EXPECT_FALSE(try_reshape(sectioned, bounds<1>{4*8*5}, flat));
+
+	strided_array_view<int, 4> split = reshape<4>(strided_sav, {4, 8, 3, 2});
+	EXPECT_EQ((offset<4>{96, 12, 4, 2}), split.stride());
+	EXPECT_EQ((strided_sav[{3,1,5}]), (split[{3,1,2,1}]));
+}
+
+#ifndef NDEBUG
+TEST_F(StridedDataTest, BadReshape)
+{
+	EXPECT_DEATH(flatten(strided_sav.section({0,0,1})), "");
+	EXPECT_DEATH((reshape<2>(av, {5, 12})), "");
+}
+#endif
+
+struct Particle
+{
+	float x, y, z;
+	int id;
+};
+
+TEST(ArrayView, Projection)
+{
+	vector<Particle> particles(6*4);
+	for (size_t i=0; i<particles.size(); ++i) {
+		particles[i] = Particle{float(i), float(2*i), float(3*i), int(i)};
+	}
+
+	array_view<Particle, 2> av(particles, {6,4});
+	strided_array_view<float, 2> ys = project(av, &Particle::y);
+	EXPECT_EQ((offset<2>{16, 4}), ys.stride());
+	EXPECT_EQ(av.bounds(), ys.bounds());
+
+	for (auto& idx : ys.bounds()) {
+		EXPECT_EQ(av[idx].y, ys[idx]);
+	}
+
+	// Writes through to the original data
+	ys[{2,3}] = -1.f;
+	EXPECT_EQ(-1.f, particles[11].y);
+
+	// Projections compose with slicing and sectioning
+	strided_array_view<int, 1> ids = project(av, &Particle::id)[2];
+	EXPECT_EQ(10, ids[2]);
+	EXPECT_EQ(21, (project(av.section({4,1}), &Particle::id)[{1,0}]));
+
+	// Views of const data project to const members
+	array_view<const Particle, 2> cav(av);
+	strided_array_view<const float, 2> zs = project(cav, &Particle::z);
+	EXPECT_EQ(69.f, (zs[{5,3}]));
+}
+
+TEST(ArrayView, Copy)
+{
+	vector<Particle> particles(6*4);
+	for (size_t i=0; i<particles.size(); ++i) {
+		particles[i] = Particle{float(i), float(2*i), float(3*i), int(i)};
+	}
+	array_view<Particle, 2> aos(particles, {6,4});
+
+	// array of structs to struct of arrays
+	vector<float> xvec(aos.size());
+	array_view<float, 2> xs(xvec, aos.bounds());
+	copy(project(aos, &Particle::x), xs);
+	for (auto& idx : xs.bounds()) {
+		EXPECT_EQ(aos[idx].x, xs[idx]);
+	}
+
+	// ..and back again
+	for (float& x : xvec) {
+		x *= 10.f;
+	}
+	copy(xs, project(aos, &Particle::x));
+	for (size_t i=0; i<particles.size(); ++i) {
+		EXPECT_EQ(10.f * i, particles[i].x);
+		EXPECT_EQ(2.f * i, particles[i].y);
+	}
+
+	// Between two strided views, with conversion
+	vector<double> dvec(3*4);
+	strided_array_view<double, 2> dst(dvec.data(), {3,4}, {1,3});  // transposed
+	copy(project(aos, &Particle::id).section({3,0}), dst);
+	for (auto& idx : dst.bounds()) {
+		EXPECT_EQ(double(4*(idx[0]+3) + idx[1]), dst[idx]);
+	}
+}
+
+TEST(ArrayView, MayOverlap)
+{
+	vector<int> vec(10*8);
+	array_view<int, 2> av(vec, {10,8});
+
+	// Separate rows, and the same view
+	EXPECT_EQ(overlap::disjoint, may_overlap(av.section({0,0}, {5,8}), av.section({5,0}, {5,8})));
+	EXPECT_EQ(overlap::identical, may_overlap(av, av));
+	EXPECT_EQ(overlap::identical, may_overlap(av.section({2,3}), array_view<const int, 2>(av).section({2,3})));
+	EXPECT_EQ(overlap::partial, may_overlap(av.section({0,0}, {6,8}), av.section({5,0}, {5,8})));
+
+	// Interleaved columns, whose ranges meet but elements do not
+	const strided_array_view<int, 2> even(vec.data(), {10,4}, {8,2});
+	const strided_array_view<int, 2> odd(vec.data() + 1, {10,4}, {8,2});
+	EXPECT_EQ(overlap::disjoint, may_overlap(even, odd));
+	EXPECT_EQ(overlap::partial, may_overlap(even, av));
+
+	// Members of the same array of structs, and a member with itself
+	vector<Particle> particles(12);
+	array_view<Particle, 2> aos(particles, {3,4});
+	EXPECT_EQ(overlap::disjoint, may_overlap(project(aos, &Particle::x), project(aos, &Particle::y)));
+	EXPECT_EQ(overlap::identical, may_overlap(project(aos, &Particle::z), project(aos, &Particle::z)));
+	EXPECT_EQ(overlap::partial, may_overlap(project(aos, &Particle::id), aos));
+
+	// Views of different rank and element size, and empty views
+	EXPECT_EQ(overlap::partial, may_overlap(flatten(av), av));
+	EXPECT_EQ(overlap::disjoint, may_overlap(av.section({0,0}, {0,8}), av));
+	EXPECT_EQ(overlap::partial, may_overlap(array_view<char, 1>(reinterpret_cast<char*>(vec.data()) + 2, {1}), av));
+}
+
+TEST(ArrayView, CopyOverlapping)
+{
+	// Shifting a row along by one element, in either direction, as std::memmove would
+	vector<int> vec(10);
+	iota(vec.begin(), vec.end(), 0);
+	array_view<int> av(vec);
+	copy(av.section({0}, {9}), av.section({1}, {9}));
+	EXPECT_EQ((vector<int>{0, 0, 1, 2, 3, 4, 5, 6, 7, 8}), vec);
+	copy(av.section({2}, {8}), av.section({0}, {8}));
+	EXPECT_EQ((vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 7, 8}), vec);
+
+	// Transposing a square array in place
+	vector<int> square(4*4);
+	iota(square.begin(), square.end(), 0);
+	array_view<int, 2> sq(square, {4,4});
+	copy(strided_array_view<int, 2>(square.data(), {4,4}, {1,4}), sq);
+	for (auto& idx : sq.bounds()) {
+		EXPECT_EQ(4*idx[1] + idx[0], sq[idx]);
+	}
+
+	// Copying a view to itself leaves it unchanged
+	copy(sq, sq);
+	EXPECT_EQ(4, (sq[{0,1}]));
+}
+
+TEST(ArrayView, Prefetch)
+{
+	// Left to the hardware prefetcher
+	EXPECT_EQ(0, prefetch_distance(sizeof(float), 1));
+	EXPECT_EQ(0, prefetch_distance(sizeof(float), -32));
+
+	EXPECT_EQ(AV_PREFETCH_DISTANCE, prefetch_distance(sizeof(float), 64));
+	EXPECT_EQ(2 * AV_PREFETCH_DISTANCE, prefetch_distance(sizeof(double), -1024));
+}
+
+TEST(ArrayView, ForEachElement)
+{
+	const int N = 300;
+	vector<int> vec(N*N);
+	iota(vec.begin(), vec.end(), 0);
+	array_view<int, 2> av(vec, {N,N});
+
+	// Walk columns first, by way of a transposed view
+	strided_array_view<int, 2> transposed(vec.data(), {N,N}, {1,N});
+
+	for (ptrdiff_t prefetch : {automatic_prefetch, ptrdiff_t{0}, ptrdiff_t{3}, ptrdiff_t{2*N}})
+	{
+		vector<int> visited;
+		for_each_element(transposed, [&](int v) { visited.push_back(v); }, prefetch);
+
+		ASSERT_EQ(vec.size(), visited.size());
+		for (int i=0; i<N; ++i) {
+			for (int j=0; j<N; ++j) {
+				EXPECT_EQ(j*N + i, visited[i*N + j]);
+			}
+		}
+
+		vector<int> dense(N*N);
+		array_view<int, 2> dense_av(dense, {N,N});
+		copy(transposed, dense_av, prefetch);
+		for (auto& idx : transposed.bounds()) {
+			EXPECT_EQ((av[{idx[1], idx[0]}]), dense_av[idx]);
+		}
+
+		// ..and back into a strided destination
+		vector<int> result(N*N);
+		copy(dense_av, strided_array_view<int, 2>(result.data(), {N,N}, {1,N}), prefetch);
+		EXPECT_EQ(vec, result);
+	}
+
+	// Rows of small stride, which are prefetched only when a distance is given
+	const strided_array_view<int, 2> every_other(vec.data(), {N, N/2}, {N, 2});
+	for (ptrdiff_t prefetch : {automatic_prefetch, ptrdiff_t{0}, ptrdiff_t{5}})
+	{
+		vector<int> dense(N*N/2);
+		copy(every_other, array_view<int, 2>(dense, {N, N/2}), prefetch);
+		EXPECT_EQ(2*N + 6, dense[size_t(N + 3)]);
+
+		long long sum = 0;
+		for_each_element(every_other, [&](int v) { sum += v; }, prefetch);
+		EXPECT_EQ(accumulate(dense.begin(), dense.end(), 0ll), sum);
+	}
+
+	// Writes through to elements
+	for_each_element(av.section({1,1}), [](int& v) { v = -1; });
+	EXPECT_EQ(N-1, (av[{0,N-1}]));
+	EXPECT_EQ(-1, (av[{N-1,1}]));
+}
+
 TEST(ArrayView, Example)
 {
 	int X = 12;
@@ -0,0 +1,301 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+#include "array_view.h"
+#include "parallel.h"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/*
+template <typename T>
+class atomic_reference
+{
+public:
+	using value_type = T;
+
+	explicit atomic_reference(T& obj) noexcept;
+
+	T    load(std::memory_order order = std::memory_order_seq_cst) const noexcept;
+	void store(T desired, std::memory_order order = std::memory_order_seq_cst) const noexcept;
+	T    exchange(T desired, std::memory_order order = std::memory_order_seq_cst) const noexcept;
+	bool compare_exchange_weak(T& expected, T desired, std::memory_order order = std::memory_order_seq_cst) const noexcept;
+	bool compare_exchange_strong(T& expected, T desired, std::memory_order order = std::memory_order_seq_cst) const noexcept;
+
+	// arithmetic types only
+	T fetch_add(T arg, std::memory_order order = std::memory_order_seq_cst) const noexcept;
+	T fetch_sub(T arg, std::memory_order order = std::memory_order_seq_cst) const noexcept;
+
+	operator T() const noexcept;
+	T operator=(T desired) const noexcept;
+	T operator+=(T arg) const noexcept;
+	T operator-=(T arg) const noexcept;
+};
+
+template <typename T, size_t Rank = 1>
+class atomic_array_view
+{
+public:
+	static constexpr size_t rank = Rank;
+	using offset_type            = offset<Rank>;
+	using bounds_type            = bounds<Rank>;
+	using size_type              = size_t;
+	using value_type             = T;
+	using reference              = atomic_reference<T>;
+
+	constexpr atomic_array_view() noexcept;
+	constexpr atomic_array_view(const array_view<T, Rank>& rhs) noexcept;
+	constexpr atomic_array_view(const strided_array_view<T, Rank>& rhs) noexcept;
+
+	// observers
+	constexpr bounds_type bounds() const noexcept;
+	constexpr size_type   size()   const noexcept;
+	constexpr offset_type stride() const noexcept;
+	constexpr strided_array_view<T, Rank> view() const noexcept;
+
+	// element access
+	reference operator[](const offset_type& idx) const;
+
+	// slicing and sectioning
+	template <size_t R = Rank>                // only if Rank > 1
+	atomic_array_view<T, Rank-1> operator[](ptrdiff_t slice) const;
+
+	atomic_array_view<T, Rank> section(const offset_type& origin, const bounds_type& section_bounds) const;
+	atomic_array_view<T, Rank> section(const offset_type& origin) const;
+};
+
+enum class scatter_strategy { automatic, shared_atomic, privatized };
+
+// For each i in [0, n), adds value_of(i) to bins[index_of(i)], using `threads` threads
+template <typename T, size_t Rank, typename IndexFn, typename ValueFn>
+void parallel_scatter_add(const array_view<T, Rank>& bins, size_t n, IndexFn index_of, ValueFn value_of,
+                          unsigned threads = 0, scatter_strategy strategy = scatter_strategy::automatic);
+
+// For each i in [0, n), increments bins[index_of(i)]
+template <typename T, size_t Rank, typename IndexFn>
+void parallel_histogram(const array_view<T, Rank>& bins, size_t n, IndexFn index_of,
+                        unsigned threads = 0, scatter_strategy strategy = scatter_strategy::automatic);
+*/
+
+namespace av
+{
+
+namespace {
+
+	constexpr int atomic_order(std::memory_order order)
+	{
+		return order == std::memory_order_relaxed ? __ATOMIC_RELAXED :
+		       order == std::memory_order_consume ? __ATOMIC_CONSUME :
+		       order == std::memory_order_acquire ? __ATOMIC_ACQUIRE :
+		       order == std::memory_order_release ? __ATOMIC_RELEASE :
+		       order == std::memory_order_acq_rel ? __ATOMIC_ACQ_REL : __ATOMIC_SEQ_CST;
+	}
+
+	// The failure ordering of a compare-exchange may not be a release ordering
+	constexpr int atomic_failure_order(std::memory_order order)
+	{
+		return order == std::memory_order_release ? __ATOMIC_RELAXED :
+		       order == std::memory_order_acq_rel ? __ATOMIC_ACQUIRE : atomic_order(order);
+	}
+
+} // namespace
+
+// Atomic operations on an object that is not itself atomic, in the manner of C++20's
+// std::atomic_ref.  Implemented with the GCC/Clang `__atomic` builtins.
+template <typename T>
+class atomic_reference
+{
+public:
+	using value_type = T;
+
+	static_assert(std::is_trivially_copyable<T>::value, "Type must be trivially copyable");
+	static_assert(__atomic_always_lock_free(sizeof(T), 0), "Type must support lock-free atomic operations");
+
+	explicit atomic_reference(T& obj) noexcept : ptr_(&obj)
+	{
+		assert(reinterpret_cast<std::uintptr_t>(ptr_) % sizeof(T) == 0);
+	}
+
+	T load(std::memory_order order = std::memory_order_seq_cst) const noexcept
+	{
+		T result;
+		__atomic_load(ptr_, &result, atomic_order(order));
+		return result;
+	}
+
+	void store(T desired, std::memory_order order = std::memory_order_seq_cst) const noexcept
+	{ __atomic_store(ptr_, &desired, atomic_order(order)); }
+
+	T exchange(T desired, std::memory_order order = std::memory_order_seq_cst) const noexcept
+	{
+		T result;
+		__atomic_exchange(ptr_, &desired, &result, atomic_order(order));
+		return result;
+	}
+
+	bool compare_exchange_weak(T& expected, T desired,
+	                           std::memory_order order = std::memory_order_seq_cst) const noexcept
+	{
+		return __atomic_compare_exchange(ptr_, &expected, &desired, true,
+		                                 atomic_order(order), atomic_failure_order(order));
+	}
+
+	bool compare_exchange_strong(T& expected, T desired,
+	                             std::memory_order order = std::memory_order_seq_cst) const noexcept
+	{
+		return __atomic_compare_exchange(ptr_, &expected, &desired, false,
+		                                 atomic_order(order), atomic_failure_order(order));
+	}
+
+	template <typename U = T, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+	T fetch_add(T arg, std::memory_order order = std::memory_order_seq_cst) const noexcept
+	{ return fetch_add_impl(arg, order, std::is_integral<T>{}); }
+
+	template <typename U = T, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+	T fetch_sub(T arg, std::memory_order order = std::memory_order_seq_cst) const noexcept
+	{ return fetch_add_impl(-arg, order, std::is_integral<T>{}); }
+
+	operator T() const noexcept { return load(); }
+	T operator=(T desired) const noexcept { store(desired); return desired; }
+
+	template <typename U = T, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+	T operator+=(T arg) const noexcept { return fetch_add(arg) + arg; }
+	template <typename U = T, typename = std::enable_if_t<std::is_arithmetic<U>::value>>
+	T operator-=(T arg) const noexcept { return fetch_sub(arg) - arg; }
+
+private:
+	T fetch_add_impl(T arg, std::memory_order order, std::true_type) const noexcept
+	{ return __atomic_fetch_add(ptr_, arg, atomic_order(order)); }
+
+	// There is no atomic add for floating point types, so loop on a compare-exchange
+	T fetch_add_impl(T arg, std::memory_order order, std::false_type) const noexcept
+	{
+		T expected = load(std::memory_order_relaxed);
+		while (!compare_exchange_weak(expected, expected + arg, order)) {}
+		return expected;
+	}
+
+	T* ptr_;
+};
+
+// A view whose element access is atomic, for concurrent updates of shared data
+template <typename T, size_t Rank = 1>
+class atomic_array_view
+{
+public:
+	static constexpr size_t rank = Rank;
+	using offset_type            = offset<Rank>;
+	using bounds_type            = av::bounds<Rank>;
+	using size_type              = size_t;
+	using value_type             = T;
+	using reference              = atomic_reference<T>;
+
+	constexpr atomic_array_view() noexcept {}
+
+	constexpr atomic_array_view(const array_view<T, Rank>& rhs) noexcept : view_(rhs) {}
+	constexpr atomic_array_view(const strided_array_view<T, Rank>& rhs) noexcept : view_(rhs) {}
+
+	// observers
+	constexpr bounds_type bounds() const noexcept { return view_.bounds(); }
+	constexpr size_type   size()   const noexcept { return view_.size(); }
+	constexpr offset_type stride() const noexcept { return view_.stride(); }
+	constexpr strided_array_view<T, Rank> view() const noexcept { return view_; }
+
+	// element access
+	reference operator[](const offset_type& idx) const { return reference(view_[idx]); }
+
+	// slicing and sectioning
+	template <size_t R = Rank, typename = std::enable_if_t< R>=2 >>
+	atomic_array_view<T, Rank-1> operator[](std::ptrdiff_t slice) const
+	{ return atomic_array_view<T, Rank-1>(view_[slice]); }
+
+	atomic_array_view<T, Rank> section(const offset_type& origin, const bounds_type& section_bounds) const
+	{ return atomic_array_view<T, Rank>(view_.section(origin, section_bounds)); }
+
+	atomic_array_view<T, Rank> section(const offset_type& origin) const
+	{ return atomic_array_view<T, Rank>(view_.section(origin)); }
+
+private:
+	strided_array_view<T, Rank> view_;
+};
+
+enum class scatter_strategy
+{
+	automatic,      // choose between the two below, by the number of bins
+	shared_atomic,  // all threads update `bins` directly, with atomic adds
+	privatized      // each thread updates its own copy of `bins`, reduced after
+};
+
+// Privatization pays for itself when the bins are few, as then updates from different threads
+// frequently fall on the same cache lines.  Then the private copies are also small enough to be
+// cheap to reduce, and to keep in cache.
+template <typename T, size_t Rank, typename IndexFn, typename ValueFn>
+void parallel_scatter_add(const array_view<T, Rank>& bins, size_t n, IndexFn index_of, ValueFn value_of,
+                          unsigned threads = 0, scatter_strategy strategy = scatter_strategy::automatic)
+{
+	threads = default_thread_count(threads);
+
+	if (strategy == scatter_strategy::automatic)
+	{
+		const size_t private_bytes = bins.size() * sizeof(T);
+		const bool high_contention = private_bytes <= (size_t{256} << 10) && bins.size() * threads <= n;
+		strategy = (threads > 1 && high_contention) ? scatter_strategy::privatized
+		                                            : scatter_strategy::shared_atomic;
+	}
+
+	if (strategy == scatter_strategy::shared_atomic)
+	{
+		atomic_array_view<T, Rank> shared(bins);
+		parallel_partition(n, threads, [&](unsigned, size_t first, size_t last) {
+			for (size_t i=first; i<last; ++i) {
+				shared[index_of(i)].fetch_add(value_of(i), std::memory_order_relaxed);
+			}
+		});
+		return;
+	}
+
+	// Accumulate into each private copy..
+	const size_t size = bins.size();
+	const offset<Rank> stride = bins.stride();
+	std::vector<T> partials(size * threads, T{});
+
+	parallel_partition(n, threads, [&](unsigned t, size_t first, size_t last) {
+		T* partial = partials.data() + size * t;
+		for (size_t i=first; i<last; ++i)
+		{
+			const offset<Rank> idx = index_of(i);
+			assert(bins.bounds().contains(idx));
+			view_access(partial, idx, stride) += value_of(i);
+		}
+	});
+
+	// ..then reduce, with each thread taking its own range of bins across all copies
+	T* out = bins.data();
+	parallel_partition(size, threads, [&](unsigned, size_t first, size_t last) {
+		for (unsigned t=0; t<threads; ++t)
+		{
+			const T* partial = partials.data() + size * t;
+			for (size_t i=first; i<last; ++i) {
+				out[i] += partial[i];
+			}
+		}
+	});
+}
+
+template <typename T, size_t Rank, typename IndexFn>
+void parallel_histogram(const array_view<T, Rank>& bins, size_t n, IndexFn index_of,
+                        unsigned threads = 0, scatter_strategy strategy = scatter_strategy::automatic)
+{
+	parallel_scatter_add(bins, n, index_of, [](size_t) { return T{1}; }, threads, strategy);
+}
+
+}
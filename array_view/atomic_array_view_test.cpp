@@ -0,0 +1,108 @@
+#include "array_view/atomic_array_view.h"
+
+#include <numeric>
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace av;
+
+TEST(atomic_reference_test, Operations)
+{
+	int i = 5;
+	atomic_reference<int> ref(i);
+	EXPECT_EQ(5, ref.load());
+	EXPECT_EQ(5, ref.fetch_add(3));
+	EXPECT_EQ(6, ref -= 2);
+	EXPECT_EQ(6, ref.exchange(1));
+	EXPECT_EQ(1, i);
+
+	int expected = 2;
+	EXPECT_FALSE(ref.compare_exchange_strong(expected, 7));
+	EXPECT_EQ(1, expected);
+	EXPECT_TRUE(ref.compare_exchange_strong(expected, 7));
+	EXPECT_EQ(7, i);
+
+	float f = 1.5f;
+	atomic_reference<float> fref(f);
+	EXPECT_EQ(1.5f, fref.fetch_add(2.f));
+	EXPECT_EQ(3.f, fref -= 0.5f);
+	fref = 10.f;
+	EXPECT_EQ(10.f, f);
+}
+
+TEST(atomic_array_view_test, ConcurrentAdd)
+{
+	vector<float> vec(4*3*2);
+	array_view<float, 3> av(vec, {4,3,2});
+	atomic_array_view<float, 3> aav(av);
+	EXPECT_EQ(av.bounds(), aav.bounds());
+	EXPECT_EQ(av.stride(), aav.stride());
+
+	const int threads = 4;
+	const int adds = 1000;
+
+	vector<thread> workers;
+	for (int t=0; t<threads; ++t) {
+		workers.emplace_back([&] {
+			for (int i=0; i<adds; ++i) {
+				for (auto& idx : aav.bounds()) {
+					aav[idx] += 1.f;
+				}
+			}
+		});
+	}
+	for (thread& worker : workers) {
+		worker.join();
+	}
+
+	for (float v : vec) {
+		EXPECT_EQ(float(threads * adds), v);
+	}
+
+	// Slices and sections are atomic views of the same data
+	aav[1][{2,1}] = -1.f;
+	EXPECT_EQ(-1.f, (av[{1,2,1}]));
+	EXPECT_EQ(-1.f, (aav.section({1,1,1})[{0,1,0}].load()));
+}
+
+class HistogramTest : public ::testing::TestWithParam<scatter_strategy> {};
+
+TEST_P(HistogramTest, MatchesSerial)
+{
+	const size_t n = 100000;
+	vector<int> samples(n);
+	unsigned s = 1;
+	generate(samples.begin(), samples.end(), [&] { s = s * 1103515245u + 12345u; return int(s & 0x7fffffffu); });
+
+	for (ptrdiff_t nbins : {2, 64, 4096})
+	{
+		bounds<2> b = {nbins / 2, 2};
+		auto index_of = [&](size_t i) { int v = samples[i] % nbins; return offset<2>{v / 2, v % 2}; };
+
+		vector<int> expected(b.size());
+		array_view<int, 2> expected_av(expected, b);
+		for (size_t i=0; i<n; ++i) {
+			++expected_av[index_of(i)];
+		}
+
+		for (unsigned threads : {1u, 3u, 8u})
+		{
+			vector<int> hist(b.size());
+			parallel_histogram(array_view<int, 2>(hist, b), n, index_of, threads, GetParam());
+			EXPECT_EQ(expected, hist);
+		}
+
+		vector<double> sums(b.size(), 1.0);
+		parallel_scatter_add(array_view<double, 2>(sums, b), n, index_of,
+		                     [](size_t i) { return double(i % 4); }, 4, GetParam());
+		double total = accumulate(sums.begin(), sums.end(), 0.0);
+		EXPECT_EQ(double(b.size()) + 1.5 * n, total);
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(Strategies, HistogramTest,
+                         ::testing::Values(scatter_strategy::automatic,
+                                           scatter_strategy::shared_atomic,
+                                           scatter_strategy::privatized));
@@ -0,0 +1,279 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+#include "array_view.h"
+
+#include <vector>
+
+/*
+// W values of arithmetic type T, one per lane, with element-wise arithmetic (W a power of two)
+template <typename T, size_t W>
+struct lanes
+{
+	static constexpr size_t width = W;
+	using value_type = T;
+
+	lanes() noexcept;
+	lanes(T broadcast) noexcept;
+
+	T&       operator[](size_t lane);
+	const T& operator[](size_t lane) const;
+
+	lanes& operator+=(const lanes& rhs);  // also -=, *=, /=
+};
+
+template <typename T, size_t W>
+lanes<T, W> operator+(lanes<T, W> lhs, const lanes<T, W>& rhs);  // also -, *, /
+template <typename T, size_t W>
+lanes<T, W> min(const lanes<T, W>& lhs, const lanes<T, W>& rhs); // also max
+
+template <typename T>
+constexpr size_t default_lanes = AV_VECTOR_SIZE / sizeof(T);  // lanes that fill a vector register
+
+// For each group of W sections of `src` (at `origins`, each of bounds `section_bounds`), calls
+// kernel(in, out) with views of the group in SoA-within-batch layout, and stores `out` to the same
+// sections of `dst`.  `out` starts as a copy of `in`.
+template <size_t W, typename SrcView, typename DstView, typename Kernel>
+void transform_batch(const SrcView& src, const DstView& dst,
+                     array_view<const offset<Rank>> origins, const bounds<Rank>& section_bounds, Kernel kernel);
+
+// As above, for each slice of the leading (batch) dimension of `src` and `dst`
+template <size_t W, typename SrcView, typename DstView, typename Kernel>
+void transform_batch(const SrcView& src, const DstView& dst, Kernel kernel);
+*/
+
+namespace av
+{
+
+// Operations on lanes are element-wise over a fixed count, so they map to vector instructions, and
+// a kernel written over lanes processes W sections at once, whatever the size of the sections
+// themselves.  With GCC and Clang the lanes are held as a vector extension type, as loops over a
+// small array are otherwise fully unrolled before they can be vectorized.
+template <typename T, size_t W>
+struct lanes
+{
+	static_assert(std::is_arithmetic<T>::value, "Lanes must be of an arithmetic type");
+	static_assert(W > 0 && (W & (W - 1)) == 0, "The number of lanes must be a power of two");
+
+	static constexpr size_t width = W;
+	using value_type = T;
+
+#if defined(__GNUC__)
+	// Aligned only as T, so that lanes may be held anywhere that T may
+	typedef T vector_type __attribute__((vector_size(W * sizeof(T)), aligned(alignof(T))));
+#endif
+
+	lanes() noexcept : v{} {}
+	lanes(T broadcast) noexcept
+	{
+	#if defined(__GNUC__)
+		v = vector_type{} + broadcast;
+	#else
+		for (size_t i=0; i<W; ++i) v[i] = broadcast;
+	#endif
+	}
+
+	T&       operator[](size_t lane)       { return reinterpret_cast<T*>(&v)[lane]; }
+	const T& operator[](size_t lane) const { return reinterpret_cast<const T*>(&v)[lane]; }
+
+#if defined(__GNUC__)
+	lanes& operator+=(const lanes& rhs) { v += rhs.v; return *this; }
+	lanes& operator-=(const lanes& rhs) { v -= rhs.v; return *this; }
+	lanes& operator*=(const lanes& rhs) { v *= rhs.v; return *this; }
+	lanes& operator/=(const lanes& rhs) { v /= rhs.v; return *this; }
+
+	vector_type v;
+#else
+	lanes& operator+=(const lanes& rhs) { for (size_t i=0; i<W; ++i) v[i] += rhs.v[i]; return *this; }
+	lanes& operator-=(const lanes& rhs) { for (size_t i=0; i<W; ++i) v[i] -= rhs.v[i]; return *this; }
+	lanes& operator*=(const lanes& rhs) { for (size_t i=0; i<W; ++i) v[i] *= rhs.v[i]; return *this; }
+	lanes& operator/=(const lanes& rhs) { for (size_t i=0; i<W; ++i) v[i] /= rhs.v[i]; return *this; }
+
+	T v[W];
+#endif
+};
+
+template <typename T, size_t W>
+lanes<T, W> operator+(lanes<T, W> lhs, const lanes<T, W>& rhs) { return lhs += rhs; }
+
+template <typename T, size_t W>
+lanes<T, W> operator-(lanes<T, W> lhs, const lanes<T, W>& rhs) { return lhs -= rhs; }
+
+template <typename T, size_t W>
+lanes<T, W> operator*(lanes<T, W> lhs, const lanes<T, W>& rhs) { return lhs *= rhs; }
+
+template <typename T, size_t W>
+lanes<T, W> operator/(lanes<T, W> lhs, const lanes<T, W>& rhs) { return lhs /= rhs; }
+
+template <typename T, size_t W>
+lanes<T, W> min(const lanes<T, W>& lhs, const lanes<T, W>& rhs)
+{
+	lanes<T, W> result;
+#if defined(__GNUC__)
+	result.v = rhs.v < lhs.v ? rhs.v : lhs.v;
+#else
+	for (size_t i=0; i<W; ++i) result.v[i] = rhs.v[i] < lhs.v[i] ? rhs.v[i] : lhs.v[i];
+#endif
+	return result;
+}
+
+template <typename T, size_t W>
+lanes<T, W> max(const lanes<T, W>& lhs, const lanes<T, W>& rhs)
+{
+	lanes<T, W> result;
+#if defined(__GNUC__)
+	result.v = lhs.v < rhs.v ? rhs.v : lhs.v;
+#else
+	for (size_t i=0; i<W; ++i) result.v[i] = lhs.v[i] < rhs.v[i] ? rhs.v[i] : lhs.v[i];
+#endif
+	return result;
+}
+
+// The width of the vector registers targeted, in bytes
+#ifndef AV_VECTOR_SIZE
+#if defined(__AVX512F__)
+#define AV_VECTOR_SIZE 64
+#elif defined(__AVX__)
+#define AV_VECTOR_SIZE 32
+#else
+#define AV_VECTOR_SIZE 16
+#endif
+#endif
+
+// As many lanes as fill a vector register
+template <typename T>
+constexpr size_t default_lanes = AV_VECTOR_SIZE / sizeof(T) > 0 ? AV_VECTOR_SIZE / sizeof(T) : 1;
+
+namespace {
+
+	// The element offset of each row of `b`, in the order of its bounds, for the given stride
+	template <size_t Rank>
+	std::vector<std::ptrdiff_t> row_offsets(const bounds<Rank>& b, const offset<Rank>& stride)
+	{
+		std::vector<std::ptrdiff_t> offsets;
+		for_each_row(b, [&](const offset<Rank>& idx) {
+			std::ptrdiff_t off = 0;
+			for (size_t dim=0; dim<Rank; ++dim) off += idx[dim] * stride[dim];
+			offsets.push_back(off);
+		});
+		return offsets;
+	}
+
+	// Runs `kernel` over `count` sections, W at a time.  section_of(n) returns a view of the n'th
+	// section of the source, and target_of(n) of the destination, where the sections of each all
+	// have the same stride.
+	template <size_t W, typename T, size_t Rank, typename SectionOf, typename TargetOf, typename Kernel>
+	void run_batches(size_t count, const bounds<Rank>& section_bounds,
+	                 SectionOf section_of, TargetOf target_of, Kernel& kernel)
+	{
+		if (count == 0 || section_bounds.size() == 0) return;
+
+		std::vector<lanes<T, W>> in_buffer(section_bounds.size());
+		std::vector<lanes<T, W>> out_buffer(section_bounds.size());
+		const array_view<lanes<T, W>, Rank> in(in_buffer.data(), section_bounds);
+		const array_view<lanes<T, W>, Rank> out(out_buffer.data(), section_bounds);
+
+		const std::ptrdiff_t columns = section_bounds[Rank-1];
+		const auto first_section = strided_array_view<const T, Rank>(section_of(0));
+		const auto first_target = target_of(0);
+		const std::vector<std::ptrdiff_t> in_rows = row_offsets(section_bounds, first_section.stride());
+		const std::vector<std::ptrdiff_t> out_rows = row_offsets(section_bounds, first_target.stride());
+		const std::ptrdiff_t in_stride = first_section.stride()[Rank-1];
+		const std::ptrdiff_t out_stride = first_target.stride()[Rank-1];
+
+		for (size_t first=0; first<count; first+=W)
+		{
+			const size_t n = std::min(W, count - first);
+
+			// Transpose the rows of each section into its lane, leaving any lanes past the last section as zero
+			for (size_t lane=0; lane<n; ++lane)
+			{
+				const auto section = strided_array_view<const T, Rank>(section_of(first + lane));
+				assert(section.stride() == first_section.stride());
+
+				lanes<T, W>* element = in_buffer.data();
+				for (std::ptrdiff_t row : in_rows)
+				{
+					const T* values = section.data() + row;
+					for (std::ptrdiff_t j=0; j<columns; ++j) {
+						element[j][lane] = values[j * in_stride];
+					}
+					element += columns;
+				}
+			}
+			if (n < W) {
+				for (lanes<T, W>& element : in_buffer) {
+					for (size_t lane=n; lane<W; ++lane) element[lane] = T{};
+				}
+			}
+
+			out_buffer = in_buffer;
+			kernel(array_view<const lanes<T, W>, Rank>(in), out);
+
+			for (size_t lane=0; lane<n; ++lane)
+			{
+				const auto target = target_of(first + lane);
+				assert(target.stride() == first_target.stride());
+
+				const lanes<T, W>* element = out_buffer.data();
+				for (std::ptrdiff_t row : out_rows)
+				{
+					auto* values = target.data() + row;
+					for (std::ptrdiff_t j=0; j<columns; ++j) {
+						values[j * out_stride] = element[j][lane];
+					}
+					element += columns;
+				}
+			}
+		}
+	}
+
+} // namespace
+
+// Processes many small sections of the same bounds at once, to make use of the full vector width
+// when the sections alone are too small to.  The sections are gathered W at a time into a layout
+// where each element is a `lanes<T, W>` holding that element of each section.  The kernel is called
+// as kernel(in, out), with `out` starting as a copy of `in`, so elements it leaves unwritten are
+// unchanged in `dst`.
+template <size_t W, typename SrcView, typename DstView, typename Kernel, size_t Rank = SrcView::rank>
+void transform_batch(const SrcView& src, const DstView& dst, array_view<const offset<Rank>, 1> origins,
+                     const bounds<Rank>& section_bounds, Kernel kernel)
+{
+	static_assert(Rank == DstView::rank, "Rank of the source and destination views must match");
+	using T = std::remove_const_t<typename SrcView::value_type>;
+
+	run_batches<W, T>(origins.size(), section_bounds,
+		[&](size_t n) { return src.section(origins[n], section_bounds); },
+		[&](size_t n) { return dst.section(origins[n], section_bounds); },
+		kernel);
+}
+
+template <size_t W, typename SrcView, typename DstView, typename Kernel, size_t Rank = SrcView::rank>
+void transform_batch(const SrcView& src, const DstView& dst, Kernel kernel)
+{
+	static_assert(Rank == DstView::rank, "Rank of the source and destination views must match");
+	static_assert(Rank >= 2, "Rank must be at least two, with a leading batch dimension");
+	using T = std::remove_const_t<typename SrcView::value_type>;
+
+	assert(src.bounds() == dst.bounds());
+
+	bounds<Rank-1> section_bounds;
+	for (size_t i=0; i<Rank-1; ++i) {
+		section_bounds[i] = src.bounds()[i+1];
+	}
+
+	run_batches<W, T>(static_cast<size_t>(src.bounds()[0]), section_bounds,
+		[&](size_t n) { return src[static_cast<std::ptrdiff_t>(n)]; },
+		[&](size_t n) { return dst[static_cast<std::ptrdiff_t>(n)]; },
+		kernel);
+}
+
+}
@@ -0,0 +1,110 @@
+#include "array_view/batch.h"
+
+#include <numeric>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace av;
+
+namespace {
+
+	// A 3x3 box sum of the interior of each section
+	template <typename In, typename Out>
+	void box_sum(const In& in, const Out& out)
+	{
+		const bounds<2> b = in.bounds();
+		for (ptrdiff_t i=1; i<b[0]-1; ++i) {
+			for (ptrdiff_t j=1; j<b[1]-1; ++j)
+			{
+				auto sum = in[{i-1,j-1}] + in[{i-1,j}] + in[{i-1,j+1}] +
+				           in[{i,  j-1}] + in[{i,  j}] + in[{i,  j+1}] +
+				           in[{i+1,j-1}] + in[{i+1,j}] + in[{i+1,j+1}];
+				out[{i,j}] = sum;
+			}
+		}
+	}
+
+} // namespace
+
+TEST(lanes_test, Arithmetic)
+{
+	lanes<int, 4> a;
+	for (size_t i=0; i<4; ++i) a[i] = int(i) + 1;
+	const lanes<int, 4> b(2);
+
+	const lanes<int, 4> sum = a + b, difference = a - b, product = a * b, quotient = a / b;
+	const lanes<int, 4> low = min(a, b), high = max(a, b);
+
+	for (size_t i=0; i<4; ++i)
+	{
+		EXPECT_EQ(a[i] + 2, sum[i]);
+		EXPECT_EQ(a[i] - 2, difference[i]);
+		EXPECT_EQ(a[i] * 2, product[i]);
+		EXPECT_EQ(a[i] / 2, quotient[i]);
+		EXPECT_EQ(std::min(a[i], 2), low[i]);
+		EXPECT_EQ(std::max(a[i], 2), high[i]);
+	}
+
+	EXPECT_EQ(AV_VECTOR_SIZE / sizeof(float), default_lanes<float>);
+	EXPECT_EQ(2 * default_lanes<double>, default_lanes<float>);
+}
+
+TEST(transform_batch_test, Origins)
+{
+	// 8x8 blocks of a 32x40 image, with one fewer block than a multiple of the lane count
+	const bounds<2> image_bounds = {32, 40};
+	vector<float> image(image_bounds.size());
+	iota(image.begin(), image.end(), 0.f);
+	const array_view<const float, 2> src(image, image_bounds);
+
+	const bounds<2> block = {8, 8};
+	vector<offset<2>> origins;
+	for (ptrdiff_t i=0; i<32; i+=8) {
+		for (ptrdiff_t j=0; j<40; j+=8) {
+			origins.push_back({i, j});
+		}
+	}
+	origins.pop_back();
+	ASSERT_EQ(19u, origins.size());
+
+	vector<float> batched(image_bounds.size(), -1.f);
+	transform_batch<8>(src, array_view<float, 2>(batched, image_bounds),
+	                   array_view<const offset<2>, 1>(origins), block,
+	                   [](auto in, auto out) { box_sum(in, out); });
+
+	vector<float> expected(image_bounds.size(), -1.f);
+	const array_view<float, 2> expected_view(expected, image_bounds);
+	for (const offset<2>& origin : origins)
+	{
+		auto out = expected_view.section(origin, block);
+		copy(src.section(origin, block), out);  // the border is unchanged
+		box_sum(src.section(origin, block), out);
+	}
+
+	EXPECT_EQ(expected, batched);
+}
+
+TEST(transform_batch_test, LeadingDimension)
+{
+	// A stack of 5 strided 4x6 sections, in place
+	const bounds<3> stack_bounds = {5, 4, 6};
+	vector<int> data(2 * stack_bounds.size());
+	iota(data.begin(), data.end(), 0);
+	const strided_array_view<int, 3> stack(data.data(), stack_bounds, {48, 12, 2});
+
+	vector<int> expected = data;
+	const strided_array_view<int, 3> expected_stack(expected.data(), stack_bounds, {48, 12, 2});
+	for (const offset<3>& idx : stack_bounds) {
+		expected_stack[idx] = 3 * expected_stack[idx] + 1;
+	}
+
+	transform_batch<4>(stack, stack, [](auto in, auto out) {
+		for (const offset<2>& idx : in.bounds()) {
+			out[idx] = in[idx] * lanes<int, 4>(3) + lanes<int, 4>(1);
+		}
+	});
+
+	EXPECT_EQ(expected, data);
+}
@@ -0,0 +1,429 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+#include "array_view.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+/*
+// Compressed storage of an array, in fixed-size chunks that are decompressed on access
+template <typename T, size_t Rank = 1>
+class chunked_array
+{
+public:
+	static constexpr size_t rank = Rank;
+	using offset_type            = offset<Rank>;
+	using bounds_type            = bounds<Rank>;
+	using size_type              = size_t;
+	using value_type             = T;
+
+	struct cache_stats
+	{
+		size_t hits;
+		size_t misses;
+	};
+
+	chunked_array() noexcept;
+
+	// Compresses the elements of `source`, in chunks of `chunk_bounds`, keeping up to `cache_chunks`
+	// chunks decompressed at a time
+	template <typename View>
+	chunked_array(const View& source, const bounds_type& chunk_bounds, size_t cache_chunks = 16);
+
+	// Copies share no cache: a copy starts with no chunks decompressed, and no stats
+	chunked_array(const chunked_array& rhs);
+	chunked_array(chunked_array&& rhs) noexcept;
+	chunked_array& operator=(const chunked_array& rhs);
+	chunked_array& operator=(chunked_array&& rhs) noexcept;
+
+	// observers
+	bounds_type bounds() const noexcept;
+	bounds_type chunk_bounds() const noexcept;
+	size_type   size() const noexcept;
+	size_t      compressed_bytes() const noexcept;
+	double      compression_ratio() const noexcept;
+	cache_stats stats() const noexcept;
+
+	// element access
+	value_type operator[](const offset_type& idx) const;
+
+	// Copies the section at `origin`, of the bounds of `dst`, into `dst`
+	template <typename View>
+	void read(const offset_type& origin, const View& dst) const;
+};
+*/
+
+namespace av
+{
+
+namespace {
+
+	template <size_t Size> struct word_of    { using type = void; };
+	template <>            struct word_of<1> { using type = std::uint8_t; };
+	template <>            struct word_of<2> { using type = std::uint16_t; };
+	template <>            struct word_of<4> { using type = std::uint32_t; };
+	template <>            struct word_of<8> { using type = std::uint64_t; };
+
+	// Replaces each element with its difference from the previous, as an unsigned integer of the
+	// same size, so that smoothly varying data becomes mostly small values.  Elements of other sizes
+	// are left unchanged.
+	template <typename Word>
+	void delta_encode(unsigned char* bytes, size_t n, Word*)
+	{
+		Word previous = 0;
+		for (size_t i=0; i<n; ++i)
+		{
+			Word value;
+			std::memcpy(&value, bytes + i * sizeof(Word), sizeof(Word));
+			const Word delta = static_cast<Word>(value - previous);
+			std::memcpy(bytes + i * sizeof(Word), &delta, sizeof(Word));
+			previous = value;
+		}
+	}
+
+	inline void delta_encode(unsigned char*, size_t, void*) {}
+
+	// Groups the k'th byte of each element together, so that the high bytes of small values form
+	// long runs of the same byte
+	inline void shuffle_bytes(const unsigned char* in, size_t n, size_t size, unsigned char* out)
+	{
+		for (size_t k=0; k<size; ++k) {
+			for (size_t i=0; i<n; ++i) {
+				out[k * n + i] = in[i * size + k];
+			}
+		}
+	}
+
+	// Reverses shuffle_bytes and then delta_encode.  The bytes of each word are combined with shifts
+	// rather than copied to their place, so that the first pass vectorizes.
+	template <size_t Size, typename Word>
+	void unshuffle_delta_decode(const unsigned char* in, size_t n, unsigned char* out, Word*)
+	{
+		for (size_t i=0; i<n; ++i)
+		{
+			Word value = 0;
+			for (size_t k=0; k<sizeof(Word); ++k) {
+			#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+				value |= static_cast<Word>(static_cast<Word>(in[k * n + i]) << (8 * (sizeof(Word) - 1 - k)));
+			#else
+				value |= static_cast<Word>(static_cast<Word>(in[k * n + i]) << (8 * k));
+			#endif
+			}
+			std::memcpy(out + i * sizeof(Word), &value, sizeof(Word));
+		}
+
+		Word previous = 0;
+		for (size_t i=0; i<n; ++i)
+		{
+			Word delta;
+			std::memcpy(&delta, out + i * sizeof(Word), sizeof(Word));
+			previous = static_cast<Word>(previous + delta);
+			std::memcpy(out + i * sizeof(Word), &previous, sizeof(Word));
+		}
+	}
+
+	template <size_t Size>
+	void unshuffle_delta_decode(const unsigned char* in, size_t n, unsigned char* out, void*)
+	{
+		for (size_t k=0; k<Size; ++k) {
+			for (size_t i=0; i<n; ++i) {
+				out[i * Size + k] = in[k * n + i];
+			}
+		}
+	}
+
+	// Run-length encoding of bytes.  A control byte c < 128 is followed by c+1 literal bytes, and a
+	// control byte c >= 128 by a single byte repeated c-125 times, for runs of 3 to 130.
+	inline void rle_encode(const unsigned char* in, size_t n, std::vector<unsigned char>& out)
+	{
+		size_t i = 0;
+		while (i < n)
+		{
+			size_t run = 1;
+			while (i + run < n && run < 130 && in[i + run] == in[i]) ++run;
+			if (run >= 3)
+			{
+				out.push_back(static_cast<unsigned char>(128 + run - 3));
+				out.push_back(in[i]);
+				i += run;
+				continue;
+			}
+
+			// Literals, up to the start of the next run
+			const size_t first = i;
+			while (i < n && i - first < 128 && !(i + 2 < n && in[i] == in[i+1] && in[i] == in[i+2])) ++i;
+			out.push_back(static_cast<unsigned char>(i - first - 1));
+			out.insert(out.end(), in + first, in + i);
+		}
+	}
+
+	inline void rle_decode(const unsigned char* in, size_t n, unsigned char* out, size_t out_size)
+	{
+		const unsigned char* end = in + n;
+		unsigned char* out_end = out + out_size;
+		while (in < end)
+		{
+			const unsigned char control = *in++;
+			if (control < 128)
+			{
+				const size_t length = control + 1u;
+				assert(out + length <= out_end && in + length <= end);
+				std::memcpy(out, in, length);
+				in += length;
+				out += length;
+			}
+			else
+			{
+				const size_t length = control - 125u;
+				assert(out + length <= out_end && in < end);
+				std::memset(out, *in++, length);
+				out += length;
+			}
+		}
+		assert(out == out_end && "Compressed chunk does not decode to its size");
+		(void)out_end;
+	}
+
+	// The codec of chunks: delta, then byte shuffle, then run-length encoding
+	template <typename T>
+	std::vector<unsigned char> compress_chunk(const T* elements, size_t n)
+	{
+		std::vector<unsigned char> bytes(n * sizeof(T)), shuffled(n * sizeof(T));
+		std::memcpy(bytes.data(), elements, bytes.size());
+		delta_encode(bytes.data(), n, static_cast<typename word_of<sizeof(T)>::type*>(nullptr));
+		shuffle_bytes(bytes.data(), n, sizeof(T), shuffled.data());
+
+		std::vector<unsigned char> compressed;
+		rle_encode(shuffled.data(), shuffled.size(), compressed);
+		compressed.shrink_to_fit();
+		return compressed;
+	}
+
+	// Decompresses into `elements` (which must be aligned as an unsigned integer of their size) by way
+	// of `scratch`, which is reused between calls
+	template <typename T>
+	void decompress_chunk(const std::vector<unsigned char>& compressed, T* elements, size_t n,
+	                      std::vector<unsigned char>& scratch)
+	{
+		using word = typename word_of<sizeof(T)>::type;
+
+		scratch.resize(n * sizeof(T));
+		rle_decode(compressed.data(), compressed.size(), scratch.data(), scratch.size());
+		unshuffle_delta_decode<sizeof(T)>(scratch.data(), n, reinterpret_cast<unsigned char*>(elements),
+		                                  static_cast<word*>(nullptr));
+	}
+
+} // namespace
+
+// An array held compressed, in chunks of a fixed bounds, which are decompressed as they are
+// accessed.  The most recently used chunks are kept decompressed, up to the given number, so that
+// accesses with locality decompress each chunk once.  The cache is not synchronised: a
+// chunked_array should be accessed from a single thread.
+template <typename T, size_t Rank = 1>
+class chunked_array
+{
+public:
+	static constexpr size_t rank = Rank;
+	using offset_type            = offset<Rank>;
+	using bounds_type            = av::bounds<Rank>;
+	using size_type              = size_t;
+	using value_type             = T;
+
+	static_assert(std::is_trivially_copyable<T>::value, "Elements must be trivially copyable to be compressed");
+
+	struct cache_stats
+	{
+		size_t hits = 0;
+		size_t misses = 0;
+	};
+
+	chunked_array() noexcept {}
+
+	template <typename View>
+	chunked_array(const View& source, const bounds_type& chunk_bounds, size_t cache_chunks = 16)
+		: bounds_(source.bounds()), chunk_bounds_(chunk_bounds), cache_capacity_(cache_chunks)
+	{
+		static_assert(View::rank == Rank, "Rank of the source must match that of the array");
+		assert(chunk_bounds.size() > 0 && cache_chunks > 0);
+
+		for (size_t i=0; i<Rank; ++i) {
+			grid_[i] = (bounds_[i] + chunk_bounds_[i] - 1) / chunk_bounds_[i];
+		}
+
+		std::vector<T> buffer(chunk_bounds_.size());
+		chunks_.reserve(grid_.size());
+		for (const offset_type& chunk : grid_)
+		{
+			const bounds_type b = chunk_extent(chunk);
+			const array_view<T, Rank> dense(buffer.data(), b);
+			copy(source.section(chunk_origin(chunk), b), dense);
+			chunks_.push_back(compress_chunk(buffer.data(), b.size()));
+			compressed_bytes_ += chunks_.back().size();
+		}
+	}
+
+	// The cache is not copied, as its lookup holds iterators into the list of the array it is of.
+	// Moving a list keeps its iterators, so a move takes the cache with it.
+	chunked_array(const chunked_array& rhs)
+		: bounds_(rhs.bounds_), chunk_bounds_(rhs.chunk_bounds_), grid_(rhs.grid_), chunks_(rhs.chunks_),
+		  compressed_bytes_(rhs.compressed_bytes_), cache_capacity_(rhs.cache_capacity_) {}
+
+	chunked_array(chunked_array&& rhs) noexcept = default;
+
+	chunked_array& operator=(const chunked_array& rhs)
+	{
+		if (this != &rhs) *this = chunked_array(rhs);
+		return *this;
+	}
+
+	chunked_array& operator=(chunked_array&& rhs) noexcept = default;
+
+	// observers
+	bounds_type bounds() const noexcept { return bounds_; }
+	bounds_type chunk_bounds() const noexcept { return chunk_bounds_; }
+	size_type size() const noexcept { return bounds_.size(); }
+	size_t compressed_bytes() const noexcept { return compressed_bytes_; }
+	cache_stats stats() const noexcept { return stats_; }
+
+	double compression_ratio() const noexcept
+	{ return compressed_bytes_ ? double(size() * sizeof(T)) / double(compressed_bytes_) : 1.0; }
+
+	// element access
+	value_type operator[](const offset_type& idx) const
+	{
+		assert(bounds_.contains(idx));
+
+		offset_type chunk, within;
+		for (size_t i=0; i<Rank; ++i)
+		{
+			chunk[i] = idx[i] / chunk_bounds_[i];
+			within[i] = idx[i] % chunk_bounds_[i];
+		}
+		return chunk_view(chunk)[within];
+	}
+
+	// Copies each chunk overlapping the section in turn, so that only those chunks are decompressed
+	template <typename View>
+	void read(const offset_type& origin, const View& dst) const
+	{
+		static_assert(View::rank == Rank, "Rank of the destination must match that of the array");
+
+		const bounds_type section_bounds = dst.bounds();
+		if (section_bounds.size() == 0) return;
+
+		bounds_type chunks;
+		offset_type first;
+		for (size_t i=0; i<Rank; ++i)
+		{
+			assert(0 <= origin[i] && origin[i] + section_bounds[i] <= bounds_[i]);
+			first[i] = origin[i] / chunk_bounds_[i];
+			chunks[i] = (origin[i] + section_bounds[i] - 1) / chunk_bounds_[i] - first[i] + 1;
+		}
+
+		for (const offset_type& relative : chunks)
+		{
+			const offset_type chunk = first + relative;
+			const offset_type chunk_first = chunk_origin(chunk);
+			const bounds_type chunk_b = chunk_extent(chunk);
+
+			// The intersection of the chunk and the section
+			offset_type lo;
+			bounds_type overlap;
+			for (size_t i=0; i<Rank; ++i)
+			{
+				lo[i] = std::max(origin[i], chunk_first[i]);
+				overlap[i] = std::min(origin[i] + section_bounds[i], chunk_first[i] + chunk_b[i]) - lo[i];
+			}
+
+			copy(chunk_view(chunk).section(lo - chunk_first, overlap), dst.section(lo - origin, overlap));
+		}
+	}
+
+private:
+	struct cached_chunk
+	{
+		std::ptrdiff_t  index;
+		std::vector<T>  elements;
+	};
+
+	offset_type chunk_origin(const offset_type& chunk) const
+	{
+		offset_type origin;
+		for (size_t i=0; i<Rank; ++i) origin[i] = chunk[i] * chunk_bounds_[i];
+		return origin;
+	}
+
+	// Chunks at the upper edges are cut short by the bounds of the array
+	bounds_type chunk_extent(const offset_type& chunk) const
+	{
+		bounds_type b;
+		for (size_t i=0; i<Rank; ++i) b[i] = std::min(chunk_bounds_[i], bounds_[i] - chunk[i] * chunk_bounds_[i]);
+		return b;
+	}
+
+	array_view<const T, Rank> chunk_view(const offset_type& chunk) const
+	{
+		std::ptrdiff_t index = 0;
+		for (size_t i=0; i<Rank; ++i) index = index * grid_[i] + chunk[i];
+
+		// Accesses with locality are mostly to the most recently used chunk
+		if (!lru_.empty() && lru_.front().index == index) {
+			++stats_.hits;
+			return array_view<const T, Rank>(lru_.front().elements.data(), chunk_extent(chunk));
+		}
+
+		auto found = lookup_.find(index);
+		if (found != lookup_.end())
+		{
+			++stats_.hits;
+			lru_.splice(lru_.begin(), lru_, found->second);
+		}
+		else
+		{
+			++stats_.misses;
+			if (lru_.size() == cache_capacity_)
+			{
+				// Reuse the least recently used chunk's storage
+				lru_.splice(lru_.begin(), lru_, std::prev(lru_.end()));
+				lookup_.erase(lru_.front().index);
+			}
+			else {
+				lru_.push_front({0, std::vector<T>(chunk_bounds_.size())});
+			}
+
+			cached_chunk& cached = lru_.front();
+			cached.index = index;
+			decompress_chunk(chunks_[index], cached.elements.data(), chunk_extent(chunk).size(), scratch_);
+			lookup_[index] = lru_.begin();
+		}
+
+		return array_view<const T, Rank>(lru_.front().elements.data(), chunk_extent(chunk));
+	}
+
+	bounds_type bounds_;
+	bounds_type chunk_bounds_;
+	bounds_type grid_;
+	std::vector<std::vector<unsigned char>> chunks_;
+	size_t compressed_bytes_ = 0;
+	size_t cache_capacity_ = 0;
+
+	mutable std::list<cached_chunk> lru_;
+	mutable std::unordered_map<std::ptrdiff_t, typename std::list<cached_chunk>::iterator> lookup_;
+	mutable cache_stats stats_;
+	mutable std::vector<unsigned char> scratch_;
+};
+
+}
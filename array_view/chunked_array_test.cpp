@@ -0,0 +1,125 @@
+#include "array_view/chunked_array.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace av;
+
+namespace {
+
+	// A smoothly varying volume, as compresses well
+	vector<int32_t> smooth_volume(const bounds<3>& b)
+	{
+		vector<int32_t> vec(b.size());
+		array_view<int32_t, 3> av(vec, b);
+		for (const offset<3>& idx : b) {
+			av[idx] = int32_t(1000 + 10 * idx[0] + idx[1] / 4 + (idx[2] > 20 ? 7 : 0));
+		}
+		return vec;
+	}
+
+} // namespace
+
+TEST(chunked_array_test, ElementAccess)
+{
+	// Extents that are not a multiple of the chunk bounds
+	const bounds<3> b = {21, 33, 40};
+	vector<int32_t> vec = smooth_volume(b);
+	const array_view<const int32_t, 3> dense(vec, b);
+
+	chunked_array<int32_t, 3> chunked(dense, {8, 8, 16}, 4);
+	EXPECT_EQ(b, chunked.bounds());
+	EXPECT_EQ(b.size(), chunked.size());
+	EXPECT_GT(chunked.compression_ratio(), 4.0);
+
+	for (const offset<3>& idx : b) {
+		ASSERT_EQ((dense[idx]), (chunked[idx]));
+	}
+
+	// Each plane of the 3*5*3 chunks passes through 5 rows of 3 chunks, of which the cache holds only
+	// one row at a time, so each of the 21 planes decompresses 15 chunks
+	EXPECT_EQ(b.size(), chunked.stats().hits + chunked.stats().misses);
+	EXPECT_EQ(21u * 15u, chunked.stats().misses);
+}
+
+TEST(chunked_array_test, Read)
+{
+	const bounds<3> b = {21, 33, 40};
+	vector<int32_t> vec = smooth_volume(b);
+	const array_view<const int32_t, 3> dense(vec, b);
+	chunked_array<int32_t, 3> chunked(dense, {8, 8, 8});
+
+	// A section across several chunks, into a strided destination
+	const offset<3> origin = {3, 7, 5};
+	const bounds<3> section_bounds = {12, 20, 30};
+	vector<int32_t> out(2 * section_bounds.size());
+	strided_array_view<int32_t, 3> dst(out.data(), section_bounds, {1200, 60, 2});
+	chunked.read(origin, dst);
+
+	for (const offset<3>& idx : section_bounds) {
+		ASSERT_EQ((dense[origin + idx]), (dst[idx]));
+	}
+
+	// Only the 2*4*5 chunks overlapping the section are decompressed
+	EXPECT_EQ(40u, chunked.stats().misses);
+
+	// A slab, of one plane
+	vector<int32_t> plane(33 * 40);
+	chunked.read({20, 0, 0}, array_view<int32_t, 3>(plane, {1, 33, 40}));
+	EXPECT_EQ((dense[{20, 32, 39}]), plane.back());
+}
+
+TEST(chunked_array_test, Copy)
+{
+	// A copy outlives the array it was copied from, whose cache held chunks when it was copied
+	const bounds<3> b = {21, 33, 40};
+	vector<int32_t> vec = smooth_volume(b);
+	const array_view<const int32_t, 3> dense(vec, b);
+
+	chunked_array<int32_t, 3> copied;
+	{
+		chunked_array<int32_t, 3> source(dense, {8, 8, 8}, 2);
+		EXPECT_EQ((dense[{0, 0, 0}]), (source[{0, 0, 0}]));
+		EXPECT_EQ((dense[{9, 0, 0}]), (source[{9, 0, 0}]));
+
+		chunked_array<int32_t, 3> constructed(source);
+		copied = source;
+		EXPECT_EQ(0u, copied.stats().misses);
+		EXPECT_EQ((dense[{20, 32, 39}]), (constructed[{20, 32, 39}]));
+	}
+
+	for (const offset<3>& idx : {offset<3>{0, 0, 0}, offset<3>{9, 0, 0}, offset<3>{0, 0, 0}, offset<3>{20, 32, 39}}) {
+		EXPECT_EQ((dense[idx]), (copied[idx]));
+	}
+	EXPECT_EQ(1u, copied.stats().hits);
+
+	// A move takes the cache along
+	chunked_array<int32_t, 3> moved(std::move(copied));
+	EXPECT_EQ((dense[{20, 32, 39}]), (moved[{20, 32, 39}]));
+	EXPECT_EQ(2u, moved.stats().hits);
+}
+
+TEST(chunked_array_test, Codec)
+{
+	// Floating point elements, noise, and long runs, each round trip exactly
+	vector<float> floats(1000);
+	for (size_t i=0; i<floats.size(); ++i) floats[i] = std::sin(float(i) * 0.01f);
+	chunked_array<float> float_array(array_view<const float>(floats), {256});
+	for (ptrdiff_t i=0; i<1000; ++i) ASSERT_EQ(floats[i], float_array[{i}]);
+
+	vector<uint8_t> noise(777);
+	unsigned s = 1;
+	for (uint8_t& v : noise) { s = s * 1664525u + 1013904223u; v = uint8_t(s >> 24); }
+	chunked_array<uint8_t> noise_array(array_view<const uint8_t>(noise), {100});
+	for (ptrdiff_t i=0; i<777; ++i) ASSERT_EQ(noise[i], noise_array[{i}]);
+
+	struct triple { uint8_t a, b, c; };
+	vector<triple> runs(5000, triple{1, 2, 3});
+	chunked_array<triple> run_array(array_view<const triple>(runs), {5000});
+	EXPECT_GT(run_array.compression_ratio(), 50.0);
+	EXPECT_EQ(3, (run_array[{4999}].c));
+}
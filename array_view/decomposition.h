@@ -0,0 +1,319 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+#include "array_view.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+/*
+// A partition of a domain into a grid of blocks, each with ghost cells of the given width either
+// side of it in each dimension.  Blocks are identified by their offset within the grid.
+template <size_t Rank>
+class decomposition
+{
+public:
+	static constexpr size_t rank = Rank;
+	using offset_type            = offset<Rank>;
+	using bounds_type            = bounds<Rank>;
+
+	decomposition() noexcept;
+
+	// Into `blocks` blocks, on a grid chosen to keep the blocks near to cubes
+	decomposition(const bounds_type& domain, size_t blocks, const offset_type& ghost = {});
+	decomposition(const bounds_type& domain, const bounds_type& grid, const offset_type& ghost = {});
+
+	// observers
+	bounds_type domain() const noexcept;
+	bounds_type grid() const noexcept;
+	offset_type ghost() const noexcept;
+	size_t      size() const noexcept;  // of the grid
+
+	// The interior of a block, and its interior with the ghost cells that lie within the domain, in
+	// the coordinates of the domain
+	offset_type origin(const offset_type& block) const;
+	bounds_type extent(const offset_type& block) const;
+	offset_type halo_origin(const offset_type& block) const;
+	bounds_type halo_extent(const offset_type& block) const;
+
+	// Those as sections of a view of the whole domain
+	template <typename View>
+	strided_array_view<typename View::value_type, Rank> interior(const View& parent, const offset_type& block) const;
+	template <typename View>
+	strided_array_view<typename View::value_type, Rank> halo(const View& parent, const offset_type& block) const;
+};
+
+// Storage of each block of a decomposition apart, with its ghost cells, so that each thread works
+// on memory of its own and the blocks share data only at exchange
+template <typename T, size_t Rank>
+class block_array
+{
+public:
+	explicit block_array(const decomposition<Rank>& blocks);
+
+	const decomposition<Rank>& blocks() const noexcept;
+
+	// The extent of a block plus its ghost cells either side, with the interior from ghost()
+	array_view<T, Rank>         local(const offset_type& block) const;
+	strided_array_view<T, Rank> interior(const offset_type& block) const;
+
+	template <typename View> void scatter(const View& parent);        // each block's halo from the parent
+	template <typename View> void gather(const View& parent) const;   // each block's interior to the parent
+
+	// Fills the ghost cells of each block from the interiors of its neighbours, including those in
+	// the corners.  Ghost cells outside the domain are left for boundary conditions.
+	void exchange(unsigned threads = 0);
+	void exchange(const offset_type& block, size_t dim);  // the two faces of `block` in `dim`
+};
+*/
+
+namespace av
+{
+
+template <size_t Rank>
+class decomposition
+{
+public:
+	static constexpr size_t rank = Rank;
+	using offset_type            = offset<Rank>;
+	using bounds_type            = av::bounds<Rank>;
+
+	decomposition() noexcept {}
+
+	// Each prime factor of `blocks`, largest first, divides the dimension whose blocks are then
+	// longest, which keeps the faces (and so the ghost cells to exchange) small
+	decomposition(const bounds_type& domain, size_t blocks, const offset_type& ghost = {})
+		: domain_(domain), ghost_(ghost)
+	{
+		assert(blocks > 0);
+		for (size_t dim=0; dim<Rank; ++dim) grid_[dim] = 1;
+
+		std::vector<size_t> factors;
+		for (size_t f=2; f*f<=blocks; ++f) {
+			for (; blocks % f == 0; blocks /= f) factors.push_back(f);
+		}
+		if (blocks > 1) factors.push_back(blocks);
+
+		for (auto f = factors.rbegin(); f != factors.rend(); ++f)
+		{
+			size_t longest = 0;
+			for (size_t dim=1; dim<Rank; ++dim) {
+				if (domain_[dim] * grid_[longest] > domain_[longest] * grid_[dim]) longest = dim;
+			}
+			grid_[longest] *= std::ptrdiff_t(*f);
+		}
+		check();
+	}
+
+	decomposition(const bounds_type& domain, const bounds_type& grid, const offset_type& ghost = {})
+		: domain_(domain), grid_(grid), ghost_(ghost)
+	{
+		check();
+	}
+
+	// observers
+	bounds_type domain() const noexcept { return domain_; }
+	bounds_type grid() const noexcept { return grid_; }
+	offset_type ghost() const noexcept { return ghost_; }
+	size_t      size() const noexcept { return grid_.size(); }
+
+	// Blocks along a dimension differ in extent by at most one
+	offset_type origin(const offset_type& block) const
+	{
+		assert(grid_.contains(block));
+
+		offset_type result;
+		for (size_t dim=0; dim<Rank; ++dim) result[dim] = domain_[dim] * block[dim] / grid_[dim];
+		return result;
+	}
+
+	bounds_type extent(const offset_type& block) const
+	{
+		assert(grid_.contains(block));
+
+		bounds_type result;
+		for (size_t dim=0; dim<Rank; ++dim) {
+			result[dim] = domain_[dim] * (block[dim] + 1) / grid_[dim] - domain_[dim] * block[dim] / grid_[dim];
+		}
+		return result;
+	}
+
+	template <typename View>
+	strided_array_view<typename View::value_type, Rank> interior(const View& parent, const offset_type& block) const
+	{
+		static_assert(View::rank == Rank, "Rank of the view must match that of the decomposition");
+		assert(parent.bounds() == domain_);
+		return parent.section(origin(block), extent(block));
+	}
+
+	offset_type halo_origin(const offset_type& block) const
+	{
+		offset_type result = origin(block);
+		for (size_t dim=0; dim<Rank; ++dim) result[dim] = std::max<std::ptrdiff_t>(result[dim] - ghost_[dim], 0);
+		return result;
+	}
+
+	bounds_type halo_extent(const offset_type& block) const
+	{
+		const offset_type first = origin(block);
+		const bounds_type b = extent(block);
+
+		bounds_type result;
+		for (size_t dim=0; dim<Rank; ++dim) {
+			result[dim] = std::min(first[dim] + b[dim] + ghost_[dim], domain_[dim]) - std::max<std::ptrdiff_t>(first[dim] - ghost_[dim], 0);
+		}
+		return result;
+	}
+
+	template <typename View>
+	strided_array_view<typename View::value_type, Rank> halo(const View& parent, const offset_type& block) const
+	{
+		static_assert(View::rank == Rank, "Rank of the view must match that of the decomposition");
+		assert(parent.bounds() == domain_);
+		return parent.section(halo_origin(block), halo_extent(block));
+	}
+
+private:
+	// Ghost cells come only from the adjacent block, so must be no wider than any block
+	void check() const
+	{
+		for (size_t dim=0; dim<Rank; ++dim)
+		{
+			assert(grid_[dim] > 0 && grid_[dim] <= std::max<std::ptrdiff_t>(domain_[dim], 1) && "Too many blocks for the domain");
+			assert(ghost_[dim] >= 0 && (grid_[dim] == 1 || ghost_[dim] <= domain_[dim] / grid_[dim]) && "Ghost cells wider than a block");
+		}
+	}
+
+	bounds_type domain_;
+	bounds_type grid_;
+	offset_type ghost_;
+};
+
+template <typename T, size_t Rank>
+class block_array
+{
+public:
+	using offset_type = offset<Rank>;
+	using bounds_type = av::bounds<Rank>;
+
+	explicit block_array(const decomposition<Rank>& blocks) : blocks_(blocks)
+	{
+		storage_.reserve(blocks_.size());
+		for (const offset_type& block : blocks_.grid()) {
+			storage_.emplace_back(new T[local_bounds(block).size()]());
+		}
+	}
+
+	const decomposition<Rank>& blocks() const noexcept { return blocks_; }
+
+	array_view<T, Rank> local(const offset_type& block) const
+	{
+		return array_view<T, Rank>(storage_[index_of(block)].get(), local_bounds(block));
+	}
+
+	strided_array_view<T, Rank> interior(const offset_type& block) const
+	{
+		return local(block).section(blocks_.ghost(), blocks_.extent(block));
+	}
+
+	template <typename View>
+	void scatter(const View& parent)
+	{
+		for (const offset_type& block : blocks_.grid())
+		{
+			const offset_type within = blocks_.ghost() - (blocks_.origin(block) - blocks_.halo_origin(block));
+			copy(blocks_.halo(parent, block), local(block).section(within, blocks_.halo_extent(block)));
+		}
+	}
+
+	template <typename View>
+	void gather(const View& parent) const
+	{
+		for (const offset_type& block : blocks_.grid()) {
+			copy(interior(block), blocks_.interior(parent, block));
+		}
+	}
+
+	// Dimensions are exchanged in turn, each face spanning the ghost cells of the dimensions before
+	// it, which by then are filled.  So corners arrive by way of the faces, and no block copies from
+	// more than its 2 * Rank face neighbours.
+	void exchange(unsigned threads = 0)
+	{
+		threads = std::min<unsigned>(default_thread_count(threads), unsigned(blocks_.size()));
+		for (size_t dim=0; dim<Rank; ++dim)
+		{
+			parallel_partition(blocks_.size(), threads, [this, dim](unsigned, size_t first, size_t last) {
+				for (size_t i=first; i<last; ++i) exchange(blocks_.grid().delinearize(std::ptrdiff_t(i)), dim);
+			});
+		}
+	}
+
+	void exchange(const offset_type& block, size_t dim)
+	{
+		assert(dim < Rank);
+		const offset_type ghost = blocks_.ghost();
+		const std::ptrdiff_t width = ghost[dim];
+		if (width == 0) return;
+
+		const array_view<T, Rank> here = local(block);
+		const bounds_type extent = blocks_.extent(block);
+
+		// The face is the full local extent in the dimensions before, the interior in those after
+		offset_type first;
+		bounds_type face;
+		for (size_t d=0; d<Rank; ++d)
+		{
+			first[d] = d < dim ? 0 : ghost[d];
+			face[d] = d < dim ? here.bounds()[d] : extent[d];
+		}
+		face[dim] = width;
+
+		if (block[dim] > 0)
+		{
+			offset_type neighbour = block;
+			--neighbour[dim];
+			offset_type from = first;
+			from[dim] = blocks_.extent(neighbour)[dim];  // its last `width` interior cells
+			offset_type to = first;
+			to[dim] = 0;
+			copy(local(neighbour).section(from, face), here.section(to, face));
+		}
+		if (block[dim] + 1 < blocks_.grid()[dim])
+		{
+			offset_type neighbour = block;
+			++neighbour[dim];
+			offset_type to = first;
+			to[dim] = width + extent[dim];
+			copy(local(neighbour).section(first, face), here.section(to, face));
+		}
+	}
+
+private:
+	bounds_type local_bounds(const offset_type& block) const
+	{
+		bounds_type result = blocks_.extent(block);
+		for (size_t dim=0; dim<Rank; ++dim) result[dim] += 2 * blocks_.ghost()[dim];
+		return result;
+	}
+
+	size_t index_of(const offset_type& block) const
+	{
+		assert(blocks_.grid().contains(block));
+		return size_t(blocks_.grid().linearize(block));
+	}
+
+	decomposition<Rank> blocks_;
+	std::vector<std::unique_ptr<T[]>> storage_;
+};
+
+}
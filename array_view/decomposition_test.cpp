@@ -0,0 +1,139 @@
+#include "array_view/decomposition.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace av;
+
+TEST(decomposition_test, Blocks)
+{
+	// Blocks are split across the longest dimensions first
+	EXPECT_EQ((bounds<2>{2, 2}), (decomposition<2>({1000, 1000}, 4).grid()));
+	EXPECT_EQ((bounds<2>{4, 1}), (decomposition<2>({1000, 10}, 4).grid()));
+	EXPECT_EQ((bounds<3>{3, 2, 2}), (decomposition<3>({300, 200, 200}, 12).grid()));
+	EXPECT_EQ((bounds<1>{7}), (decomposition<1>({100}, 7).grid()));
+
+	// Together the blocks cover the domain once, differing in extent by at most one
+	const decomposition<2> d({101, 37}, bounds<2>{4, 3}, {2, 1});
+	EXPECT_EQ(12u, d.size());
+	vector<int> covered(101 * 37);
+	array_view<int, 2> cover(covered, d.domain());
+	for (const offset<2>& block : d.grid())
+	{
+		const bounds<2> extent = d.extent(block);
+		EXPECT_TRUE(extent[0] == 25 || extent[0] == 26);
+		EXPECT_TRUE(extent[1] == 12 || extent[1] == 13);
+		for_each_element(d.interior(cover, block), [](int& cell) { ++cell; });
+	}
+	for (int cell : covered) EXPECT_EQ(1, cell);
+}
+
+TEST(decomposition_test, Halo)
+{
+	vector<int> data(20 * 30);
+	array_view<int, 2> parent(data, {20, 30});
+	const decomposition<2> d({20, 30}, bounds<2>{2, 3}, {2, 1});
+
+	// The halo is clipped at the edges of the domain
+	EXPECT_EQ((offset<2>{0, 0}), d.halo_origin({0, 0}));
+	EXPECT_EQ((bounds<2>{12, 11}), d.halo_extent({0, 0}));
+	EXPECT_EQ((offset<2>{8, 9}), d.halo_origin({1, 1}));
+	EXPECT_EQ((bounds<2>{12, 12}), d.halo_extent({1, 1}));
+
+	EXPECT_EQ((&parent[{8, 9}]), d.halo(parent, {1, 1}).data());
+	EXPECT_EQ((&parent[{10, 10}]), d.interior(parent, {1, 1}).data());
+	EXPECT_EQ((bounds<2>{10, 10}), d.interior(parent, {1, 1}).bounds());
+}
+
+TEST(decomposition_test, Exchange)
+{
+	const bounds<3> domain = {17, 12, 9};
+	vector<int> data(domain.size());
+	array_view<int, 3> parent(data, domain);
+	for (const offset<3>& idx : domain) parent[idx] = int(domain.linearize(idx));
+
+	const decomposition<3> d(domain, bounds<3>{3, 2, 2}, {2, 1, 1});
+	block_array<int, 3> blocks(d);
+	for (const offset<3>& block : d.grid()) {
+		copy(d.interior(parent, block), blocks.interior(block));
+	}
+
+	// After exchange every cell of each local block within the domain, corners included, holds its
+	// value in the parent, and the cells outside it are untouched
+	blocks.exchange(3);
+	for (const offset<3>& block : d.grid())
+	{
+		const array_view<int, 3> local = blocks.local(block);
+		for (const offset<3>& idx : local.bounds())
+		{
+			const offset<3> global = d.origin(block) + idx - d.ghost();
+			const int expected = domain.contains(global) ? parent[global] : 0;
+			ASSERT_EQ(expected, local[idx]);
+		}
+	}
+
+	// as does scatter, directly
+	block_array<int, 3> scattered(d);
+	scattered.scatter(parent);
+	for (const offset<3>& block : d.grid())
+	{
+		const array_view<int, 3> local = blocks.local(block);
+		EXPECT_TRUE(equal(local.bounds().begin(), local.bounds().end(), scattered.local(block).bounds().begin(),
+		                  [&](const offset<3>& a, const offset<3>& b) { return local[a] == scattered.local(block)[b]; }));
+	}
+}
+
+TEST(decomposition_test, Stencil)
+{
+	// Iterations of a 5-point stencil over the blocks match those over the whole domain, with the
+	// cells on the edges of the domain held fixed
+	const bounds<2> domain = {64, 48};
+	vector<float> a(domain.size());
+	array_view<float, 2> src(a, domain);
+	for (const offset<2>& idx : domain) src[idx] = float((idx[0] * 7 + idx[1] * 13) % 17);
+	vector<float> b = a;
+	array_view<float, 2> dst(b, domain);
+
+	const decomposition<2> d(domain, 6, {1, 1});
+	block_array<float, 2> current(d), next(d);
+	current.scatter(src);
+	next.scatter(src);
+
+	// Over [first, last) of `in`, into the same cells of `out`
+	auto step = [](const array_view<float, 2>& in, const array_view<float, 2>& out, offset<2> first, offset<2> last) {
+		for (ptrdiff_t i=first[0]; i<last[0]; ++i) {
+			for (ptrdiff_t j=first[1]; j<last[1]; ++j) {
+				out[{i, j}] = 0.25f * (in[{i-1, j}] + in[{i+1, j}] + in[{i, j-1}] + in[{i, j+1}]);
+			}
+		}
+	};
+
+	for (int iteration=0; iteration<5; ++iteration)
+	{
+		step(src, dst, {1, 1}, {63, 47});
+		swap(src, dst);
+
+		current.exchange(2);
+		for (const offset<2>& block : d.grid())
+		{
+			const offset<2> origin = d.origin(block);
+			const bounds<2> extent = d.extent(block);
+			offset<2> first, last;
+			for (size_t dim=0; dim<2; ++dim)
+			{
+				first[dim] = 1 + (origin[dim] == 0 ? 1 : 0);
+				last[dim] = 1 + extent[dim] - (origin[dim] + extent[dim] == domain[dim] ? 1 : 0);
+			}
+			step(current.local(block), next.local(block), first, last);
+		}
+		swap(current, next);
+	}
+
+	vector<float> gathered(domain.size());
+	current.gather(array_view<float, 2>(gathered, domain));
+	for (const offset<2>& idx : domain) {
+		ASSERT_EQ(src[idx], gathered[size_t(domain.linearize(idx))]);
+	}
+}
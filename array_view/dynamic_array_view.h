@@ -0,0 +1,267 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+#include "array_view.h"
+
+#include <initializer_list>
+#include <utility>
+
+/*
+constexpr size_t max_dynamic_rank = 8;
+
+// A strided view whose rank is chosen at runtime, from 1 to max_dynamic_rank
+template <typename T>
+class dynamic_array_view
+{
+public:
+	using size_type  = size_t;
+	using value_type = T;
+	using pointer    = T*;
+	using reference  = T&;
+
+	dynamic_array_view() noexcept;                 // of rank 0, with no elements
+
+	// Contiguous in row-major order, or else with the given strides.  The rank must be from 1 to
+	// max_dynamic_rank (see try_dynamic_view for a rank that may not be).
+	dynamic_array_view(pointer ptr, size_t rank, const ptrdiff_t* bounds, const ptrdiff_t* stride = nullptr);
+	dynamic_array_view(pointer ptr, std::initializer_list<ptrdiff_t> bounds);
+
+	template <typename U, size_t Rank>
+	dynamic_array_view(const array_view<U, Rank>& rhs) noexcept;
+	template <typename U, size_t Rank>
+	dynamic_array_view(const strided_array_view<U, Rank>& rhs) noexcept;
+
+	// observers
+	size_t    rank() const noexcept;
+	ptrdiff_t bounds(size_t dim) const;
+	ptrdiff_t stride(size_t dim) const;
+	size_type size() const noexcept;
+	pointer   data() const noexcept;
+
+	// element access, from an index of rank() elements
+	reference operator[](std::initializer_list<ptrdiff_t> idx) const;
+	reference operator[](const ptrdiff_t* idx) const;
+
+	// slicing and sectioning
+	dynamic_array_view slice(size_t dim, ptrdiff_t index) const;           // only if rank() > 1
+	dynamic_array_view section(const ptrdiff_t* origin, const ptrdiff_t* section_bounds) const;
+
+	// As a view of static rank, which must be rank()
+	template <size_t Rank>
+	strided_array_view<T, Rank> as() const;
+	template <size_t Rank>
+	bool try_as(strided_array_view<T, Rank>& result) const;
+};
+
+// Calls fn(views.as<Rank>()...) for the rank of the views, which must all be of the same rank, and
+// returns its result (of the same type for every rank), so that kernels written for static ranks
+// run on views of any rank
+template <typename Fn, typename... T>
+decltype(auto) visit(Fn&& fn, const dynamic_array_view<T>&... views);
+
+// As the constructor from a pointer and rank, for a rank read from data: returns false, leaving
+// `result` empty (of rank 0), if the rank is not from 1 to max_dynamic_rank
+template <typename T>
+bool try_dynamic_view(T* ptr, size_t rank, const ptrdiff_t* bounds, const ptrdiff_t* stride, dynamic_array_view<T>& result);
+*/
+
+namespace av
+{
+
+constexpr size_t max_dynamic_rank = 8;
+
+// The bounds and strides are kept inline, so that views are as cheap to copy as those of static
+// rank.  Element access through a dynamic_array_view loops over its rank, so kernels should be run
+// through `visit` on views of static rank instead.
+template <typename T>
+class dynamic_array_view
+{
+public:
+	using size_type  = size_t;
+	using value_type = T;
+	using pointer    = T*;
+	using reference  = T&;
+
+	dynamic_array_view() noexcept {}
+
+	dynamic_array_view(pointer ptr, size_t rank, const std::ptrdiff_t* bounds, const std::ptrdiff_t* stride = nullptr)
+		: data_(ptr), rank_(rank)
+	{
+		assert(rank >= 1 && rank <= max_dynamic_rank && "Rank of a dynamic_array_view must be from 1 to max_dynamic_rank");
+
+		std::ptrdiff_t contiguous = 1;
+		for (size_t dim=rank; dim-- > 0; )
+		{
+			bounds_[dim] = bounds[dim];
+			stride_[dim] = stride ? stride[dim] : contiguous;
+			contiguous *= bounds[dim];
+		}
+	}
+
+	dynamic_array_view(pointer ptr, std::initializer_list<std::ptrdiff_t> bounds)
+		: dynamic_array_view(ptr, bounds.size(), bounds.begin()) {}
+
+	template <typename U, size_t Rank>
+	dynamic_array_view(const array_view<U, Rank>& rhs) noexcept
+		: dynamic_array_view(strided_array_view<U, Rank>(rhs)) {}
+
+	template <typename U, size_t Rank, typename = std::enable_if_t<is_viewable_value<U, value_type>::value>>
+	dynamic_array_view(const strided_array_view<U, Rank>& rhs) noexcept
+		: data_(rhs.data()), rank_(Rank)
+	{
+		static_assert(Rank <= max_dynamic_rank, "Rank of a dynamic_array_view must be at most max_dynamic_rank");
+		for (size_t dim=0; dim<Rank; ++dim)
+		{
+			bounds_[dim] = rhs.bounds()[dim];
+			stride_[dim] = rhs.stride()[dim];
+		}
+	}
+
+	// observers
+	size_t rank() const noexcept { return rank_; }
+	std::ptrdiff_t bounds(size_t dim) const { assert(dim < rank_); return bounds_[dim]; }
+	std::ptrdiff_t stride(size_t dim) const { assert(dim < rank_); return stride_[dim]; }
+	pointer data() const noexcept { return data_; }
+
+	size_type size() const noexcept
+	{
+		if (rank_ == 0) return 0;
+
+		size_type result = 1;
+		for (size_t dim=0; dim<rank_; ++dim) result *= size_type(bounds_[dim]);
+		return result;
+	}
+
+	// element access
+	reference operator[](std::initializer_list<std::ptrdiff_t> idx) const
+	{
+		assert(idx.size() == rank_);
+		return (*this)[idx.begin()];
+	}
+
+	reference operator[](const std::ptrdiff_t* idx) const
+	{
+		std::ptrdiff_t off = 0;
+		for (size_t dim=0; dim<rank_; ++dim)
+		{
+			assert(0 <= idx[dim] && idx[dim] < bounds_[dim]);
+			off += idx[dim] * stride_[dim];
+		}
+		return data_[off];
+	}
+
+	// slicing and sectioning
+	dynamic_array_view slice(size_t dim, std::ptrdiff_t index) const
+	{
+		assert(rank_ > 1 && dim < rank_ && 0 <= index && index < bounds_[dim]);
+
+		dynamic_array_view result;
+		result.data_ = data_ + index * stride_[dim];
+		result.rank_ = rank_ - 1;
+		for (size_t i=0; i<rank_-1; ++i)
+		{
+			result.bounds_[i] = bounds_[i < dim ? i : i+1];
+			result.stride_[i] = stride_[i < dim ? i : i+1];
+		}
+		return result;
+	}
+
+	dynamic_array_view section(const std::ptrdiff_t* origin, const std::ptrdiff_t* section_bounds) const
+	{
+		dynamic_array_view result = *this;
+		for (size_t dim=0; dim<rank_; ++dim)
+		{
+			assert(0 <= origin[dim] && origin[dim] + section_bounds[dim] <= bounds_[dim]);
+			result.data_ += origin[dim] * stride_[dim];
+			result.bounds_[dim] = section_bounds[dim];
+		}
+		return result;
+	}
+
+	template <size_t Rank>
+	strided_array_view<T, Rank> as() const
+	{
+		strided_array_view<T, Rank> result;
+		const bool matched = try_as(result);
+		assert(matched && "Rank of the view must match that requested");
+		(void)matched;
+		return result;
+	}
+
+	template <size_t Rank>
+	bool try_as(strided_array_view<T, Rank>& result) const
+	{
+		if (rank_ != Rank) return false;
+
+		av::bounds<Rank> b;
+		offset<Rank> s;
+		for (size_t dim=0; dim<Rank; ++dim)
+		{
+			b[dim] = bounds_[dim];
+			s[dim] = stride_[dim];
+		}
+		result = strided_array_view<T, Rank>(data_, b, s);
+		return true;
+	}
+
+private:
+	pointer        data_ = nullptr;
+	size_t         rank_ = 0;
+	std::ptrdiff_t bounds_[max_dynamic_rank] = {};
+	std::ptrdiff_t stride_[max_dynamic_rank] = {};
+};
+
+namespace {
+
+	template <typename Fn, typename... T>
+	decltype(auto) visit_rank(std::integral_constant<size_t, max_dynamic_rank>, Fn&& fn, const dynamic_array_view<T>&... views)
+	{
+		return std::forward<Fn>(fn)(views.template as<max_dynamic_rank>()...);
+	}
+
+	// Compares the rank of the views against each of Rank to max_dynamic_rank in turn
+	template <size_t Rank, typename Fn, typename... T>
+	decltype(auto) visit_rank(std::integral_constant<size_t, Rank>, Fn&& fn, const dynamic_array_view<T>&... views)
+	{
+		const size_t ranks[] = {views.rank()...};
+		if (ranks[0] == Rank) return std::forward<Fn>(fn)(views.template as<Rank>()...);
+		return visit_rank(std::integral_constant<size_t, Rank+1>{}, std::forward<Fn>(fn), views...);
+	}
+
+} // namespace
+
+template <typename Fn, typename... T>
+decltype(auto) visit(Fn&& fn, const dynamic_array_view<T>&... views)
+{
+	static_assert(sizeof...(T) > 0, "visit needs at least one view");
+
+	const size_t ranks[] = {views.rank()...};
+	for (size_t rank : ranks) {
+		assert(rank == ranks[0] && ranks[0] >= 1 && "Views must be of the same rank, of at least 1");
+		(void)rank;
+	}
+	return visit_rank(std::integral_constant<size_t, 1>{}, std::forward<Fn>(fn), views...);
+}
+
+template <typename T>
+bool try_dynamic_view(T* ptr, size_t rank, const std::ptrdiff_t* bounds, const std::ptrdiff_t* stride,
+                      dynamic_array_view<T>& result)
+{
+	if (rank < 1 || rank > max_dynamic_rank)
+	{
+		result = dynamic_array_view<T>();
+		return false;
+	}
+	result = dynamic_array_view<T>(ptr, rank, bounds, stride);
+	return true;
+}
+
+}
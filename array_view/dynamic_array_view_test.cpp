@@ -0,0 +1,118 @@
+#include "array_view/dynamic_array_view.h"
+
+#include <numeric>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace av;
+
+TEST(dynamic_array_view_test, Observers)
+{
+	vector<int> vec(4 * 5 * 6);
+	iota(vec.begin(), vec.end(), 0);
+
+	// Contiguous by default, as an array_view
+	const dynamic_array_view<int> view(vec.data(), {4, 5, 6});
+	EXPECT_EQ(3u, view.rank());
+	EXPECT_EQ(120u, view.size());
+	EXPECT_EQ(5, view.bounds(1));
+	EXPECT_EQ(30, view.stride(0));
+	EXPECT_EQ(1, view.stride(2));
+	EXPECT_EQ((array_view<int, 3>(vec, {4, 5, 6})[{2, 3, 4}]), (view[{2, 3, 4}]));
+
+	// and from views of static rank, keeping their strides
+	const strided_array_view<int, 3> section = array_view<int, 3>(vec, {4, 5, 6}).section({1, 1, 1}, {3, 4, 5});
+	const dynamic_array_view<const int> from_section(section);
+	EXPECT_EQ(section.data(), from_section.data());
+	EXPECT_EQ(60u, from_section.size());
+	EXPECT_EQ((section[{2, 3, 4}]), (from_section[{2, 3, 4}]));
+
+	const ptrdiff_t b[] = {3, 4};
+	const ptrdiff_t s[] = {10, 2};
+	const dynamic_array_view<int> strided(vec.data(), 2, b, s);
+	EXPECT_EQ(26, (strided[{2, 3}]));
+
+	EXPECT_EQ(0u, dynamic_array_view<int>().rank());
+	EXPECT_EQ(0u, dynamic_array_view<int>().size());
+}
+
+TEST(dynamic_array_view_test, TryDynamicView)
+{
+	// A rank from data is checked, rather than asserted
+	vector<int> vec(2 * 3 * 4);
+	const ptrdiff_t b[max_dynamic_rank + 1] = {2, 3, 4, 1, 1, 1, 1, 1, 1};
+
+	dynamic_array_view<int> view;
+	ASSERT_TRUE(try_dynamic_view(vec.data(), 3, b, nullptr, view));
+	EXPECT_EQ(3u, view.rank());
+	EXPECT_EQ(24u, view.size());
+	EXPECT_EQ(4, view.stride(1));
+
+	for (size_t rank : {size_t{0}, max_dynamic_rank + 1, size_t{1} << 40})
+	{
+		EXPECT_FALSE(try_dynamic_view(vec.data(), rank, b, nullptr, view)) << rank;
+		EXPECT_EQ(0u, view.rank());
+		EXPECT_EQ(0u, view.size());
+		EXPECT_EQ(nullptr, view.data());
+	}
+
+	ASSERT_TRUE(try_dynamic_view(vec.data(), max_dynamic_rank, b, nullptr, view));
+	EXPECT_EQ(max_dynamic_rank, view.rank());
+}
+
+TEST(dynamic_array_view_test, SliceAndSection)
+{
+	vector<int> vec(4 * 5 * 6);
+	iota(vec.begin(), vec.end(), 0);
+	const array_view<int, 3> av(vec, {4, 5, 6});
+	const dynamic_array_view<int> view(av);
+
+	// As slice(dim, index) of a static view
+	const dynamic_array_view<int> plane = view.slice(1, 2);
+	EXPECT_EQ(2u, plane.rank());
+	const strided_array_view<int, 2> expected = av.slice<1>(2);
+	EXPECT_EQ(expected.data(), plane.data());
+	for (const offset<2>& idx : expected.bounds()) {
+		EXPECT_EQ(expected[idx], (plane[{idx[0], idx[1]}]));
+	}
+
+	const ptrdiff_t origin[] = {1, 2, 3};
+	const ptrdiff_t extent[] = {2, 2, 2};
+	const dynamic_array_view<int> section = view.section(origin, extent);
+	EXPECT_EQ(8u, section.size());
+	EXPECT_EQ((av[{2, 3, 4}]), (section[{1, 1, 1}]));
+}
+
+TEST(dynamic_array_view_test, Visit)
+{
+	vector<float> a(2 * 3 * 4 * 5 * 2), b(a.size());
+	iota(a.begin(), a.end(), 1.f);
+
+	// Views of each rank from 1 to 8 reach the kernel as views of that static rank
+	for (size_t rank=1; rank<=max_dynamic_rank; ++rank)
+	{
+		vector<ptrdiff_t> bounds(rank, 1);
+		bounds[0] = ptrdiff_t(a.size());
+		const dynamic_array_view<const float> src(a.data(), rank, bounds.data());
+		const dynamic_array_view<float> dst(b.data(), rank, bounds.data());
+
+		const size_t seen = visit([](auto in, auto out) {
+			static_assert(decltype(in)::rank == decltype(out)::rank, "");
+			copy(in, out);
+			return decltype(in)::rank;
+		}, src, dst);
+		EXPECT_EQ(rank, seen);
+		EXPECT_EQ(a, b);
+		fill(b.begin(), b.end(), 0.f);
+	}
+
+	// as and try_as
+	const dynamic_array_view<float> view(a.data(), {2, 3, 4, 5, 2});
+	strided_array_view<float, 4> wrong;
+	EXPECT_FALSE(view.try_as(wrong));
+	const strided_array_view<float, 5> right = view.as<5>();
+	EXPECT_EQ((offset<5>{120, 40, 10, 2, 1}), right.stride());
+	EXPECT_EQ(a.back(), (right[{1, 2, 3, 4, 1}]));
+}
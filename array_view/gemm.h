@@ -0,0 +1,295 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+#include "array_view.h"
+#include "batch.h"
+#include "parallel.h"
+
+#include <algorithm>
+#include <vector>
+
+/*
+// c = alpha * a * b + beta * c, for a of bounds {M, K}, b of {K, N} and c of {M, N}, using
+// `threads` threads.  Any of the views may be strided, so a transposed operand is a view with its
+// strides swapped.  c must not overlap a or b.
+template <typename AView, typename BView, typename CView>
+void gemm(const AView& a, const BView& b, const CView& c,
+          typename CView::value_type alpha = 1, typename CView::value_type beta = 0, unsigned threads = 0);
+*/
+
+namespace av
+{
+
+namespace {
+
+	// The product is built from tiles of gemm_mr rows by gemm_nr columns of c, each held in
+	// registers as it is accumulated, from packed copies of a and b.  The dimensions are blocked so
+	// that a panel of b (gemm_kc by gemm_nr) stays in L1, a block of a (gemm_mc by gemm_kc) in L2,
+	// and the packed b (gemm_kc by gemm_nc) in L3.
+	template <typename T> constexpr size_t gemm_lanes = default_lanes<T>;
+	template <typename T> constexpr std::ptrdiff_t gemm_mr = 6;
+	template <typename T> constexpr std::ptrdiff_t gemm_nr = 2 * gemm_lanes<T>;
+	template <typename T> constexpr std::ptrdiff_t gemm_kc = 16384 / (gemm_nr<T> * sizeof(T));
+	template <typename T> constexpr std::ptrdiff_t gemm_mc = 131072 / (gemm_kc<T> * sizeof(T)) / gemm_mr<T> * gemm_mr<T>;
+	template <typename T> constexpr std::ptrdiff_t gemm_nc = 4096 / gemm_nr<T> * gemm_nr<T>;
+
+	// Below this many multiply-adds, a product runs on the calling thread alone
+	constexpr double gemm_parallel_threshold = 1 << 21;
+
+	// Packs rows [0, m) and columns [0, k) of `a` as consecutive panels of gemm_mr rows, each
+	// column of a panel contiguous, padding the last panel with zeros
+	template <typename T>
+	void pack_a(const T* a, std::ptrdiff_t row_stride, std::ptrdiff_t column_stride,
+	            std::ptrdiff_t m, std::ptrdiff_t k, T* packed)
+	{
+		constexpr std::ptrdiff_t mr = gemm_mr<T>;
+		for (std::ptrdiff_t i0=0; i0<m; i0+=mr)
+		{
+			const std::ptrdiff_t rows = std::min(mr, m - i0);
+			for (std::ptrdiff_t p=0; p<k; ++p)
+			{
+				const T* column = a + i0 * row_stride + p * column_stride;
+				for (std::ptrdiff_t i=0; i<rows; ++i) packed[i] = column[i * row_stride];
+				for (std::ptrdiff_t i=rows; i<mr; ++i) packed[i] = T{};
+				packed += mr;
+			}
+		}
+	}
+
+	// Packs rows [0, k) and columns [0, n) of `b` as consecutive panels of gemm_nr columns, each
+	// row of a panel as two lanes, padding the last panel with zeros
+	template <typename T>
+	void pack_b(const T* b, std::ptrdiff_t row_stride, std::ptrdiff_t column_stride,
+	            std::ptrdiff_t k, std::ptrdiff_t n, lanes<T, gemm_lanes<T>>* packed)
+	{
+		constexpr std::ptrdiff_t nr = gemm_nr<T>;
+		constexpr std::ptrdiff_t w = gemm_lanes<T>;
+		for (std::ptrdiff_t j0=0; j0<n; j0+=nr)
+		{
+			const std::ptrdiff_t columns = std::min(nr, n - j0);
+			for (std::ptrdiff_t p=0; p<k; ++p)
+			{
+				const T* row = b + p * row_stride + j0 * column_stride;
+				if (columns == nr && column_stride == 1) {
+					for (std::ptrdiff_t j=0; j<w; ++j) packed[0][j] = row[j];
+					for (std::ptrdiff_t j=0; j<w; ++j) packed[1][j] = row[w + j];
+				}
+				else {
+					for (std::ptrdiff_t j=0; j<nr; ++j) {
+						packed[j / w][j % w] = j < columns ? row[j * column_stride] : T{};
+					}
+				}
+				packed += 2;
+			}
+		}
+	}
+
+	// Accumulates the product of a packed panel of a and of b over k into a tile, then adds alpha
+	// times the tile to the `m` by `n` corner of c, scaling c by beta first
+	template <typename T>
+	void gemm_micro_kernel(std::ptrdiff_t k, const T* a, const lanes<T, gemm_lanes<T>>* b,
+	                       T* c, std::ptrdiff_t row_stride, std::ptrdiff_t column_stride,
+	                       std::ptrdiff_t m, std::ptrdiff_t n, T alpha, T beta)
+	{
+		constexpr std::ptrdiff_t mr = gemm_mr<T>;
+		constexpr std::ptrdiff_t w = gemm_lanes<T>;
+		using lanes_type = lanes<T, gemm_lanes<T>>;
+
+		lanes_type acc[mr][2];
+		for (std::ptrdiff_t p=0; p<k; ++p)
+		{
+			const lanes_type b0 = b[2*p];
+			const lanes_type b1 = b[2*p + 1];
+			for (std::ptrdiff_t i=0; i<mr; ++i)
+			{
+				const lanes_type ai(a[p * mr + i]);
+				acc[i][0] += ai * b0;
+				acc[i][1] += ai * b1;
+			}
+		}
+
+		const lanes_type alpha_lanes(alpha);
+		for (std::ptrdiff_t i=0; i<mr; ++i)
+		{
+			acc[i][0] *= alpha_lanes;
+			acc[i][1] *= alpha_lanes;
+		}
+
+		// Whole tiles of contiguous rows update a vector at a time, and as beta is zero or one
+		// except for the first block of k, without multiplying by it
+		if (m == mr && n == 2*w && column_stride == 1)
+		{
+			for (std::ptrdiff_t i=0; i<mr; ++i)
+			{
+				T* row = c + i * row_stride;
+				lanes_type c0, c1;
+				if (beta != T{0})
+				{
+					std::copy(row, row + w, &c0[0]);
+					std::copy(row + w, row + 2*w, &c1[0]);
+					if (beta != T{1}) {
+						c0 *= lanes_type(beta);
+						c1 *= lanes_type(beta);
+					}
+				}
+				c0 += acc[i][0];
+				c1 += acc[i][1];
+				std::copy(&c0[0], &c0[0] + w, row);
+				std::copy(&c1[0], &c1[0] + w, row + w);
+			}
+			return;
+		}
+
+		for (std::ptrdiff_t i=0; i<m; ++i)
+		{
+			for (std::ptrdiff_t j=0; j<n; ++j)
+			{
+				T& element = c[i * row_stride + j * column_stride];
+				element = (beta == T{0} ? T{0} : beta * element) + acc[i][j / w][j % w];
+			}
+		}
+	}
+
+	// The product on the calling thread, over the blocks of each dimension in turn
+	template <typename T>
+	void gemm_serial(const strided_array_view<const T, 2>& a, const strided_array_view<const T, 2>& b,
+	                 const strided_array_view<T, 2>& c, T alpha, T beta)
+	{
+		constexpr std::ptrdiff_t mr = gemm_mr<T>;
+		constexpr std::ptrdiff_t nr = gemm_nr<T>;
+		constexpr std::ptrdiff_t kc = gemm_kc<T>;
+		constexpr std::ptrdiff_t mc = gemm_mc<T>;
+		constexpr std::ptrdiff_t nc = gemm_nc<T>;
+
+		const std::ptrdiff_t m = c.bounds()[0];
+		const std::ptrdiff_t n = c.bounds()[1];
+		const std::ptrdiff_t k = a.bounds()[1];
+
+		const std::ptrdiff_t a0 = a.stride()[0], a1 = a.stride()[1];
+		const std::ptrdiff_t b0 = b.stride()[0], b1 = b.stride()[1];
+		const std::ptrdiff_t c0 = c.stride()[0], c1 = c.stride()[1];
+
+		// Nothing to accumulate, so just scale c
+		if (k == 0 || alpha == T{0})
+		{
+			for_each_element(c, [beta](T& element) { element = beta == T{0} ? T{0} : beta * element; });
+			return;
+		}
+
+		std::vector<T> packed_a(std::min(mc, (m + mr - 1) / mr * mr) * std::min(kc, k));
+		std::vector<lanes<T, gemm_lanes<T>>> packed_b(std::min(nc, (n + nr - 1) / nr * nr) / nr * 2 * std::min(kc, k));
+
+		for (std::ptrdiff_t j0=0; j0<n; j0+=nc)
+		{
+			const std::ptrdiff_t nb = std::min(nc, n - j0);
+			for (std::ptrdiff_t p0=0; p0<k; p0+=kc)
+			{
+				const std::ptrdiff_t kb = std::min(kc, k - p0);
+				const T block_beta = p0 == 0 ? beta : T{1};
+				pack_b(b.data() + p0 * b0 + j0 * b1, b0, b1, kb, nb, packed_b.data());
+
+				for (std::ptrdiff_t i0=0; i0<m; i0+=mc)
+				{
+					const std::ptrdiff_t mb = std::min(mc, m - i0);
+					pack_a(a.data() + i0 * a0 + p0 * a1, a0, a1, mb, kb, packed_a.data());
+
+					for (std::ptrdiff_t j=0; j<nb; j+=nr) {
+						for (std::ptrdiff_t i=0; i<mb; i+=mr) {
+							gemm_micro_kernel(kb, packed_a.data() + i * kb, packed_b.data() + j / nr * 2 * kb,
+							                  c.data() + (i0 + i) * c0 + (j0 + j) * c1, c0, c1,
+							                  std::min(mr, mb - i), std::min(nr, nb - j), alpha, block_beta);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// Whether c shares an element with an operand.  may_overlap answers most cases exactly, but
+	// reports partial overlap of any views whose spans interleave (such as blocks of columns of one
+	// matrix), which are then compared element by element.  Only called in assertions.
+	template <typename T>
+	bool shares_elements(const strided_array_view<T, 2>& c, const strided_array_view<const T, 2>& operand)
+	{
+		switch (may_overlap(c, operand))
+		{
+		case overlap::disjoint:  return false;
+		case overlap::identical: return true;
+		case overlap::partial:   break;
+		}
+
+		std::vector<const T*> elements;
+		elements.reserve(c.size());
+		for (const offset<2>& idx : c.bounds()) elements.push_back(&c[idx]);
+		std::sort(elements.begin(), elements.end());
+		for (const offset<2>& idx : operand.bounds()) {
+			if (std::binary_search(elements.begin(), elements.end(), &operand[idx])) return true;
+		}
+		return false;
+	}
+
+} // namespace
+
+// The product is divided between threads by rows of c, or by columns where there are more of those,
+// so that each thread packs and writes its own part independently of the others.  Each element of c
+// sums over k in the same order however the work is divided, so the result does not depend on the
+// number of threads.
+template <typename AView, typename BView, typename CView>
+void gemm(const AView& a, const BView& b, const CView& c,
+          typename CView::value_type alpha = 1, typename CView::value_type beta = 0, unsigned threads = 0)
+{
+	static_assert(AView::rank == 2 && BView::rank == 2 && CView::rank == 2, "gemm requires views of rank 2");
+
+	using T = typename CView::value_type;
+	static_assert(std::is_arithmetic<T>::value, "gemm requires views of an arithmetic type");
+
+	const strided_array_view<const T, 2> sa(a);
+	const strided_array_view<const T, 2> sb(b);
+	const strided_array_view<T, 2> sc(c);
+
+	const std::ptrdiff_t m = sc.bounds()[0];
+	const std::ptrdiff_t n = sc.bounds()[1];
+	const std::ptrdiff_t k = sa.bounds()[1];
+	assert(sa.bounds()[0] == m && sb.bounds()[0] == k && sb.bounds()[1] == n && "Bounds of gemm operands must agree");
+	assert(!shares_elements(sc, sa) && !shares_elements(sc, sb) && "The result of gemm must not overlap its operands");
+	if (m == 0 || n == 0) return;
+
+	threads = default_thread_count(threads);
+	if (double(m) * double(n) * double(k) < gemm_parallel_threshold) threads = 1;
+
+	if (threads == 1)
+	{
+		gemm_serial(sa, sb, sc, alpha, beta);
+		return;
+	}
+
+	// Divide whole tiles between the threads
+	const bool by_rows = m >= n;
+	const std::ptrdiff_t tile = by_rows ? gemm_mr<T> : gemm_nr<T>;
+	const std::ptrdiff_t extent = by_rows ? m : n;
+	const size_t tiles = size_t((extent + tile - 1) / tile);
+	threads = unsigned(std::min<size_t>(threads, tiles));
+
+	parallel_partition(tiles, threads, [&](unsigned, size_t first, size_t last) {
+		const std::ptrdiff_t begin = std::ptrdiff_t(first) * tile;
+		const std::ptrdiff_t end = std::min(extent, std::ptrdiff_t(last) * tile);
+		if (begin >= end) return;
+
+		if (by_rows) {
+			gemm_serial(sa.section({begin, 0}, {end - begin, k}), sb, sc.section({begin, 0}, {end - begin, n}), alpha, beta);
+		}
+		else {
+			gemm_serial(sa, sb.section({0, begin}, {k, end - begin}), sc.section({0, begin}, {m, end - begin}), alpha, beta);
+		}
+	});
+}
+
+}
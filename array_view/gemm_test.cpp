@@ -0,0 +1,175 @@
+#include "array_view/gemm.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace av;
+
+namespace {
+
+	template <typename T>
+	vector<T> random_matrix(size_t size, unsigned seed)
+	{
+		vector<T> vec(size);
+		for (T& v : vec) {
+			seed = seed * 1664525u + 1013904223u;
+			v = T(int(seed >> 24) - 128) / T(64);
+		}
+		return vec;
+	}
+
+	// The triple loop, in double precision
+	template <typename AView, typename BView, typename CView>
+	vector<double> naive_gemm(const AView& a, const BView& b, const CView& c, double alpha, double beta)
+	{
+		const ptrdiff_t m = c.bounds()[0], n = c.bounds()[1], k = a.bounds()[1];
+		vector<double> result(size_t(m * n));
+		for (ptrdiff_t i=0; i<m; ++i) {
+			for (ptrdiff_t j=0; j<n; ++j) {
+				double sum = 0;
+				for (ptrdiff_t p=0; p<k; ++p) sum += double(a[{i,p}]) * double(b[{p,j}]);
+				result[size_t(i * n + j)] = alpha * sum + (beta == 0 ? 0 : beta * double(c[{i,j}]));
+			}
+		}
+		return result;
+	}
+
+	template <typename CView>
+	void expect_near(const vector<double>& expected, const CView& c, double tolerance)
+	{
+		const ptrdiff_t n = c.bounds()[1];
+		for (const offset<2>& idx : c.bounds()) {
+			ASSERT_NEAR(expected[size_t(idx[0] * n + idx[1])], double(c[idx]), tolerance) << idx[0] << "," << idx[1];
+		}
+	}
+
+	template <typename T>
+	void test_sizes(double tolerance)
+	{
+		// Sizes about the tile and block edges, and past a block of k
+		const ptrdiff_t sizes[][3] = {{1,1,1}, {7,13,5}, {6,16,4}, {37,41,300}, {100,3,70}, {2,200,9}, {70,30,1100}};
+		for (const auto& size : sizes)
+		{
+			const ptrdiff_t m = size[0], n = size[1], k = size[2];
+			vector<T> avec = random_matrix<T>(size_t(m * k), 1);
+			vector<T> bvec = random_matrix<T>(size_t(k * n), 2);
+			vector<T> cvec = random_matrix<T>(size_t(m * n), 3);
+			const array_view<const T, 2> a(avec, {m, k});
+			const array_view<const T, 2> b(bvec, {k, n});
+			const array_view<T, 2> c(cvec, {m, n});
+
+			const vector<double> expected = naive_gemm(a, b, c, 1.5, 0.5);
+			gemm(a, b, c, T(1.5), T(0.5), 1);
+			expect_near(expected, c, tolerance * double(k));
+		}
+	}
+
+} // namespace
+
+TEST(gemm_test, Float)
+{
+	test_sizes<float>(1e-5);
+}
+
+TEST(gemm_test, Double)
+{
+	test_sizes<double>(1e-12);
+}
+
+TEST(gemm_test, Strided)
+{
+	// A transposed a, by its strides, a b of every other column, and a section of a larger c
+	const ptrdiff_t m = 29, n = 35, k = 50;
+	vector<float> atvec = random_matrix<float>(size_t(k * m), 4);
+	vector<float> bvec = random_matrix<float>(size_t(k * 2 * n), 5);
+	vector<float> cvec = random_matrix<float>(size_t((m + 4) * (n + 10)), 6);
+
+	const strided_array_view<const float, 2> a(atvec.data(), {m, k}, {1, m});
+	const strided_array_view<const float, 2> b(bvec.data(), {k, n}, {2 * n, 2});
+	const strided_array_view<float, 2> c = array_view<float, 2>(cvec, {m + 4, n + 10}).section({2, 5}, {m, n});
+	const vector<float> before = cvec;
+
+	const vector<double> expected = naive_gemm(a, b, c, -1.0, 2.0);
+	gemm(a, b, c, -1.f, 2.f, 1);
+	expect_near(expected, c, 1e-3);
+
+	// Outside of the section, c is untouched
+	const array_view<const float, 2> whole(cvec, {m + 4, n + 10});
+	const array_view<const float, 2> original(before, {m + 4, n + 10});
+	EXPECT_EQ((original[{0, 0}]), (whole[{0, 0}]));
+	EXPECT_EQ((original[{1, 7}]), (whole[{1, 7}]));
+	EXPECT_EQ((original[{m + 2, n + 5}]), (whole[{m + 2, n + 5}]));
+	EXPECT_EQ((original[{10, 4}]), (whole[{10, 4}]));
+}
+
+TEST(gemm_test, BetaZero)
+{
+	// As for BLAS, c is not read when beta is zero, so NaNs there are overwritten
+	const ptrdiff_t m = 13, n = 17, k = 8;
+	vector<double> avec = random_matrix<double>(size_t(m * k), 7);
+	vector<double> bvec = random_matrix<double>(size_t(k * n), 8);
+	vector<double> cvec(size_t(m * n), numeric_limits<double>::quiet_NaN());
+	const array_view<const double, 2> a(avec, {m, k});
+	const array_view<const double, 2> b(bvec, {k, n});
+	const array_view<double, 2> c(cvec, {m, n});
+
+	gemm(a, b, c);
+	const vector<double> expected = naive_gemm(a, b, c, 1.0, 0.0);
+	expect_near(expected, c, 1e-12);
+
+	// With nothing to sum, c is only scaled
+	vector<double> empty;
+	gemm(array_view<const double, 2>(empty.data(), {m, 0}), array_view<const double, 2>(empty.data(), {0, n}), c, 1.0, 2.0);
+	EXPECT_EQ(2 * expected[5], cvec[5]);
+}
+
+TEST(gemm_test, Threads)
+{
+	// The result is the same however the work is divided, by rows or by columns
+	const ptrdiff_t shapes[][3] = {{200, 90, 150}, {40, 300, 200}};
+	for (const auto& shape : shapes)
+	{
+		const ptrdiff_t m = shape[0], n = shape[1], k = shape[2];
+		vector<float> avec = random_matrix<float>(size_t(m * k), 9);
+		vector<float> bvec = random_matrix<float>(size_t(k * n), 10);
+		vector<float> serial(size_t(m * n), 1.f), parallel(size_t(m * n), 1.f);
+		const array_view<const float, 2> a(avec, {m, k});
+		const array_view<const float, 2> b(bvec, {k, n});
+
+		gemm(a, b, array_view<float, 2>(serial, {m, n}), 1.f, 1.f, 1);
+		gemm(a, b, array_view<float, 2>(parallel, {m, n}), 1.f, 1.f, 3);
+		EXPECT_EQ(serial, parallel);
+	}
+}
+
+TEST(gemm_test, Sections)
+{
+	// Blocks of columns of one matrix are disjoint, though their spans interleave
+	const ptrdiff_t m = 8, k = 4, n = 4;
+	vector<float> vec = random_matrix<float>(size_t(m * 12), 11);
+	const array_view<float, 2> whole(vec, {m, 12});
+	const strided_array_view<float, 2> a = whole.section({0, 0}, {m, k});
+	const strided_array_view<float, 2> b = whole.section({0, 4}, {k, n});
+	const strided_array_view<float, 2> c = whole.section({0, 8}, {m, n});
+
+	const vector<double> expected = naive_gemm(a, b, c, 1.0, 0.5);
+	gemm(a, b, c, 1.f, 0.5f);
+	expect_near(expected, c, 1e-5);
+}
+
+#ifndef NDEBUG
+TEST(gemm_test, Overlap)
+{
+	// c must not overlap a or b, in place or in part
+	vector<float> vec(64, 1.f);
+	const array_view<float, 2> whole(vec, {8, 8});
+	EXPECT_DEATH(gemm(whole, whole, whole), "");
+	EXPECT_DEATH(gemm(whole.section({0,0}, {4,8}), whole.section({0,0}, {8,8}), whole.section({2,0}, {4,8})), "");
+	EXPECT_DEATH(gemm(array_view<const float, 2>(vec.data(), {4, 4}), whole.section({4,0}, {4,4}),
+	                  strided_array_view<float, 2>(vec.data() + 16, {4, 4}, {8, 1})), "");
+}
+#endif
@@ -0,0 +1,673 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+#include "array_view.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/*
+template <typename T, size_t Rank = 1>
+class index_array_view
+{
+public:
+	static constexpr size_t rank = Rank;
+	using offset_type            = offset<Rank>;
+	using bounds_type            = bounds<Rank>;
+	using size_type              = size_t;
+	using value_type             = T;
+	using pointer                = T*;
+	using reference              = T&;
+
+	index_array_view() noexcept;
+
+	// `indices` are row-major (linear) indices into the bounds of `base`
+	index_array_view(const strided_array_view<T, Rank>& base, std::vector<ptrdiff_t> indices);
+
+	// observers
+	strided_array_view<T, Rank>  base()    const noexcept;
+	size_type                    size()    const noexcept;   // the number of active elements
+	array_view<const ptrdiff_t>  indices() const noexcept;
+	array_view<const ptrdiff_t>  offsets() const noexcept;   // of each active element from base().data()
+
+	// element access, to the n'th active element
+	reference   operator[](size_type n) const;
+	offset_type index(size_type n) const;
+
+	// traversal of the active elements
+	template <typename Fn> void for_each(Fn fn) const;
+	template <typename U>  void gather(const array_view<U, 1>& out) const;
+	template <typename U>  void scatter(const array_view<U, 1>& in) const;
+};
+
+// The row-major indices of the non-zero elements of `mask`
+template <typename M, size_t Rank>
+std::vector<ptrdiff_t> compact(const strided_array_view<M, Rank>& mask);
+
+// A view of the elements of `view` for which `mask` (of the same bounds) is non-zero
+template <typename T, typename M, size_t Rank>
+index_array_view<T, Rank> masked(const strided_array_view<T, Rank>& view, const strided_array_view<M, Rank>& mask);
+
+// A view of `base` with the indices along `dim` mapped through a list: element idx of the view is
+// the element of `base` at idx, but for indices[idx[dim]] in `dim`.  Elements are accessed through
+// the base, so the view is evaluated lazily.
+template <typename T, size_t Rank = 1>
+class indirect_array_view
+{
+public:
+	static constexpr size_t rank = Rank;
+	using offset_type            = offset<Rank>;
+	using bounds_type            = bounds<Rank>;
+	using size_type              = size_t;
+	using value_type             = T;
+	using pointer                = T*;
+	using reference              = T&;
+
+	indirect_array_view() noexcept;
+	indirect_array_view(const strided_array_view<T, Rank>& base, std::vector<ptrdiff_t> indices, size_t dim = 0);
+
+	// observers
+	strided_array_view<T, Rank>  base()    const noexcept;
+	size_t                       dim()     const noexcept;
+	bounds_type                  bounds()  const noexcept;   // of base(), but for indices().size() in dim()
+	size_type                    size()    const noexcept;
+	array_view<const ptrdiff_t>  indices() const noexcept;
+	array_view<const ptrdiff_t>  offsets() const noexcept;   // of each index along dim() of base()
+
+	// element access
+	reference operator[](const offset_type& idx) const;
+
+	// all of the elements, to and from a view of bounds()
+	template <typename View> void gather(const View& out) const;
+	template <typename View> void scatter(const View& in) const;
+};
+
+template <typename T, size_t Rank>
+indirect_array_view<T, Rank> indirect(const strided_array_view<T, Rank>& view, std::vector<ptrdiff_t> indices, size_t dim = 0);
+
+// Copies the elements of `src` at `indices` along `dim` to `dst`, as indirect(src, indices, dim).gather(dst)
+template <typename T, size_t Rank, typename View>
+void take(const strided_array_view<T, Rank>& src, const std::vector<ptrdiff_t>& indices, size_t dim, const View& dst);
+
+// Copies `src` to the elements of `dst` at `indices` along `dim`, as indirect(dst, indices, dim).scatter(src).
+// Of repeated indices, the last is stored.
+template <typename T, size_t Rank, typename View>
+void put(const strided_array_view<T, Rank>& dst, const std::vector<ptrdiff_t>& indices, size_t dim, const View& src);
+*/
+
+namespace av
+{
+
+namespace {
+
+	inline unsigned count_trailing_zeros(std::uint32_t bits)
+	{
+	#if defined(__GNUC__)
+		return static_cast<unsigned>(__builtin_ctz(bits));
+	#else
+		unsigned n = 0;
+		while (!(bits & 1u)) { bits >>= 1; ++n; }
+		return n;
+	#endif
+	}
+
+	// Appends first + i to `out` for each non-zero mask[i], i in [0, n), returning the new end of `out`
+	template <typename M>
+	std::ptrdiff_t* compact_row(const M* mask, std::ptrdiff_t n, std::ptrdiff_t first, std::ptrdiff_t* out)
+	{
+		std::ptrdiff_t i = 0;
+
+	#if defined(__SSE2__)
+		// Test a vector of bytes at once, for masks of bytes, and visit only the set bits of the result
+		if (sizeof(M) == 1)
+		{
+			const char* bytes = reinterpret_cast<const char*>(mask);
+		#if defined(__AVX2__)
+			for (; i+32<=n; i+=32)
+			{
+				const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+				std::uint32_t bits = ~static_cast<std::uint32_t>(
+					_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_setzero_si256())));
+				for (; bits; bits &= bits - 1) {
+					*out++ = first + i + count_trailing_zeros(bits);
+				}
+			}
+		#endif
+			for (; i+16<=n; i+=16)
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+				std::uint32_t bits = ~static_cast<std::uint32_t>(
+					_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128()))) & 0xffffu;
+				for (; bits; bits &= bits - 1) {
+					*out++ = first + i + count_trailing_zeros(bits);
+				}
+			}
+		}
+	#endif
+
+		for (; i<n; ++i) {
+			if (mask[i]) *out++ = first + i;
+		}
+		return out;
+	}
+
+	// out[i] = data[offsets[i]] for i in [0, n), where there are no vector gathers for the types
+	template <typename T, typename U>
+	void gather_offsets(const T* data, const std::ptrdiff_t* offsets, std::ptrdiff_t n, U* out, std::false_type)
+	{
+		for (std::ptrdiff_t i=0; i<n; ++i) {
+			out[i] = data[offsets[i]];
+		}
+	}
+
+	// data[offsets[i]] = in[i] for i in [0, n) in order, so that of repeated offsets the last is stored
+	template <typename T, typename U>
+	void scatter_offsets(T* data, const std::ptrdiff_t* offsets, std::ptrdiff_t n, const U* in, std::false_type)
+	{
+		for (std::ptrdiff_t i=0; i<n; ++i) {
+			data[offsets[i]] = in[i];
+		}
+	}
+
+	// Elements of 4 or 8 bytes are moved by vector gathers (AVX2) and scatters (AVX-512) of their
+	// bits, when of the same arithmetic type at either end
+	template <typename T, typename U>
+	using gather_scatter_words = std::integral_constant<bool,
+		std::is_same<std::remove_const_t<T>, std::remove_const_t<U>>::value && std::is_arithmetic<U>::value &&
+		(sizeof(U) == 4 || sizeof(U) == 8)>;
+
+#if defined(__AVX2__)
+	template <typename T, typename U>
+	using vector_gather = gather_scatter_words<T, U>;
+#else
+	template <typename T, typename U>
+	using vector_gather = std::false_type;
+#endif
+
+#if defined(__AVX512F__)
+	template <typename T, typename U>
+	using vector_scatter = gather_scatter_words<T, U>;
+#else
+	template <typename T, typename U>
+	using vector_scatter = std::false_type;
+#endif
+
+#if defined(__AVX2__)
+	// Each returns the number of elements moved, a multiple of the vector width, leaving the rest
+	inline std::ptrdiff_t gather_words(const void* data, const std::ptrdiff_t* offsets, std::ptrdiff_t n, void* out, std::integral_constant<size_t, 4>)
+	{
+		const int* base = static_cast<const int*>(data);
+		int* to = static_cast<int*>(out);
+		std::ptrdiff_t i = 0;
+	#if defined(__AVX512F__)
+		for (; i+8<=n; i+=8)
+		{
+			const __m512i off = _mm512_loadu_si512(offsets + i);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(to + i), _mm512_i64gather_epi32(off, base, 4));
+		}
+	#endif
+		for (; i+4<=n; i+=4)
+		{
+			const __m256i off = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(to + i), _mm256_i64gather_epi32(base, off, 4));
+		}
+		return i;
+	}
+
+	inline std::ptrdiff_t gather_words(const void* data, const std::ptrdiff_t* offsets, std::ptrdiff_t n, void* out, std::integral_constant<size_t, 8>)
+	{
+		const long long* base = static_cast<const long long*>(data);
+		long long* to = static_cast<long long*>(out);
+		std::ptrdiff_t i = 0;
+	#if defined(__AVX512F__)
+		for (; i+8<=n; i+=8)
+		{
+			const __m512i off = _mm512_loadu_si512(offsets + i);
+			_mm512_storeu_si512(to + i, _mm512_i64gather_epi64(off, base, 8));
+		}
+	#endif
+		for (; i+4<=n; i+=4)
+		{
+			const __m256i off = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets + i));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(to + i), _mm256_i64gather_epi64(base, off, 8));
+		}
+		return i;
+	}
+
+	template <typename T, typename U>
+	void gather_offsets(const T* data, const std::ptrdiff_t* offsets, std::ptrdiff_t n, U* out, std::true_type)
+	{
+		const std::ptrdiff_t i = gather_words(data, offsets, n, out, std::integral_constant<size_t, sizeof(U)>{});
+		gather_offsets(data, offsets + i, n - i, out + i, std::false_type{});
+	}
+#endif
+
+#if defined(__AVX512F__)
+	// Lanes of a scatter are stored in order, so repeated offsets keep the last as the scalar loop does
+	inline std::ptrdiff_t scatter_words(void* data, const std::ptrdiff_t* offsets, std::ptrdiff_t n, const void* in, std::integral_constant<size_t, 4>)
+	{
+		const int* from = static_cast<const int*>(in);
+		std::ptrdiff_t i = 0;
+		for (; i+8<=n; i+=8)
+		{
+			const __m512i off = _mm512_loadu_si512(offsets + i);
+			_mm512_i64scatter_epi32(data, off, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(from + i)), 4);
+		}
+		return i;
+	}
+
+	inline std::ptrdiff_t scatter_words(void* data, const std::ptrdiff_t* offsets, std::ptrdiff_t n, const void* in, std::integral_constant<size_t, 8>)
+	{
+		const long long* from = static_cast<const long long*>(in);
+		std::ptrdiff_t i = 0;
+		for (; i+8<=n; i+=8)
+		{
+			const __m512i off = _mm512_loadu_si512(offsets + i);
+			_mm512_i64scatter_epi64(data, off, _mm512_loadu_si512(from + i), 8);
+		}
+		return i;
+	}
+
+	template <typename T, typename U>
+	void scatter_offsets(T* data, const std::ptrdiff_t* offsets, std::ptrdiff_t n, const U* in, std::true_type)
+	{
+		const std::ptrdiff_t i = scatter_words(data, offsets, n, in, std::integral_constant<size_t, sizeof(U)>{});
+		scatter_offsets(data, offsets + i, n - i, in + i, std::false_type{});
+	}
+#endif
+
+} // namespace
+
+// The row-major indices of the non-zero elements of `mask`, in order.  Masks of bytes (such as
+// bool) with contiguous rows are compacted a vector at a time.
+template <typename M, size_t Rank>
+std::vector<std::ptrdiff_t> compact(const strided_array_view<M, Rank>& mask)
+{
+	std::vector<std::ptrdiff_t> indices(mask.size());
+	std::ptrdiff_t* out = indices.data();
+
+	const std::ptrdiff_t n = mask.bounds()[Rank-1];
+	const std::ptrdiff_t stride = mask.stride()[Rank-1];
+	std::ptrdiff_t first = 0;
+
+	for_each_row(mask.bounds(), [&](const offset<Rank>& idx) {
+		const M* row = &view_access(mask.data(), idx, mask.stride());
+		if (stride == 1) {
+			out = compact_row(row, n, first, out);
+		}
+		else {
+			for (std::ptrdiff_t i=0; i<n; ++i) {
+				if (row[i * stride]) *out++ = first + i;
+			}
+		}
+		first += n;
+	});
+
+	indices.resize(out - indices.data());
+	return indices;
+}
+
+template <typename M, size_t Rank>
+std::vector<std::ptrdiff_t> compact(const array_view<M, Rank>& mask)
+{ return compact(strided_array_view<M, Rank>(mask)); }
+
+// A view of a subset of the elements of a base view, as given by a list of their indices.  The
+// list is held by the view, together with the offset of each element from the data of the base,
+// so that the active elements are visited directly.
+template <typename T, size_t Rank = 1>
+class index_array_view
+{
+public:
+	static constexpr size_t rank = Rank;
+	using offset_type            = offset<Rank>;
+	using bounds_type            = av::bounds<Rank>;
+	using size_type              = size_t;
+	using value_type             = T;
+	using pointer                = T*;
+	using reference              = T&;
+
+	index_array_view() noexcept {}
+
+	index_array_view(const strided_array_view<T, Rank>& base, std::vector<std::ptrdiff_t> indices)
+		: base_(base), indices_(std::move(indices)), offsets_(indices_.size())
+	{
+		base_.bounds().delinearize(this->indices(), base_.stride(),
+		                           array_view<std::ptrdiff_t, 1>(offsets_.data(), static_cast<std::ptrdiff_t>(offsets_.size())));
+	}
+
+	// observers
+	strided_array_view<T, Rank> base() const noexcept { return base_; }
+	size_type size() const noexcept { return indices_.size(); }
+
+	array_view<const std::ptrdiff_t, 1> indices() const noexcept
+	{ return array_view<const std::ptrdiff_t, 1>(indices_.data(), static_cast<std::ptrdiff_t>(indices_.size())); }
+
+	array_view<const std::ptrdiff_t, 1> offsets() const noexcept
+	{ return array_view<const std::ptrdiff_t, 1>(offsets_.data(), static_cast<std::ptrdiff_t>(offsets_.size())); }
+
+	// element access
+	reference operator[](size_type n) const
+	{
+		assert(n < size());
+		return base_.data()[offsets_[n]];
+	}
+
+	offset_type index(size_type n) const
+	{
+		assert(n < size());
+		return base_.bounds().delinearize(indices_[n]);
+	}
+
+	// traversal
+	template <typename Fn>
+	void for_each(Fn fn) const
+	{
+		T* data = base_.data();
+		for (std::ptrdiff_t off : offsets_) {
+			fn(data[off]);
+		}
+	}
+
+	template <typename U>
+	void gather(const array_view<U, 1>& out) const
+	{
+		assert(out.size() == size());
+
+		gather_offsets(base_.data(), offsets_.data(), static_cast<std::ptrdiff_t>(offsets_.size()), out.data(), vector_gather<T, U>{});
+	}
+
+	template <typename U>
+	void scatter(const array_view<U, 1>& in) const
+	{
+		assert(in.size() == size());
+
+		scatter_offsets(base_.data(), offsets_.data(), static_cast<std::ptrdiff_t>(offsets_.size()), in.data(), vector_scatter<T, U>{});
+	}
+
+private:
+	strided_array_view<T, Rank> base_;
+	std::vector<std::ptrdiff_t> indices_;
+	std::vector<std::ptrdiff_t> offsets_;
+};
+
+template <typename T, typename M, size_t Rank>
+index_array_view<T, Rank> masked(const strided_array_view<T, Rank>& view, const strided_array_view<M, Rank>& mask)
+{
+	assert(view.bounds() == mask.bounds());
+	return index_array_view<T, Rank>(view, compact(mask));
+}
+
+template <typename T, typename M, size_t Rank>
+index_array_view<T, Rank> masked(const array_view<T, Rank>& view, const array_view<M, Rank>& mask)
+{ return masked(strided_array_view<T, Rank>(view), strided_array_view<M, Rank>(mask)); }
+
+namespace {
+
+	// Of the bounds of `base` but for n in `dim`, where element idx is that of `base` at idx but for
+	// the element at offsets[idx[dim]] along `dim`
+	template <typename T, size_t Rank>
+	T* indirect_row(const strided_array_view<T, Rank>& base, size_t dim, const std::ptrdiff_t* offsets, offset<Rank> idx)
+	{
+		const std::ptrdiff_t along = offsets[idx[dim]];
+		idx[dim] = 0;
+		return &view_access(base.data(), idx, base.stride()) + along;
+	}
+
+	// Rows along `dim` are gathered through the offsets (a vector at a time, for elements of 4 or 8
+	// bytes); rows across it are copied whole from the row of the base at each offset
+	template <typename T, size_t Rank, typename U>
+	void gather_indirect(const strided_array_view<T, Rank>& base, size_t dim, const std::ptrdiff_t* offsets, const strided_array_view<U, Rank>& out)
+	{
+		const std::ptrdiff_t n = out.bounds()[Rank-1];
+		const std::ptrdiff_t from_stride = base.stride()[Rank-1];
+		const std::ptrdiff_t to_stride = out.stride()[Rank-1];
+
+		for_each_row(out.bounds(), [&](const offset<Rank>& idx) {
+			U* to = &view_access(out.data(), idx, out.stride());
+			if (dim == Rank-1)
+			{
+				const T* row = &view_access(base.data(), idx, base.stride());
+				if (to_stride == 1) {
+					gather_offsets(row, offsets, n, to, vector_gather<T, U>{});
+				}
+				else {
+					for (std::ptrdiff_t i=0; i<n; ++i) to[i * to_stride] = row[offsets[i]];
+				}
+			}
+			else
+			{
+				const T* first = indirect_row(base, dim, offsets, idx);
+				if (from_stride == 1 && to_stride == 1) {
+					for (std::ptrdiff_t i=0; i<n; ++i) to[i] = first[i];
+				}
+				else {
+					for (std::ptrdiff_t i=0; i<n; ++i) to[i * to_stride] = first[i * from_stride];
+				}
+			}
+		});
+	}
+
+	// As gather_indirect, from `in` to the elements of `base`, in the order of the bounds of `in`
+	template <typename T, size_t Rank, typename U>
+	void scatter_indirect(const strided_array_view<T, Rank>& base, size_t dim, const std::ptrdiff_t* offsets, const strided_array_view<U, Rank>& in)
+	{
+		const std::ptrdiff_t n = in.bounds()[Rank-1];
+		const std::ptrdiff_t from_stride = in.stride()[Rank-1];
+		const std::ptrdiff_t to_stride = base.stride()[Rank-1];
+
+		for_each_row(in.bounds(), [&](const offset<Rank>& idx) {
+			const U* from = &view_access(in.data(), idx, in.stride());
+			if (dim == Rank-1)
+			{
+				T* row = &view_access(base.data(), idx, base.stride());
+				if (from_stride == 1) {
+					scatter_offsets(row, offsets, n, from, vector_scatter<T, U>{});
+				}
+				else {
+					for (std::ptrdiff_t i=0; i<n; ++i) row[offsets[i]] = from[i * from_stride];
+				}
+			}
+			else
+			{
+				T* first = indirect_row(base, dim, offsets, idx);
+				if (from_stride == 1 && to_stride == 1) {
+					for (std::ptrdiff_t i=0; i<n; ++i) first[i] = from[i];
+				}
+				else {
+					for (std::ptrdiff_t i=0; i<n; ++i) first[i * to_stride] = from[i * from_stride];
+				}
+			}
+		});
+	}
+
+	template <typename T, size_t Rank>
+	void check_indices(const strided_array_view<T, Rank>& base, size_t dim, const std::vector<std::ptrdiff_t>& indices)
+	{
+		assert(dim < Rank);
+		std::ptrdiff_t lo = 0, hi = -1;
+		for (std::ptrdiff_t index : indices)
+		{
+			lo = std::min(lo, index);
+			hi = std::max(hi, index);
+		}
+		assert(lo >= 0 && hi < base.bounds()[dim] && "Index out of the bounds of the base");
+		(void)base; (void)dim; (void)lo; (void)hi;
+	}
+
+	// Calls fn(offsets, first, count) for consecutive batches of the indices, converted to offsets
+	// along `dim` of `base`: by the stride of `dim`, in a buffer of a batch at a time, or else (for a
+	// stride of 1) as they are
+	template <typename T, size_t Rank, typename Fn>
+	void for_each_offset_batch(const strided_array_view<T, Rank>& base, size_t dim, const std::vector<std::ptrdiff_t>& indices, Fn fn)
+	{
+		const std::ptrdiff_t n = static_cast<std::ptrdiff_t>(indices.size());
+		const std::ptrdiff_t stride = base.stride()[dim];
+		if (stride == 1) {
+			fn(indices.data(), std::ptrdiff_t(0), n);
+			return;
+		}
+
+		constexpr std::ptrdiff_t batch = 256;
+		std::ptrdiff_t offsets[batch];
+		for (std::ptrdiff_t first=0; first<n; first+=batch)
+		{
+			const std::ptrdiff_t count = std::min(batch, n - first);
+			for (std::ptrdiff_t i=0; i<count; ++i) offsets[i] = indices[size_t(first + i)] * stride;
+			fn(offsets, first, count);
+		}
+	}
+
+	// Both are called ahead of check_indices (from the member initializers of indirect_array_view),
+	// so check `dim` themselves before writing to it
+	template <size_t Rank>
+	offset<Rank> along(size_t dim, std::ptrdiff_t first)
+	{
+		assert(dim < Rank && "Dimension of indices must be less than the rank");
+		offset<Rank> result;
+		result[dim] = first;
+		return result;
+	}
+
+	template <size_t Rank>
+	bounds<Rank> along(bounds<Rank> b, size_t dim, std::ptrdiff_t count)
+	{
+		assert(dim < Rank && "Dimension of indices must be less than the rank");
+		b[dim] = count;
+		return b;
+	}
+
+} // namespace
+
+// The indices are checked against the base and converted to offsets along `dim` once, when the
+// view is made, so traversal does no more than add them to the offset of each row.  Rows along
+// `dim` are gathered and scattered through the offsets, a vector at a time for elements of 4 or 8
+// bytes; rows across it are copied whole.
+template <typename T, size_t Rank = 1>
+class indirect_array_view
+{
+public:
+	static constexpr size_t rank = Rank;
+	using offset_type            = offset<Rank>;
+	using bounds_type            = av::bounds<Rank>;
+	using size_type              = size_t;
+	using value_type             = T;
+	using pointer                = T*;
+	using reference              = T&;
+
+	indirect_array_view() noexcept {}
+
+	indirect_array_view(const strided_array_view<T, Rank>& base, std::vector<std::ptrdiff_t> indices, size_t dim = 0)
+		: base_(base), bounds_(along(base.bounds(), dim, static_cast<std::ptrdiff_t>(indices.size()))), dim_(dim),
+		  indices_(std::move(indices)), offsets_(indices_.size())
+	{
+		check_indices(base_, dim_, indices_);
+		const std::ptrdiff_t stride = base_.stride()[dim_];
+		for (size_t k=0; k<indices_.size(); ++k) {
+			offsets_[k] = indices_[k] * stride;
+		}
+	}
+
+	// observers
+	strided_array_view<T, Rank> base() const noexcept { return base_; }
+	size_t dim() const noexcept { return dim_; }
+	bounds_type bounds() const noexcept { return bounds_; }
+	size_type size() const noexcept { return bounds_.size(); }
+
+	array_view<const std::ptrdiff_t, 1> indices() const noexcept
+	{ return array_view<const std::ptrdiff_t, 1>(indices_.data(), static_cast<std::ptrdiff_t>(indices_.size())); }
+
+	array_view<const std::ptrdiff_t, 1> offsets() const noexcept
+	{ return array_view<const std::ptrdiff_t, 1>(offsets_.data(), static_cast<std::ptrdiff_t>(offsets_.size())); }
+
+	// element access
+	reference operator[](const offset_type& idx) const
+	{
+		assert(bounds_.contains(idx));
+		return *indirect_row(base_, dim_, offsets_.data(), idx);
+	}
+
+	// traversal
+	template <typename View>
+	void gather(const View& out) const
+	{
+		static_assert(View::rank == Rank, "Rank of the view must match that of the indirect view");
+		assert(out.bounds() == bounds_);
+		gather_indirect(base_, dim_, offsets_.data(), strided_array_view<typename View::value_type, Rank>(out));
+	}
+
+	template <typename View>
+	void scatter(const View& in) const
+	{
+		static_assert(View::rank == Rank, "Rank of the view must match that of the indirect view");
+		assert(in.bounds() == bounds_);
+		scatter_indirect(base_, dim_, offsets_.data(), strided_array_view<typename View::value_type, Rank>(in));
+	}
+
+private:
+	strided_array_view<T, Rank> base_;
+	bounds_type                 bounds_;
+	size_t                      dim_ = 0;
+	std::vector<std::ptrdiff_t> indices_;
+	std::vector<std::ptrdiff_t> offsets_;
+};
+
+template <typename T, size_t Rank>
+indirect_array_view<T, Rank> indirect(const strided_array_view<T, Rank>& view, std::vector<std::ptrdiff_t> indices, size_t dim = 0)
+{ return indirect_array_view<T, Rank>(view, std::move(indices), dim); }
+
+template <typename T, size_t Rank>
+indirect_array_view<T, Rank> indirect(const array_view<T, Rank>& view, std::vector<std::ptrdiff_t> indices, size_t dim = 0)
+{ return indirect(strided_array_view<T, Rank>(view), std::move(indices), dim); }
+
+// Without a view to hold them, the indices are checked once up front and converted to offsets a
+// batch at a time, each batch gathered to (or scattered from) its section of the other view
+template <typename T, size_t Rank, typename View>
+void take(const strided_array_view<T, Rank>& src, const std::vector<std::ptrdiff_t>& indices, size_t dim, const View& dst)
+{
+	static_assert(View::rank == Rank, "Rank of the source and destination views must match");
+	check_indices(src, dim, indices);
+	const strided_array_view<typename View::value_type, Rank> to(dst);
+	assert(to.bounds() == along(src.bounds(), dim, static_cast<std::ptrdiff_t>(indices.size())));
+
+	for_each_offset_batch(src, dim, indices, [&](const std::ptrdiff_t* offsets, std::ptrdiff_t first, std::ptrdiff_t count) {
+		gather_indirect(src, dim, offsets, to.section(along<Rank>(dim, first), along(to.bounds(), dim, count)));
+	});
+}
+
+template <typename T, size_t Rank, typename View>
+void take(const array_view<T, Rank>& src, const std::vector<std::ptrdiff_t>& indices, size_t dim, const View& dst)
+{ take(strided_array_view<T, Rank>(src), indices, dim, dst); }
+
+template <typename T, size_t Rank, typename View>
+void put(const strided_array_view<T, Rank>& dst, const std::vector<std::ptrdiff_t>& indices, size_t dim, const View& src)
+{
+	static_assert(View::rank == Rank, "Rank of the source and destination views must match");
+	check_indices(dst, dim, indices);
+	const strided_array_view<typename View::value_type, Rank> from(src);
+	assert(from.bounds() == along(dst.bounds(), dim, static_cast<std::ptrdiff_t>(indices.size())));
+
+	for_each_offset_batch(dst, dim, indices, [&](const std::ptrdiff_t* offsets, std::ptrdiff_t first, std::ptrdiff_t count) {
+		scatter_indirect(dst, dim, offsets, from.section(along<Rank>(dim, first), along(from.bounds(), dim, count)));
+	});
+}
+
+template <typename T, size_t Rank, typename View>
+void put(const array_view<T, Rank>& dst, const std::vector<std::ptrdiff_t>& indices, size_t dim, const View& src)
+{ put(strided_array_view<T, Rank>(dst), indices, dim, src); }
+
+}
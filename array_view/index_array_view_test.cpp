@@ -0,0 +1,237 @@
+#include "array_view/index_array_view.h"
+
+#include <numeric>
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace av;
+
+TEST(compact_test, ByteMask)
+{
+	// Long enough to use the vector paths, with a tail
+	for (size_t n : {5, 16, 47, 100, 1000})
+	{
+		vector<unsigned char> mask(n);
+		vector<ptrdiff_t> expected;
+		for (size_t i=0; i<n; ++i)
+		{
+			mask[i] = (i % 7 == 0 || i % 11 == 3) ? static_cast<unsigned char>(1 + i % 3) : 0;
+			if (mask[i]) expected.push_back(ptrdiff_t(i));
+		}
+		EXPECT_EQ(expected, compact(array_view<unsigned char, 1>(mask)));
+	}
+}
+
+TEST(compact_test, StridedMask)
+{
+	vector<int> mask(6*10);
+	for (size_t i=0; i<mask.size(); ++i) {
+		mask[i] = i % 3 == 0;
+	}
+
+	// Every other column, so the mask of the section is set on every third element
+	strided_array_view<int, 2> columns(mask.data(), {6,5}, {10,2});
+	vector<ptrdiff_t> indices = compact(columns);
+	ASSERT_EQ(10u, indices.size());
+	for (ptrdiff_t index : indices) {
+		EXPECT_EQ(0, index % 3);
+	}
+}
+
+class IndexArrayViewTest : public ::testing::Test {
+public:
+	IndexArrayViewTest() : vec(8*12), av(vec, {8,12}), mask(8*12)
+	{
+		iota(vec.begin(), vec.end(), 0);
+
+		// A region of interest: a 3x4 rectangle at {2,5}
+		for (auto& idx : av.bounds()) {
+			mask[idx[0] * 12 + idx[1]] = (2 <= idx[0] && idx[0] < 5 && 5 <= idx[1] && idx[1] < 9);
+		}
+	}
+
+protected:
+	vector<int> vec;
+	array_view<int, 2> av;
+	vector<char> mask;
+};
+
+TEST_F(IndexArrayViewTest, Masked)
+{
+	index_array_view<int, 2> roi = masked(av, array_view<char, 2>(mask, {8,12}));
+	ASSERT_EQ(12u, roi.size());
+
+	EXPECT_EQ(29, roi[0]);
+	EXPECT_EQ((offset<2>{2,5}), roi.index(0));
+	EXPECT_EQ((offset<2>{4,8}), roi.index(11));
+	EXPECT_EQ(4*12 + 8, roi[11]);
+
+	int sum = 0;
+	roi.for_each([&](int v) { sum += v; });
+	EXPECT_EQ(3*(29+30+31+32) + 4*(12+24), sum);
+
+	vector<long> gathered(roi.size());
+	roi.gather(array_view<long, 1>(gathered));
+	for (size_t i=0; i<roi.size(); ++i) {
+		EXPECT_EQ(roi[i], gathered[i]);
+	}
+
+	vector<int> zeros(roi.size());
+	roi.scatter(array_view<int, 1>(zeros));
+	EXPECT_EQ(96*95/2 - sum, accumulate(vec.begin(), vec.end(), 0));
+}
+
+TEST_F(IndexArrayViewTest, StridedBase)
+{
+	// Of a transposed view, the indices are into its own bounds
+	strided_array_view<int, 2> transposed(vec.data(), {12,8}, {1,12});
+	index_array_view<int, 2> diagonal(transposed, {0, 9, 18, 27});
+
+	EXPECT_EQ((vector<ptrdiff_t>{0, 13, 26, 39}), vector<ptrdiff_t>(diagonal.offsets().data(), diagonal.offsets().data() + 4));
+	for (size_t i=0; i<diagonal.size(); ++i) {
+		EXPECT_EQ(int(13*i), diagonal[i]);
+		EXPECT_EQ(transposed[diagonal.index(i)], diagonal[i]);
+	}
+}
+
+TEST(IndirectArrayViewTest, Access)
+{
+	vector<int> vec(4*6);
+	iota(vec.begin(), vec.end(), 0);
+	array_view<int, 2> av(vec, {4,6});
+
+	// Columns, in any order and repeated
+	indirect_array_view<int, 2> columns = indirect(av, {5, 0, 5}, 1);
+	EXPECT_EQ((av::bounds<2>{4,3}), columns.bounds());
+	EXPECT_EQ(12u, columns.size());
+	EXPECT_EQ(1u, columns.dim());
+	EXPECT_EQ((vector<ptrdiff_t>{5, 0, 5}), vector<ptrdiff_t>(columns.offsets().data(), columns.offsets().data() + 3));
+	for (const offset<2>& idx : columns.bounds()) {
+		EXPECT_EQ((av[{idx[0], columns.indices()[idx[1]]}]), columns[idx]);
+	}
+
+	// Rows, with the offsets scaled by the stride of the base
+	indirect_array_view<int, 2> rows = indirect(av, {3, 1}, 0);
+	EXPECT_EQ((vector<ptrdiff_t>{18, 6}), vector<ptrdiff_t>(rows.offsets().data(), rows.offsets().data() + 2));
+	EXPECT_EQ(19, (rows[{0,1}]));
+	rows[{1,2}] = -1;
+	EXPECT_EQ(-1, vec[8]);
+
+#ifndef NDEBUG
+	// Along a dimension past the rank
+	EXPECT_DEATH(indirect(av, {0}, 2), "rank");
+#endif
+}
+
+TEST(IndirectArrayViewTest, Take)
+{
+	vector<double> vec(5*7);
+	iota(vec.begin(), vec.end(), 0.);
+	array_view<double, 2> av(vec, {5,7});
+
+	vector<double> rows(3*7);
+	take(av, {4, 0, 4}, 0, array_view<double, 2>(rows, {3,7}));
+	for (ptrdiff_t j=0; j<7; ++j)
+	{
+		EXPECT_EQ(28. + j, rows[j]);
+		EXPECT_EQ(double(j), rows[7 + j]);
+		EXPECT_EQ(28. + j, rows[14 + j]);
+	}
+
+	// Along the innermost dimension, of a transposed base and to a strided destination
+	strided_array_view<double, 2> transposed(vec.data(), {7,5}, {1,7});
+	vector<double> columns(7*2*3);
+	strided_array_view<double, 2> every_other(columns.data(), {7,3}, {6,2});
+	take(transposed, {1, 3, 2}, 1, every_other);
+	for (const offset<2>& idx : every_other.bounds()) {
+		const ptrdiff_t from[] = {1, 3, 2};
+		EXPECT_EQ((transposed[{idx[0], from[idx[1]]}]), every_other[idx]);
+	}
+
+	// Long enough rows for the vector paths, with a tail, for each size of element
+	for (ptrdiff_t n : {3, 8, 21, 100})
+	{
+		vector<ptrdiff_t> indices(n);
+		for (ptrdiff_t i=0; i<n; ++i) indices[i] = (i * 7) % 101;
+
+		vector<float> f(101), fout(n);
+		vector<int64_t> l(101), lout(n);
+		iota(f.begin(), f.end(), 0.f);
+		iota(l.begin(), l.end(), int64_t(1) << 40);
+		take(array_view<const float, 1>(f), indices, 0, array_view<float, 1>(fout));
+		take(array_view<int64_t, 1>(l), indices, 0, array_view<int64_t, 1>(lout));
+		for (ptrdiff_t i=0; i<n; ++i)
+		{
+			EXPECT_EQ(f[indices[i]], fout[i]);
+			EXPECT_EQ(l[indices[i]], lout[i]);
+		}
+	}
+
+	// More indices than a batch of offsets, along a dimension of stride other than 1
+	vector<int> wide(2*1000);
+	iota(wide.begin(), wide.end(), 0);
+	vector<ptrdiff_t> indices(600);
+	for (size_t i=0; i<indices.size(); ++i) indices[i] = ptrdiff_t((i * 13) % 1000);
+	vector<int> picked(600);
+	take(strided_array_view<const int, 1>(wide.data() + 1, {1000}, {2}), indices, 0, array_view<int, 1>(picked));
+	for (size_t i=0; i<indices.size(); ++i) {
+		EXPECT_EQ(int(2*indices[i] + 1), picked[i]);
+	}
+}
+
+TEST(IndirectArrayViewTest, Put)
+{
+	vector<int> vec(4*6);
+	array_view<int, 2> av(vec, {4,6});
+
+	vector<int> ones(2*6, 1);
+	put(av, {2, 0}, 0, array_view<const int, 2>(ones.data(), {2,6}));  // rows
+	EXPECT_EQ(12, accumulate(vec.begin(), vec.end(), 0));
+	EXPECT_EQ(1, (av[{0,5}]));
+	EXPECT_EQ(0, (av[{1,0}]));
+
+	// Of repeated indices, the last is stored
+	vector<int> values{1, 2, 3, 4, 5, 6, 7, 8};
+	put(av, {5, 5}, 1, array_view<int, 2>(values, {4,2}));
+	EXPECT_EQ((vector<int>{2, 4, 6, 8}), (vector<int>{av[{0,5}], av[{1,5}], av[{2,5}], av[{3,5}]}));
+
+	// Long enough rows for the vector paths, with a tail
+	for (ptrdiff_t n : {5, 16, 37})
+	{
+		vector<ptrdiff_t> indices(n);
+		for (ptrdiff_t i=0; i<n; ++i) indices[i] = (i * 5) % 41;
+
+		vector<float> f(41), fin(n);
+		vector<double> d(41), din(n);
+		iota(fin.begin(), fin.end(), 1.f);
+		iota(din.begin(), din.end(), 1.);
+		put(array_view<float, 1>(f), indices, 0, array_view<const float, 1>(fin));
+		put(array_view<double, 1>(d), indices, 0, array_view<double, 1>(din));
+		for (ptrdiff_t i=0; i<n; ++i)
+		{
+			EXPECT_EQ(fin[i], f[indices[i]]);
+			EXPECT_EQ(din[i], d[indices[i]]);
+		}
+	}
+	// Repeated within a vector of indices along the innermost dimension, the last is still stored,
+	// across rows too
+	const vector<ptrdiff_t> repeated{3, 3, 1, 3, 0, 1, 3, 2,  6, 2, 6, 6, 0, 7, 6, 2,  3, 5, 3};
+	const ptrdiff_t rows = 3, cols = 8, n = ptrdiff_t(repeated.size());
+	vector<float> f(size_t(rows * cols)), fin(size_t(rows * n)), fexpected(f.size());
+	vector<double> d(f.size()), din(fin.size()), dexpected(f.size());
+	iota(fin.begin(), fin.end(), 1.f);
+	iota(din.begin(), din.end(), 1.);
+	for (ptrdiff_t r=0; r<rows; ++r) {
+		for (ptrdiff_t i=0; i<n; ++i)
+		{
+			fexpected[size_t(r * cols + repeated[size_t(i)])] = fin[size_t(r * n + i)];
+			dexpected[size_t(r * cols + repeated[size_t(i)])] = din[size_t(r * n + i)];
+		}
+	}
+	put(array_view<float, 2>(f, {rows, cols}), repeated, 1, array_view<const float, 2>(fin.data(), {rows, n}));
+	put(array_view<double, 2>(d, {rows, cols}), repeated, 1, array_view<const double, 2>(din.data(), {rows, n}));
+	EXPECT_EQ(fexpected, f);
+	EXPECT_EQ(dexpected, d);
+}
@@ -0,0 +1,418 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+// Access-pattern instrumentation, enabled by defining AV_INSTRUMENT before including array_view.h.
+// Each element access by `operator[]` of `array_view` or `strided_array_view` is then recorded against
+// its call site (the file and line of the `operator[]` expression) and the view it was made through,
+// where views are identified by their data, bounds and stride.  So two loops over the same view in
+// different orders are told apart.  A report of the counts is written to stderr at exit, or on
+// demand with `report`.
+//
+// Recording is not synchronised: views should be accessed from a single thread while instrumented.
+// Without AV_INSTRUMENT, none of this is included and views are unchanged.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/*
+namespace instrument
+{
+
+struct view_stats
+{
+	static constexpr size_t jump_buckets = 24;
+
+	std::string description;   // of the view
+	const char* file;          // and the call site, of a single site
+	unsigned    line;
+	size_t      accesses;
+	size_t      sequential;    // accesses to the same or an adjacent cache line to the last
+	size_t      backward;      // accesses to a lower address than the last
+	size_t      jumps[jump_buckets];  // by distance from the last access, in log2 elements
+
+	size_t cache_lines() const;
+	double sequential_fraction() const;
+};
+
+// Statistics for the given view so far, of all its call sites together or of each
+template <typename View>
+view_stats stats(const View& view);
+template <typename View>
+std::vector<view_stats> site_stats(const View& view);
+
+// Names the memory spanned by `view`, for any views accessing it in the report
+template <typename View>
+void label(const View& view, const std::string& name);
+
+void report(std::FILE* out = stderr);
+void reset();
+void report_at_exit(bool enable);
+}
+*/
+
+namespace av
+{
+namespace instrument
+{
+
+// The file and line of an element access
+struct site
+{
+	const char* file;
+	unsigned    line;
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+#define AV_INSTRUMENT_FILE __builtin_FILE()
+#define AV_INSTRUMENT_LINE __builtin_LINE()
+#else
+#define AV_INSTRUMENT_FILE "?"
+#define AV_INSTRUMENT_LINE 0
+#endif
+
+// The index to `operator[]` of an instrumented view.  It converts from the forms of offset that
+// `operator[]` takes, and the defaults of its constructors are evaluated where the conversion is made,
+// in the `operator[]` expression, so recording its site.
+template <typename Offset>
+struct located_index
+{
+	Offset index;
+	site   at;
+
+	located_index(const Offset& idx, const char* file = AV_INSTRUMENT_FILE, unsigned line = AV_INSTRUMENT_LINE)
+		: index(idx), at{file, line} {}
+
+	located_index(std::initializer_list<std::ptrdiff_t> il, const char* file = AV_INSTRUMENT_FILE, unsigned line = AV_INSTRUMENT_LINE)
+		: index(il), at{file, line} {}
+
+	template <typename I, typename = std::enable_if_t<Offset::rank == 1 && std::is_integral<I>::value>>
+	located_index(I idx, const char* file = AV_INSTRUMENT_FILE, unsigned line = AV_INSTRUMENT_LINE)
+		: index(static_cast<std::ptrdiff_t>(idx)), at{file, line} {}
+};
+
+struct view_stats
+{
+	static constexpr size_t jump_buckets = 24;
+
+	std::string description;
+	const char* file = "";
+	unsigned    line{};
+	size_t      element_size{};
+	size_t      accesses{};
+	size_t      sequential{};
+	size_t      backward{};
+	size_t      jumps[jump_buckets] = {};
+
+	std::unordered_set<std::uintptr_t> lines;
+	std::uintptr_t last{};
+
+	size_t cache_lines() const { return lines.size(); }
+
+	double sequential_fraction() const
+	{ return accesses > 1 ? double(sequential) / double(accesses - 1) : 1.0; }
+
+	void record(const void* element)
+	{
+		const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(element);
+		const std::uintptr_t line = address / AV_CACHE_LINE_SIZE;
+		lines.insert(line);
+
+		if (accesses++ > 0)
+		{
+			const std::uintptr_t last_line = last / AV_CACHE_LINE_SIZE;
+			if (line == last_line || line == last_line + 1 || line + 1 == last_line) {
+				++sequential;
+			}
+			if (address < last) {
+				++backward;
+			}
+
+			// Bucket 0 is the same element, bucket b > 0 is a jump of [2^(b-1), 2^b) elements
+			std::uintptr_t distance = (address < last ? last - address : address - last) / element_size;
+			size_t bucket = 0;
+			while (distance > 0 && bucket < jump_buckets-1) {
+				distance >>= 1;
+				++bucket;
+			}
+			++jumps[bucket];
+		}
+		last = address;
+	}
+
+	// Adds the counts of another site of the same view
+	void merge(const view_stats& other)
+	{
+		accesses += other.accesses;
+		sequential += other.sequential;
+		backward += other.backward;
+		for (size_t b=0; b<jump_buckets; ++b) jumps[b] += other.jumps[b];
+		lines.insert(other.lines.begin(), other.lines.end());
+	}
+
+	void clear()
+	{
+		accesses = sequential = backward = 0;
+		std::fill(jumps, jumps + jump_buckets, 0);
+		lines.clear();
+		last = 0;
+	}
+};
+
+namespace detail {
+
+	struct labelled_range
+	{
+		std::uintptr_t first, last;
+		std::string name;
+	};
+
+	// The statistics of each call site of a view.  Sites are told apart by the address of their file
+	// name, which may differ between translation units for the same file, so a site in a header can
+	// be listed once for each.
+	struct view_record
+	{
+		std::string description;
+		size_t      element_size;
+		std::map<std::pair<const char*, unsigned>, view_stats> sites;
+
+		view_stats& at(const site& where)
+		{
+			view_stats& stats = sites[std::make_pair(where.file, where.line)];
+			if (stats.accesses == 0)
+			{
+				stats.description = description;
+				stats.file = where.file;
+				stats.line = where.line;
+				stats.element_size = element_size;
+			}
+			return stats;
+		}
+	};
+
+	class registry
+	{
+	public:
+		~registry()
+		{
+			if (report_at_exit_ && !views_.empty()) report(stderr);
+		}
+
+		view_record& find(const std::vector<std::ptrdiff_t>& key, size_t element_size,
+		                  const std::string& description)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			std::unique_ptr<view_record>& record = views_[key];
+			if (!record) {
+				record.reset(new view_record{description, element_size, {}});
+			}
+			return *record;
+		}
+
+		void label(std::uintptr_t first, std::uintptr_t last, const std::string& name)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			labels_.push_back({first, last, name});
+		}
+
+		void report(std::FILE* out)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			std::vector<const view_stats*> sorted;
+			size_t views = 0;
+			for (auto& entry : views_)
+			{
+				bool accessed = false;
+				for (auto& site : entry.second->sites)
+				{
+					if (site.second.accesses == 0) continue;
+					sorted.push_back(&site.second);
+					accessed = true;
+				}
+				views += accessed;
+			}
+			std::sort(sorted.begin(), sorted.end(), [](const view_stats* a, const view_stats* b) {
+				return a->accesses > b->accesses;
+			});
+
+			std::fprintf(out, "array_view access report: %zu call sites over %zu views\n", sorted.size(), views);
+			for (const view_stats* stats : sorted)
+			{
+				std::fprintf(out, "%s:%u: %s%s\n", stats->file, stats->line, label_of(stats->last).c_str(),
+				             stats->description.c_str());
+				std::fprintf(out, "    accesses %zu, cache lines %zu (%.3f per access), "
+				                  "sequential %.1f%%, backward %.1f%%\n",
+				             stats->accesses, stats->cache_lines(),
+				             double(stats->cache_lines()) / double(stats->accesses),
+				             100.0 * stats->sequential_fraction(),
+				             stats->accesses > 1 ? 100.0 * double(stats->backward) / double(stats->accesses - 1) : 0.0);
+
+				std::fprintf(out, "    jumps (elements):");
+				for (size_t b=0; b<view_stats::jump_buckets; ++b)
+				{
+					if (stats->jumps[b] == 0) continue;
+					if (b == 0)
+						std::fprintf(out, " 0: %zu", stats->jumps[b]);
+					else
+						std::fprintf(out, " %zu-%zu: %zu", size_t{1} << (b-1), (size_t{1} << b) - 1, stats->jumps[b]);
+				}
+				std::fprintf(out, "\n");
+			}
+		}
+
+		void reset()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (auto& entry : views_) {
+				entry.second->sites.clear();  // records stay, as views keep pointers to them
+			}
+		}
+
+		void report_at_exit(bool enable) { report_at_exit_ = enable; }
+
+	private:
+		std::string label_of(std::uintptr_t address) const
+		{
+			for (const labelled_range& range : labels_) {
+				if (range.first <= address && address < range.last) return "[" + range.name + "] ";
+			}
+			return {};
+		}
+
+		std::mutex mutex_;
+		std::map<std::vector<std::ptrdiff_t>, std::unique_ptr<view_record>> views_;
+		std::vector<labelled_range> labels_;
+		bool report_at_exit_ = true;
+	};
+
+	inline registry& get_registry()
+	{
+		static registry instance;
+		return instance;
+	}
+
+	template <typename View>
+	std::vector<std::ptrdiff_t> key_of(const View& view)
+	{
+		std::vector<std::ptrdiff_t> key;
+		key.push_back(static_cast<std::ptrdiff_t>(reinterpret_cast<std::uintptr_t>(view.data())));
+		key.push_back(static_cast<std::ptrdiff_t>(sizeof(typename View::value_type)));
+		for (size_t i=0; i<View::rank; ++i) key.push_back(view.bounds()[i]);
+		for (size_t i=0; i<View::rank; ++i) key.push_back(view.stride()[i]);
+		return key;
+	}
+
+	template <typename View>
+	std::string describe(const char* kind, const View& view)
+	{
+		auto list = [](auto values) {
+			std::string s = "{";
+			for (size_t i=0; i<View::rank; ++i) {
+				s += (i ? "," : "") + std::to_string(values[i]);
+			}
+			return s + "}";
+		};
+
+		char address[32];
+		std::snprintf(address, sizeof(address), "%p", static_cast<const void*>(view.data()));
+		return std::string(kind) + "<" + std::to_string(sizeof(typename View::value_type)) + " byte, " +
+		       std::to_string(View::rank) + "> bounds " + list(view.bounds()) +
+		       " stride " + list(view.stride()) + " at " + address;
+	}
+
+	template <typename View>
+	view_record& find(const char* kind, const View& view)
+	{
+		return get_registry().find(key_of(view), sizeof(typename View::value_type), describe(kind, view));
+	}
+
+	// Called on each element access. `record` caches the entry for the view, on first access
+	template <typename View>
+	void record(view_record*& record, const char* kind, const View& view, const site& at, const void* element)
+	{
+		if (!record) record = &find(kind, view);
+		record->at(at).record(element);
+	}
+
+} // namespace detail
+
+// In order of their file and line
+template <typename View>
+std::vector<view_stats> site_stats(const View& view)
+{
+	const detail::view_record& found = detail::find("view", view);
+	std::vector<view_stats> result;
+	for (const auto& site : found.sites) {
+		result.push_back(site.second);
+	}
+	std::sort(result.begin(), result.end(), [](const view_stats& a, const view_stats& b) {
+		const int order = std::strcmp(a.file, b.file);
+		return order != 0 ? order < 0 : a.line < b.line;
+	});
+	return result;
+}
+
+// Of all the sites, where the sequential and backward counts are of each access against the last
+// at its own site
+template <typename View>
+view_stats stats(const View& view)
+{
+	const detail::view_record& found = detail::find("view", view);
+	if (found.sites.empty())
+	{
+		view_stats result;
+		result.description = found.description;
+		result.element_size = found.element_size;
+		return result;
+	}
+
+	auto site = found.sites.begin();
+	view_stats result(site->second);
+	if (found.sites.size() > 1)
+	{
+		result.file = "";
+		result.line = 0;
+		for (++site; site != found.sites.end(); ++site) result.merge(site->second);
+	}
+	return result;
+}
+
+template <typename View>
+void label(const View& view, const std::string& name)
+{
+	// The span of memory between the first and last elements of the view, for positive strides
+	std::ptrdiff_t extent = 0;
+	for (size_t i=0; i<View::rank; ++i) {
+		extent += (view.bounds()[i] - 1) * view.stride()[i];
+	}
+	const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(view.data());
+	const std::uintptr_t last = first + (extent + 1) * sizeof(typename View::value_type);
+	detail::get_registry().label(first, last, name);
+}
+
+inline void report(std::FILE* out = stderr) { detail::get_registry().report(out); }
+inline void reset()                         { detail::get_registry().reset(); }
+inline void report_at_exit(bool enable)     { detail::get_registry().report_at_exit(enable); }
+
+} // namespace instrument
+} // namespace av
@@ -0,0 +1,118 @@
+#include "array_view/array_view.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace av;
+
+class InstrumentTest : public ::testing::Test {
+public:
+	InstrumentTest() : vec(64*64), av(vec, {64,64})
+	{
+		instrument::report_at_exit(false);
+		instrument::reset();
+	}
+
+protected:
+	// The number of cache lines spanned by vec, which need not be aligned to them
+	size_t lines_spanned() const
+	{
+		uintptr_t first = reinterpret_cast<uintptr_t>(vec.data());
+		uintptr_t last = reinterpret_cast<uintptr_t>(vec.data() + vec.size()) - 1;
+		return last / AV_CACHE_LINE_SIZE - first / AV_CACHE_LINE_SIZE + 1;
+	}
+
+	vector<float> vec;
+	array_view<float, 2> av;
+};
+
+TEST_F(InstrumentTest, RowMajor)
+{
+	for (auto& idx : av.bounds()) {
+		av[idx] = 1.f;
+	}
+
+	instrument::view_stats stats = instrument::stats(av);
+	EXPECT_EQ(64u*64u, stats.accesses);
+	EXPECT_EQ(lines_spanned(), stats.cache_lines());
+	EXPECT_EQ(1.0, stats.sequential_fraction());
+	EXPECT_EQ(0u, stats.backward);
+	EXPECT_EQ(64u*64u - 1, stats.jumps[1]);  // each a jump of one element
+}
+
+TEST_F(InstrumentTest, ColumnMajor)
+{
+	strided_array_view<float, 2> transposed(vec.data(), {64,64}, {1,64});
+	for (auto& idx : transposed.bounds()) {
+		transposed[idx] = 1.f;
+	}
+
+	instrument::view_stats stats = instrument::stats(transposed);
+	EXPECT_EQ(64u*64u, stats.accesses);
+	EXPECT_EQ(lines_spanned(), stats.cache_lines());
+	EXPECT_LT(stats.sequential_fraction(), 0.05);
+	EXPECT_EQ(63u*64u, stats.jumps[7]);  // jumps of 64 elements, forwards within a column
+	EXPECT_EQ(63u, stats.backward);      // and back again between columns
+
+	// Views are tracked separately, but all copies of the same view together
+	EXPECT_EQ(0u, instrument::stats(av).accesses);
+	strided_array_view<float, 2> copied(transposed);
+	copied[{0,0}] = 2.f;
+	EXPECT_EQ(64u*64u + 1, instrument::stats(transposed).accesses);
+}
+
+TEST_F(InstrumentTest, Report)
+{
+	instrument::label(av, "density");
+	av[{1,2}] = 1.f;
+	av[5][3] = 1.f;  // through a slice
+
+	char buffer[4096] = {};
+	FILE* out = fmemopen(buffer, sizeof(buffer), "w");
+	instrument::report(out);
+	fclose(out);
+
+	string report(buffer);
+	EXPECT_NE(string::npos, report.find("2 call sites over 2 views"));
+	EXPECT_NE(string::npos, report.find("instrument_test.cpp:"));
+	EXPECT_NE(string::npos, report.find("[density] array_view<4 byte, 2> bounds {64,64} stride {64,1}"));
+	EXPECT_NE(string::npos, report.find("[density] array_view<4 byte, 1> bounds {64} stride {1}"));
+}
+
+TEST_F(InstrumentTest, CallSites)
+{
+	// The same view, written by rows and then read by columns
+	for (auto& idx : av.bounds()) {
+		av[idx] = 1.f;
+	}
+	float sum = 0.f;
+	for (ptrdiff_t j=0; j<64; ++j) {
+		for (ptrdiff_t i=0; i<64; ++i) sum += av[{i, j}];
+	}
+	EXPECT_EQ(64.f*64.f, sum);
+
+	vector<instrument::view_stats> sites = instrument::site_stats(av);
+	ASSERT_EQ(2u, sites.size());
+	EXPECT_LT(sites[0].line, sites[1].line);
+	EXPECT_NE(nullptr, strstr(sites[0].file, "instrument_test.cpp"));
+	EXPECT_EQ(64u*64u, sites[0].accesses);
+	EXPECT_EQ(1.0, sites[0].sequential_fraction());
+	EXPECT_EQ(64u*64u, sites[1].accesses);
+	EXPECT_LT(sites[1].sequential_fraction(), 0.05);
+
+	// and together
+	instrument::view_stats all = instrument::stats(av);
+	EXPECT_EQ(2u*64u*64u, all.accesses);
+	EXPECT_EQ(lines_spanned(), all.cache_lines());
+
+	// Nothing is carried over from before a reset
+	instrument::reset();
+	av[{0,0}] = 2.f;
+	EXPECT_EQ(1u, instrument::stats(av).accesses);
+	EXPECT_EQ(0u, instrument::stats(av).sequential);
+}
@@ -0,0 +1,407 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+#include "array_view.h"
+#include "pages.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+/*
+// The header of a file written by `write`, followed by the elements in row-major order from
+// `data_offset`, which is a multiple of 64 bytes
+struct file_header
+{
+	char          magic[8];       // "AVIEW01"
+	std::uint32_t byte_order;     // 0x01020304, as written
+	char          kind;           // 'b' bool, 'i' signed, 'u' unsigned, 'f' floating point, 'V' other
+	std::uint32_t element_size;
+	std::uint32_t rank;
+	std::int64_t  bounds[max_file_rank];
+	std::uint64_t data_offset;
+
+	bool valid() const;
+};
+
+// Writes `view` to a file descriptor, or to a new file at `path`, returning false on failure
+template <typename View>
+bool write(int fd, const View& view);
+template <typename View>
+bool write(const std::string& path, const View& view);
+
+// Reads the header of the file at `path`, returning false if there is none
+bool read_header(const std::string& path, file_header& header);
+
+// A read-only mapping of a file written by `write`
+template <typename T, size_t Rank = 1>
+class mapped_array
+{
+public:
+	mapped_array() noexcept;
+	// Check is_open() for success.  Files cannot be in hugetlbfs pages, so either of the huge page
+	// hints advises the kernel of transparent huge pages, where it supports them for files.
+	explicit mapped_array(const std::string& path, page_size_hint pages = page_size_hint::normal);
+	mapped_array(mapped_array&& rhs) noexcept;
+	mapped_array& operator=(mapped_array&& rhs) noexcept;
+	~mapped_array();
+
+	bool is_open() const noexcept;
+	array_view<const T, Rank> view() const noexcept;
+	bounds<Rank> bounds() const noexcept;
+	size_t huge_page_bytes() const;  // of the mapping, resident in huge pages
+};
+*/
+
+namespace av
+{
+
+constexpr size_t max_file_rank = 12;
+
+struct file_header
+{
+	char          magic[8] = {'A','V','I','E','W','0','1','\0'};
+	std::uint32_t byte_order = 0x01020304;
+	char          kind = 'V';
+	char          reserved[3] = {};
+	std::uint32_t element_size = 0;
+	std::uint32_t rank = 0;
+	std::int64_t  bounds[max_file_rank] = {};
+	std::uint64_t data_offset = 128;
+
+	bool valid() const
+	{
+		return std::memcmp(magic, file_header{}.magic, sizeof(magic)) == 0 &&
+		       byte_order == file_header{}.byte_order &&
+		       rank <= max_file_rank && data_offset >= sizeof(file_header);
+	}
+};
+
+static_assert(sizeof(file_header) <= 128, "The data of a file must start at its first 64 byte boundary after the header");
+
+namespace {
+
+	template <typename T>
+	constexpr char kind_of()
+	{
+		return std::is_same<T, bool>::value    ? 'b' :
+		       std::is_floating_point<T>::value ? 'f' :
+		       std::is_integral<T>::value       ? (std::is_signed<T>::value ? 'i' : 'u') : 'V';
+	}
+
+	template <typename T, size_t Rank>
+	file_header header_of(const bounds<Rank>& b)
+	{
+		static_assert(Rank <= max_file_rank, "Rank exceeds that of the file format");
+
+		file_header header;
+		header.kind = kind_of<T>();
+		header.element_size = sizeof(T);
+		header.rank = Rank;
+		for (size_t i=0; i<Rank; ++i) header.bounds[i] = b[i];
+		return header;
+	}
+
+	// Writes runs of bytes with as few calls to writev as possible, of up to IOV_MAX runs each.  Runs
+	// that are adjacent in memory are merged as they are added, so the rows of a contiguous view
+	// become one run.  Runs of at least `direct_run` bytes are then written from where they are;
+	// shorter runs are copied into a bounce buffer first, as an iovec per run would cost more than
+	// the copy.
+	class gather_writer
+	{
+	public:
+		static constexpr size_t direct_run  = 4096;
+		static constexpr size_t bounce_size = size_t{1} << 18;
+
+		explicit gather_writer(int fd) : fd_(fd), bounce_(bounce_size) {}
+
+		void add(const void* data, size_t n)
+		{
+			if (n == 0) return;
+
+			const char* from = static_cast<const char*>(data);
+			if (pending_ && pending_ + pending_size_ == from) {
+				pending_size_ += n;
+				return;
+			}
+			place_pending();
+			pending_ = from;
+			pending_size_ = n;
+		}
+
+		// Copies `n` elements, `stride` elements apart, via the bounce buffer, prefetching ahead as
+		// for `copy`
+		template <typename T>
+		void add_strided(const T* data, std::ptrdiff_t n, std::ptrdiff_t stride)
+		{
+			place_pending();
+			const std::ptrdiff_t ahead = prefetch_ahead<T>(automatic_prefetch, stride);
+			while (n > 0)
+			{
+				if (iov_.size() >= IOV_MAX || bounce_.size() - bounce_used_ < sizeof(T)) write_iovecs();
+
+				const std::ptrdiff_t count = std::min(n, static_cast<std::ptrdiff_t>((bounce_.size() - bounce_used_) / sizeof(T)));
+				char* to = bounce_.data() + bounce_used_;
+				walk_row(count, data, stride, ahead, [&](std::ptrdiff_t i) {
+					std::memcpy(to + i * sizeof(T), data + i * stride, sizeof(T));
+				});
+				bounce_used_ += count * sizeof(T);
+				push(to, count * sizeof(T));
+				data += count * stride;
+				n -= count;
+			}
+		}
+
+		// Returns false if any write has failed
+		bool flush()
+		{
+			place_pending();
+			write_iovecs();
+			return ok_;
+		}
+
+	private:
+		// Writes the pending run from where it is, or from a copy
+		void place_pending()
+		{
+			if (!pending_) return;
+			const char* data = pending_;
+			const size_t n = pending_size_;
+			pending_ = nullptr;
+			pending_size_ = 0;
+
+			if (iov_.size() >= IOV_MAX) write_iovecs();
+			if (n >= direct_run) {
+				push(data, n);
+				return;
+			}
+
+			if (bounce_used_ + n > bounce_.size()) write_iovecs();
+			char* to = bounce_.data() + bounce_used_;
+			std::memcpy(to, data, n);
+			bounce_used_ += n;
+			push(to, n);
+		}
+
+		// A return of 0 for a non-empty write would otherwise be retried for ever
+		void write_iovecs()
+		{
+			size_t first = 0;
+			while (ok_ && first < iov_.size())
+			{
+				const int count = static_cast<int>(std::min<size_t>(iov_.size() - first, IOV_MAX));
+				const ssize_t written = ::writev(fd_, &iov_[first], count);
+				if (written < 0) {
+					if (errno != EINTR) ok_ = false;
+					continue;
+				}
+				if (written == 0) {
+					ok_ = false;
+					continue;
+				}
+
+				// Skip the iovecs written in full, and the written part of any partially written
+				size_t remaining = static_cast<size_t>(written);
+				while (remaining > 0 && remaining >= iov_[first].iov_len) {
+					remaining -= iov_[first++].iov_len;
+				}
+				if (remaining > 0) {
+					iov_[first].iov_base = static_cast<char*>(iov_[first].iov_base) + remaining;
+					iov_[first].iov_len -= remaining;
+				}
+			}
+
+			iov_.clear();
+			bounce_used_ = 0;
+		}
+
+		void push(const char* data, size_t n)
+		{
+			if (!iov_.empty())
+			{
+				iovec& last = iov_.back();
+				if (static_cast<char*>(last.iov_base) + last.iov_len == data) {
+					last.iov_len += n;
+					return;
+				}
+			}
+			iov_.push_back({const_cast<char*>(data), n});
+		}
+
+		int fd_;
+		bool ok_ = true;
+		std::vector<iovec> iov_;
+		std::vector<char> bounce_;
+		size_t bounce_used_ = 0;
+		const char* pending_ = nullptr;  // the last run added, until it is known whether the next extends it
+		size_t pending_size_ = 0;
+	};
+
+} // namespace
+
+// Writes a header describing the element type and bounds of `view`, followed by its elements in
+// row-major order.  The elements are written directly from the view, in runs of its rows (or of
+// larger contiguous blocks, where rows are adjacent), so a contiguous view is written with a
+// single call.  Only rows with a non-unit stride, and runs of rows too short to be worth an iovec of
+// their own, are copied, to be written in blocks.
+template <typename View>
+bool write(int fd, const View& view)
+{
+	constexpr size_t Rank = View::rank;
+	using T = std::remove_const_t<typename View::value_type>;
+	static_assert(std::is_trivially_copyable<T>::value, "Elements must be trivially copyable to be written");
+
+	const strided_array_view<const T, Rank> sav(view);
+	const file_header header = header_of<T>(sav.bounds());
+	const char padding[128] = {};
+
+	gather_writer writer(fd);
+	writer.add(&header, sizeof(header));
+	writer.add(padding, header.data_offset - sizeof(header));
+
+	const std::ptrdiff_t n = sav.bounds()[Rank-1];
+	const std::ptrdiff_t stride = sav.stride()[Rank-1];
+	for_each_row(sav.bounds(), [&](const offset<Rank>& idx) {
+		const T* row = &view_access(sav.data(), idx, sav.stride());
+		if (stride == 1 || n == 1) {
+			writer.add(row, n * sizeof(T));
+		}
+		else {
+			writer.add_strided(row, n, stride);
+		}
+	});
+
+	return writer.flush();
+}
+
+template <typename View>
+bool write(const std::string& path, const View& view)
+{
+	const int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (fd < 0) return false;
+
+	const bool written = write(fd, view);
+	return (::close(fd) == 0) && written;
+}
+
+inline bool read_header(const std::string& path, file_header& header)
+{
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+
+	const bool read = ::pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+	::close(fd);
+	return read && header.valid();
+}
+
+// Maps a file written by `write` into memory, where its elements are viewed in place.  The file
+// must hold elements of the same kind and size as T, of rank Rank.
+template <typename T, size_t Rank = 1>
+class mapped_array
+{
+public:
+	mapped_array() noexcept {}
+
+	explicit mapped_array(const std::string& path, page_size_hint pages = page_size_hint::normal)
+	{
+		const int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) return;
+
+		file_header header;
+		struct stat status;
+		const bool valid = ::pread(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+		                   header.valid() && ::fstat(fd, &status) == 0 &&
+		                   header.kind == kind_of<T>() && header.element_size == sizeof(T) && header.rank == Rank;
+
+		if (valid && fits(header, static_cast<std::uint64_t>(status.st_size)))
+		{
+			for (size_t i=0; i<Rank; ++i) bounds_[i] = static_cast<std::ptrdiff_t>(header.bounds[i]);
+			length_ = static_cast<size_t>(status.st_size);
+
+			void* mapping = ::mmap(nullptr, length_, PROT_READ, MAP_SHARED, fd, 0);
+			if (mapping != MAP_FAILED) {
+				if (pages != page_size_hint::normal) advise_huge_pages(mapping, length_);
+				mapping_ = mapping;
+				data_ = reinterpret_cast<const T*>(static_cast<const char*>(mapping) + header.data_offset);
+			}
+		}
+		::close(fd);
+	}
+
+	mapped_array(const mapped_array&) = delete;
+	mapped_array& operator=(const mapped_array&) = delete;
+
+	mapped_array(mapped_array&& rhs) noexcept { swap(rhs); }
+	mapped_array& operator=(mapped_array&& rhs) noexcept { swap(rhs); return *this; }
+
+	~mapped_array()
+	{
+		if (mapping_) ::munmap(mapping_, length_);
+	}
+
+	bool is_open() const noexcept { return mapping_ != nullptr; }
+
+	array_view<const T, Rank> view() const noexcept { return array_view<const T, Rank>(data_, bounds_); }
+	av::bounds<Rank> bounds() const noexcept { return bounds_; }
+	size_t huge_page_bytes() const { return mapping_ ? av::huge_page_bytes(mapping_, length_) : 0; }
+
+private:
+	// Whether the elements of the header lie within a file of `length` bytes.  The header is read
+	// from the file, so its extents may be negative, or have a product that overflows (even where
+	// another is zero, as bounds::size multiplies them all).
+	static bool fits(const file_header& header, std::uint64_t length)
+	{
+		if (header.data_offset > length || header.data_offset % alignof(T) != 0) return false;
+
+		const std::uint64_t limit = static_cast<std::uint64_t>(PTRDIFF_MAX) / sizeof(T);
+		std::uint64_t elements = 1;
+		bool empty = false;
+		for (size_t i=0; i<Rank; ++i)
+		{
+			if (header.bounds[i] < 0) return false;
+			const std::uint64_t extent = static_cast<std::uint64_t>(header.bounds[i]);
+			if (extent == 0) {
+				empty = true;
+			}
+			else
+			{
+				if (elements > limit / extent) return false;
+				elements *= extent;
+			}
+		}
+		return empty || elements * sizeof(T) <= length - header.data_offset;
+	}
+
+	void swap(mapped_array& rhs) noexcept
+	{
+		std::swap(mapping_, rhs.mapping_);
+		std::swap(length_, rhs.length_);
+		std::swap(data_, rhs.data_);
+		std::swap(bounds_, rhs.bounds_);
+	}
+
+	void* mapping_ = nullptr;
+	size_t length_ = 0;
+	const T* data_ = nullptr;
+	av::bounds<Rank> bounds_;
+};
+
+}
@@ -0,0 +1,211 @@
+#include "array_view/io.h"
+
+#include <cstdio>
+#include <numeric>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#endif
+
+using namespace std;
+using namespace av;
+
+#if defined(__linux__)
+
+namespace {
+
+	// The calls to writev while a test watches them: the runs of each call
+	struct writev_calls
+	{
+		vector<vector<pair<const char*, size_t>>> runs;
+		bool write_nothing = false;  // returns 0, as a device with no room can
+	};
+	writev_calls* watched_writev = nullptr;
+
+} // namespace
+
+// Takes the place of the C library's, for the calls of this program
+extern "C" ssize_t writev(int fd, const struct iovec* iov, int count)
+{
+	if (watched_writev)
+	{
+		vector<pair<const char*, size_t>> runs;
+		for (int i=0; i<count; ++i) runs.emplace_back(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+		watched_writev->runs.push_back(runs);
+		if (watched_writev->write_nothing) return 0;
+	}
+	return ::syscall(SYS_writev, fd, iov, count);
+}
+
+#endif
+
+namespace {
+
+	string temp_path(const char* name)
+	{
+		return testing::TempDir() + "av_io_test_" + name;
+	}
+
+	template <typename T, size_t Rank, typename View>
+	void expect_equal(const View& expected, const array_view<const T, Rank>& actual)
+	{
+		ASSERT_EQ(expected.bounds(), actual.bounds());
+		for (const offset<Rank>& idx : expected.bounds()) {
+			EXPECT_EQ(expected[idx], actual[idx]);
+		}
+	}
+
+} // namespace
+
+TEST(io_test, Contiguous)
+{
+	const bounds<3> b = {4, 5, 6};
+	vector<double> vec(b.size());
+	iota(vec.begin(), vec.end(), 0.0);
+	const array_view<double, 3> av(vec, b);
+
+	const string path = temp_path("contiguous");
+	ASSERT_TRUE(av::write(path, av));
+
+	file_header header;
+	ASSERT_TRUE(read_header(path, header));
+	EXPECT_EQ('f', header.kind);
+	EXPECT_EQ(sizeof(double), header.element_size);
+	EXPECT_EQ(3u, header.rank);
+	EXPECT_EQ(5, header.bounds[1]);
+	EXPECT_EQ(0u, header.data_offset % 64);
+
+	mapped_array<double, 3> mapped(path);
+	ASSERT_TRUE(mapped.is_open());
+	EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(mapped.view().data()) % 64);
+	expect_equal(av, mapped.view());
+
+	// Only an array of the same element type and rank may be mapped
+	EXPECT_FALSE((mapped_array<float, 3>(path).is_open()));
+	EXPECT_FALSE((mapped_array<int64_t, 3>(path).is_open()));
+	EXPECT_FALSE((mapped_array<double, 2>(path).is_open()));
+	EXPECT_FALSE((mapped_array<double, 3>(temp_path("missing")).is_open()));
+
+	remove(path.c_str());
+}
+
+TEST(io_test, Strided)
+{
+	// Rows long enough to be written in place, rows that go via the bounce buffer, and columns
+	const bounds<2> b = {64, 2048};
+	vector<int> vec(b.size());
+	iota(vec.begin(), vec.end(), 0);
+	const array_view<int, 2> av(vec, b);
+
+	const string path = temp_path("strided");
+
+	auto every_other_row = strided_array_view<int, 2>(vec.data(), {32, 2048}, {4096, 1});
+	ASSERT_TRUE(av::write(path, every_other_row));
+	expect_equal(every_other_row, mapped_array<int, 2>(path).view());
+
+	auto short_rows = av.section({3, 5}, {50, 7});
+	ASSERT_TRUE(av::write(path, short_rows));
+	expect_equal(short_rows, mapped_array<int, 2>(path).view());
+
+	auto columns = strided_array_view<int, 2>(vec.data(), {2048, 64}, {1, 2048});
+	ASSERT_TRUE(av::write(path, columns));
+	expect_equal(columns, mapped_array<int, 2>(path).view());
+
+	remove(path.c_str());
+}
+
+#if defined(__linux__)
+TEST(io_test, WritevPattern)
+{
+	// A contiguous view of short rows is one run, written from the view itself
+	const bounds<2> b = {2000, 100};
+	vector<float> vec(b.size());
+	iota(vec.begin(), vec.end(), 0.f);
+	const string path = temp_path("writev");
+
+	writev_calls calls;
+	watched_writev = &calls;
+	const bool written = av::write(path, array_view<const float, 2>(vec, b));
+	watched_writev = nullptr;
+	ASSERT_TRUE(written);
+	expect_equal(array_view<const float, 2>(vec, b), mapped_array<float, 2>(path).view());
+
+	ASSERT_EQ(1u, calls.runs.size());
+	ASSERT_EQ(2u, calls.runs[0].size());  // the header, and the elements
+	EXPECT_EQ(reinterpret_cast<const char*>(vec.data()), calls.runs[0][1].first);
+	EXPECT_EQ(vec.size() * sizeof(float), calls.runs[0][1].second);
+
+	// Of a section, the short rows are copied, into as few runs as the bounce buffer takes
+	calls = writev_calls{};
+	watched_writev = &calls;
+	const array_view<const float, 2> whole(vec, b);
+	ASSERT_TRUE(av::write(path, whole.section({0, 0}, {1000, 50})));
+	watched_writev = nullptr;
+	ASSERT_EQ(1u, calls.runs.size());
+	EXPECT_EQ(1u, calls.runs[0].size());
+
+	// A write that writes nothing fails, rather than being retried for ever
+	calls = writev_calls{};
+	calls.write_nothing = true;
+	watched_writev = &calls;
+	EXPECT_FALSE(av::write(path, whole));
+	watched_writev = nullptr;
+	EXPECT_EQ(1u, calls.runs.size());
+
+	remove(path.c_str());
+}
+#endif
+
+TEST(io_test, BadHeader)
+{
+	vector<float> vec(6 * 4);
+	const string path = temp_path("bad_header");
+
+	// Extents that are negative, or whose product overflows (with or without a zero among them),
+	// are not mapped, as they would give a view past the end of the file
+	const std::int64_t big = std::int64_t{1} << 40;
+	const std::int64_t extents[][3] = {{-6, -4, 1}, {big, big, 1}, {big, big, 0}, {6, 4, 2}};
+	for (const auto& extent : extents)
+	{
+		ASSERT_TRUE(av::write(path, array_view<const float, 3>(vec.data(), {6, 4, 1})));
+		file_header header;
+		ASSERT_TRUE(read_header(path, header));
+		copy(begin(extent), end(extent), header.bounds);
+
+		const int fd = ::open(path.c_str(), O_WRONLY);
+		ASSERT_GE(fd, 0);
+		ASSERT_EQ(static_cast<ssize_t>(sizeof(header)), ::pwrite(fd, &header, sizeof(header), 0));
+		::close(fd);
+
+		EXPECT_FALSE((mapped_array<float, 3>(path).is_open())) << extent[0] << "," << extent[1] << "," << extent[2];
+	}
+
+	remove(path.c_str());
+}
+
+TEST(io_test, Empty)
+{
+	const string path = temp_path("empty");
+	ASSERT_TRUE(av::write(path, array_view<const float, 2>(nullptr, {0, 4})));
+
+	mapped_array<float, 2> mapped(path);
+	ASSERT_TRUE(mapped.is_open());
+	EXPECT_EQ(0u, mapped.view().size());
+
+	// Moving transfers the mapping
+	mapped_array<float, 2> moved(std::move(mapped));
+	EXPECT_TRUE(moved.is_open());
+	EXPECT_FALSE(mapped.is_open());
+
+	remove(path.c_str());
+}
+
+TEST(io_test, BadDescriptor)
+{
+	vector<int> vec(16);
+	EXPECT_FALSE(av::write(-1, array_view<int, 1>(vec)));
+	EXPECT_FALSE(av::write(string("/nonexistent/directory/file"), array_view<int, 1>(vec)));
+}
@@ -0,0 +1,368 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+#include "array_view.h"
+
+#include <cstdint>
+#include <iterator>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+/*
+// An iterator over the indices of a bounds, in Morton (Z-order) order
+template <size_t Rank>
+class morton_iterator
+{
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type        = offset<Rank>;
+	using difference_type   = ptrdiff_t;
+	using pointer           = const offset<Rank>*;
+	using reference         = const offset<Rank>&;
+
+	morton_iterator& operator++();
+	morton_iterator  operator++(int);
+
+	reference operator*() const;
+	pointer   operator->() const;
+
+	std::uint64_t code() const;
+};
+
+template <size_t Rank>
+class morton_order
+{
+public:
+	explicit morton_order(const bounds<Rank>& b);
+
+	morton_iterator<Rank> begin() const;
+	morton_iterator<Rank> end() const;
+
+	// Calls fn(idx) for each index in the same order, faster than by the iterators
+	template <typename Fn> void for_each(Fn fn) const;
+
+	std::uint64_t encode(const offset<Rank>& idx) const;
+	offset<Rank>  decode(std::uint64_t code) const;
+};
+*/
+
+namespace av
+{
+
+namespace {
+
+	inline unsigned count_trailing_ones(std::uint64_t value)
+	{
+	#if defined(__GNUC__)
+		return ~value ? static_cast<unsigned>(__builtin_ctzll(~value)) : 64u;
+	#else
+		unsigned n = 0;
+		while (value & 1u) { value >>= 1; ++n; }
+		return n;
+	#endif
+	}
+
+	// Deposits the low bits of `value` at the set bits of `mask`
+	inline std::uint64_t deposit_bits(std::uint64_t value, std::uint64_t mask)
+	{
+	#if defined(__BMI2__)
+		return _pdep_u64(value, mask);
+	#else
+		std::uint64_t result = 0;
+		for (std::uint64_t bit = 1; mask; bit <<= 1, mask &= mask - 1) {
+			if (value & bit) result |= mask & -mask;
+		}
+		return result;
+	#endif
+	}
+
+	// Extracts the bits of `value` at the set bits of `mask`, to the low bits of the result
+	inline std::uint64_t extract_bits(std::uint64_t value, std::uint64_t mask)
+	{
+	#if defined(__BMI2__)
+		return _pext_u64(value, mask);
+	#else
+		std::uint64_t result = 0;
+		for (std::uint64_t bit = 1; mask; bit <<= 1, mask &= mask - 1) {
+			if (value & mask & -mask) result |= bit;
+		}
+		return result;
+	#endif
+	}
+
+} // namespace
+
+template <size_t Rank> class morton_iterator;
+
+// The indices of a bounds, in Morton order.  The bits of each dimension are interleaved from the
+// least significant, with the least significant dimension first, until a dimension's extent is
+// covered, after which the remaining dimensions continue to interleave.  So any extents are
+// supported, and the space of codes exceeds the bounds by less than a factor of 2 per dimension.
+template <size_t Rank>
+class morton_order
+{
+public:
+	explicit morton_order(const bounds<Rank>& b) : bounds_(b)
+	{
+		size_t bits[Rank] = {};
+		size_t max_bits = 0;
+		for (size_t dim=0; dim<Rank; ++dim)
+		{
+			while ((std::ptrdiff_t{1} << bits[dim]) < b[dim]) ++bits[dim];
+			max_bits = std::max(max_bits, bits[dim]);
+		}
+
+		size_t next = 0;
+		for (size_t level=0; level<max_bits; ++level) {
+			for (int dim=(Rank-1); dim>=0; --dim) {
+				if (level < bits[dim])
+				{
+					assert(next < 63);  // the codes must fit in 64 bits
+					masks_[dim] |= std::uint64_t{1} << next;
+
+					// Carrying into this bit adds its weight, and clears the bits below it
+					offset<Rank>& delta = carry_delta_[next];
+					delta[size_t(dim)] += std::ptrdiff_t{1} << level;
+					for (size_t lower=0; lower<next; ++lower) delta[size_t(code_dim(lower))] -= weight(lower);
+					++next;
+				}
+			}
+		}
+
+		code_bits_ = static_cast<unsigned>(next);
+		end_code_ = b.size() == 0 ? 0 : std::uint64_t{1} << next;
+
+		offset<Rank> last;
+		for (size_t dim=0; dim<Rank; ++dim) last[dim] = b[dim] - 1;
+		max_code_ = b.size() == 0 ? 0 : encode(last);
+
+		leaf_bits_ = code_bits_ < max_leaf_bits ? code_bits_ : unsigned{max_leaf_bits};
+		for (std::uint64_t code=0; code < (std::uint64_t{1} << leaf_bits_); ++code) {
+			leaf_[code] = decode(code);
+		}
+		leaf_last_ = leaf_[(std::uint64_t{1} << leaf_bits_) - 1];
+	}
+
+	morton_iterator<Rank> begin() const;
+	morton_iterator<Rank> end() const;
+
+	// The codes are taken a leaf at a time, a block of the low bits whose indices are a fixed pattern
+	// about its first, so that a leaf within the bounds is visited from a table without tests.  Leaves
+	// outside of the bounds are jumped over as by the iterators.
+	template <typename Fn>
+	void for_each(Fn fn) const
+	{
+		const std::ptrdiff_t leaf_size = std::ptrdiff_t{1} << leaf_bits_;
+		const std::uint64_t leaves = end_code_ >> leaf_bits_;
+
+		std::uint64_t leaf = 0;
+		offset<Rank> first;
+		while (leaf < leaves)
+		{
+			if (within(first + leaf_last_))
+			{
+				for (std::ptrdiff_t i=0; i<leaf_size; ++i) fn(first + leaf_[i]);
+			}
+			else if (within(first))
+			{
+				for (std::ptrdiff_t i=0; i<leaf_size; ++i)
+				{
+					const offset<Rank> idx = first + leaf_[i];
+					if (within(idx)) fn(idx);
+				}
+			}
+			else
+			{
+				// Its first index is the least of the leaf in each dimension, so none are within
+				leaf = next_within(leaf << leaf_bits_) >> leaf_bits_;
+				if (leaf < leaves) first = decode(leaf << leaf_bits_);
+				continue;
+			}
+
+			// The deltas are from codes with the bits below the carry set, as those of the leaf are not
+			const unsigned carry = leaf_bits_ + count_trailing_ones(leaf);
+			if (++leaf < leaves) first += carry_delta_[carry] + leaf_last_;
+		}
+	}
+
+	std::uint64_t encode(const offset<Rank>& idx) const
+	{
+		std::uint64_t code = 0;
+		for (size_t dim=0; dim<Rank; ++dim) {
+			code |= deposit_bits(static_cast<std::uint64_t>(idx[dim]), masks_[dim]);
+		}
+		return code;
+	}
+
+	offset<Rank> decode(std::uint64_t code) const
+	{
+		offset<Rank> idx;
+		for (size_t dim=0; dim<Rank; ++dim) {
+			idx[dim] = static_cast<std::ptrdiff_t>(extract_bits(code, masks_[dim]));
+		}
+		return idx;
+	}
+
+private:
+	friend class morton_iterator<Rank>;
+
+	unsigned code_dim(size_t bit) const
+	{
+		for (unsigned dim=0; dim<Rank; ++dim) {
+			if (masks_[dim] >> bit & 1u) return dim;
+		}
+		return 0;
+	}
+
+	// The value of a bit of the code in its dimension
+	std::ptrdiff_t weight(size_t bit) const
+	{
+		const std::uint64_t below = masks_[code_dim(bit)] & ((std::uint64_t{1} << bit) - 1);
+		return std::ptrdiff_t{1} << count_bits(below);
+	}
+
+	static unsigned count_bits(std::uint64_t value)
+	{
+		unsigned n = 0;
+		for (; value; value &= value - 1) ++n;
+		return n;
+	}
+
+	// The least code after `code` (which is of an index outside of the bounds) of an index within
+	// them, or end_code_ if there is none.  This is BIGMIN of Tropf and Herzog, over the box from 0 to
+	// max_code_: from the most significant bit, where the code is below the box in a bit it jumps to
+	// the least code of the box that has that bit set, and where above, to the candidate found so far.
+	std::uint64_t next_within(std::uint64_t code) const
+	{
+		std::uint64_t low = 0, high = max_code_, result = end_code_;
+		for (unsigned bit=code_bits_; bit-- > 0; )
+		{
+			const std::uint64_t at = std::uint64_t{1} << bit;
+			const std::uint64_t below = masks_[code_dim(bit)] & (at - 1);
+			const bool z = code & at, l = low & at, h = high & at;
+
+			if (!z && !l && h)
+			{
+				result = ((low | at) & ~below);  // the least of the box with this bit set
+				high = (high & ~at) | below;     // and continuing in the part with it clear
+			}
+			else if (!z && l && h) {
+				return low;
+			}
+			else if (z && !l && !h) {
+				return result;
+			}
+			else if (z && !l && h) {
+				low = (low | at) & ~below;
+			}
+		}
+		return result;
+	}
+
+	bool within(const offset<Rank>& idx) const
+	{
+		for (size_t dim=0; dim<Rank; ++dim) {
+			if (idx[dim] >= bounds_[dim]) return false;
+		}
+		return true;
+	}
+
+	static constexpr unsigned max_leaf_bits = 6;
+
+	bounds<Rank>  bounds_;
+	std::uint64_t masks_[Rank] = {};
+	std::uint64_t end_code_ = 0;
+	std::uint64_t max_code_ = 0;  // of the last index of the bounds
+
+	// For each bit of the code, the change to the index when an increment of the code carries into it
+	unsigned     code_bits_ = 0;
+	offset<Rank> carry_delta_[64];
+
+	// The indices of the codes of a leaf, about its first
+	unsigned     leaf_bits_ = 0;
+	offset<Rank> leaf_[std::size_t{1} << max_leaf_bits];
+	offset<Rank> leaf_last_;
+};
+
+// Holds the order by pointer, so the order must outlive its iterators
+template <size_t Rank>
+class morton_iterator
+{
+public:
+	using iterator_category = std::forward_iterator_tag;
+	using value_type        = offset<Rank>;
+	using difference_type   = std::ptrdiff_t;
+	using pointer           = const offset<Rank>*;
+	using reference         = const offset<Rank>&;
+
+	morton_iterator(const morton_order<Rank>& order, std::uint64_t code) noexcept
+		: order_(&order), code_(code)
+	{
+		if (code_ < order_->end_code_) {
+			offset_ = order_->decode(code_);
+			if (!order_->bounds_.contains(offset_)) skip();
+		}
+	}
+
+	bool operator==(const morton_iterator& rhs) const { return code_ == rhs.code_; }
+	bool operator!=(const morton_iterator& rhs) const { return code_ != rhs.code_; }
+
+	// Incrementing the code clears its trailing set bits and sets the next, which changes the index
+	// by the delta of that bit.  Codes of indices outside of the bounds (when an extent is not a power
+	// of two) are jumped over together, to the next code within them.
+	morton_iterator& operator++()
+	{
+		const unsigned carry = count_trailing_ones(code_);
+		if (++code_ >= order_->end_code_) {
+			code_ = order_->end_code_;
+			return *this;
+		}
+
+		offset_ += order_->carry_delta_[carry];
+		if (!order_->bounds_.contains(offset_)) skip();
+		return *this;
+	}
+
+	morton_iterator operator++(int)
+	{
+		morton_iterator tmp(*this);
+		++(*this);
+		return tmp;
+	}
+
+	reference operator*() const { return offset_; }
+	pointer   operator->() const { return &offset_; }
+
+	std::uint64_t code() const { return code_; }
+
+private:
+	void skip()
+	{
+		code_ = order_->next_within(code_);
+		if (code_ < order_->end_code_) offset_ = order_->decode(code_);
+	}
+
+	const morton_order<Rank>* order_;
+	std::uint64_t code_;
+	offset<Rank>  offset_;
+};
+
+template <size_t Rank>
+morton_iterator<Rank> morton_order<Rank>::begin() const
+{ return morton_iterator<Rank>(*this, 0); }
+
+template <size_t Rank>
+morton_iterator<Rank> morton_order<Rank>::end() const
+{ return morton_iterator<Rank>(*this, end_code_); }
+
+}
@@ -0,0 +1,107 @@
+#include "array_view/morton.h"
+
+#include <set>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace av;
+
+TEST(morton_order_test, PowerOfTwo)
+{
+	// The Z-order curve, with the least significant dimension first
+	vector<offset<2>> expected = {
+		{0,0}, {0,1}, {1,0}, {1,1}, {0,2}, {0,3}, {1,2}, {1,3},
+		{2,0}, {2,1}, {3,0}, {3,1}, {2,2}, {2,3}, {3,2}, {3,3}
+	};
+
+	vector<offset<2>> visited;
+	for (const offset<2>& idx : morton_order<2>({4,4})) {
+		visited.push_back(idx);
+	}
+	EXPECT_EQ(expected, visited);
+}
+
+TEST(morton_order_test, AnyExtents)
+{
+	for (bounds<3> b : {bounds<3>{1,1,1}, bounds<3>{3,5,7}, bounds<3>{1,17,2}, bounds<3>{9,1,33}, bounds<3>{0,4,4}})
+	{
+		morton_order<3> order(b);
+
+		set<uint64_t> codes;
+		vector<ptrdiff_t> counts(b.size());
+		array_view<ptrdiff_t, 3> count_view(counts, b);
+
+		for (morton_iterator<3> iter = order.begin(); iter != order.end(); ++iter)
+		{
+			ASSERT_TRUE(b.contains(*iter));
+			++count_view[*iter];
+
+			EXPECT_EQ(iter.code(), order.encode(*iter));
+			EXPECT_EQ(*iter, order.decode(iter.code()));
+			EXPECT_TRUE(codes.insert(iter.code()).second);
+		}
+
+		// Each index is visited once, in increasing order of code
+		for (ptrdiff_t count : counts) {
+			EXPECT_EQ(1, count);
+		}
+		EXPECT_EQ(b.size(), codes.size());
+	}
+}
+
+TEST(morton_order_test, Unequal)
+{
+	// Once the extent of the inner dimension is covered, the outer continues alone
+	vector<offset<2>> visited;
+	for (const offset<2>& idx : morton_order<2>({4,2})) {
+		visited.push_back(idx);
+	}
+	vector<offset<2>> expected = {{0,0}, {0,1}, {1,0}, {1,1}, {2,0}, {2,1}, {3,0}, {3,1}};
+	EXPECT_EQ(expected, visited);
+}
+
+TEST(morton_order_test, SkipsOutOfBounds)
+{
+	// Just above powers of two, where most of the space of codes is outside of the bounds, the
+	// order is still that of every code in turn, less those outside
+	for (bounds<3> b : {bounds<3>{17,2,9}, bounds<3>{5,33,3}, bounds<3>{2,2,65}, bounds<3>{9,9,9}})
+	{
+		morton_order<3> order(b);
+
+		vector<uint64_t> expected;
+		for (uint64_t code=0; code < (uint64_t{1} << 20); ++code)
+		{
+			const offset<3> idx = order.decode(code);
+			if (b.contains(idx) && order.encode(idx) == code) expected.push_back(code);
+			if (expected.size() == b.size()) break;
+		}
+
+		vector<uint64_t> visited;
+		for (morton_iterator<3> iter = order.begin(); iter != order.end(); ++iter)
+		{
+			EXPECT_EQ(order.decode(iter.code()), *iter);
+			visited.push_back(iter.code());
+		}
+		EXPECT_EQ(expected, visited);
+	}
+
+	// Iterators refer to their order, rather than copying it
+	static_assert(sizeof(morton_iterator<3>) <= sizeof(void*) + sizeof(uint64_t) + sizeof(offset<3>), "");
+}
+
+TEST(morton_order_test, ForEach)
+{
+	// The same order as the iterators, leaf by leaf, whether the leaves are within the bounds,
+	// straddle them or are outside of them
+	for (bounds<3> b : {bounds<3>{1,1,1}, bounds<3>{3,5,7}, bounds<3>{17,2,9}, bounds<3>{8,8,8}, bounds<3>{0,4,4}, bounds<3>{33,1,2}})
+	{
+		morton_order<3> order(b);
+		vector<offset<3>> iterated(order.begin(), order.end());
+		vector<offset<3>> visited;
+		order.for_each([&](const offset<3>& idx) { visited.push_back(idx); });
+		EXPECT_EQ(iterated, visited);
+		EXPECT_EQ(b.size(), visited.size());
+	}
+}
@@ -0,0 +1,397 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+#include "array_view.h"
+#include "pages.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/*
+// A NUMA node and the CPUs on it
+struct numa_node
+{
+	int id;
+	std::vector<int> cpus;
+};
+
+// The nodes of the machine, as listed in /sys/devices/system/node, or otherwise a single node of
+// every CPU
+const std::vector<numa_node>& numa_nodes();
+
+enum class numa_placement
+{
+	first_touch,  // each slab is first written by a thread on its node
+	bind          // each slab is also bound to its node with mbind
+};
+
+// An array whose dimension 0 is divided into a slab per node, with the pages of each slab on its node
+template <typename T, size_t Rank = 1>
+class numa_array
+{
+public:
+	numa_array() noexcept;
+	explicit numa_array(const bounds<Rank>& b, numa_placement placement = numa_placement::first_touch,
+	                    unsigned threads_per_node = 1, page_size_hint pages = page_size_hint::normal);
+	numa_array(numa_array&& rhs) noexcept;
+	numa_array& operator=(numa_array&& rhs) noexcept;
+	~numa_array();
+
+	array_view<T, Rank> view() const noexcept;
+	bounds<Rank> bounds() const noexcept;
+	numa_placement placement() const noexcept;  // as achieved, first_touch where binding failed
+	page_size_hint pages() const noexcept;      // as achieved, see map_pages
+	size_t huge_page_bytes() const;             // of the array, resident in huge pages
+
+	// slabs, one per node
+	size_t slabs() const noexcept;
+	const numa_node& node_of(size_t slab) const;
+	ptrdiff_t slab_begin(size_t slab) const noexcept;  // first index of the slab in dimension 0
+	array_view<T, Rank> slab(size_t slab) const noexcept;
+
+	// The node each page is on, or a negative errno where unknown (such as for a page not yet touched)
+	std::vector<int> page_nodes() const;
+	// Moves pages that are not on the node of their slab, returning false if that is not possible
+	bool migrate();
+};
+
+// Calls fn(section, first) for parts of each slab of `array` in parallel, where `section` views the
+// part and `first` is its index in dimension 0, each from a thread on the slab's node
+template <typename T, size_t Rank, typename Fn>
+void parallel_for_slabs(const numa_array<T, Rank>& array, Fn fn, unsigned threads_per_node = 1);
+*/
+
+namespace av
+{
+
+struct numa_node
+{
+	int id;
+	std::vector<int> cpus;
+};
+
+enum class numa_placement
+{
+	first_touch,
+	bind
+};
+
+namespace {
+
+	// Parses a list of the form "0-3,8,10-11"
+	inline std::vector<int> parse_cpu_list(const std::string& list)
+	{
+		std::vector<int> values;
+		size_t pos = 0;
+		while (pos < list.size())
+		{
+			size_t end = 0;
+			const int first = std::stoi(list.substr(pos), &end);
+			pos += end;
+			int last = first;
+			if (pos < list.size() && list[pos] == '-')
+			{
+				last = std::stoi(list.substr(pos + 1), &end);
+				pos += end + 1;
+			}
+			for (int value=first; value<=last; ++value) values.push_back(value);
+			while (pos < list.size() && (list[pos] == ',' || list[pos] == '\n')) ++pos;
+		}
+		return values;
+	}
+
+	inline std::vector<int> read_list(const std::string& path)
+	{
+		std::ifstream file(path);
+		std::string line;
+		if (!std::getline(file, line) || line.empty()) return {};
+		try {
+			return parse_cpu_list(line);
+		}
+		catch (...) {
+			return {};
+		}
+	}
+
+	inline std::vector<numa_node> read_numa_nodes()
+	{
+		std::vector<numa_node> nodes;
+		for (int id : read_list("/sys/devices/system/node/online"))
+		{
+			std::vector<int> cpus = read_list("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+			if (!cpus.empty()) nodes.push_back(numa_node{id, std::move(cpus)});
+		}
+
+		if (nodes.empty())
+		{
+			numa_node all{0, {}};
+			const unsigned count = std::thread::hardware_concurrency();
+			for (unsigned cpu=0; cpu<(count == 0 ? 1 : count); ++cpu) all.cpus.push_back(int(cpu));
+			nodes.push_back(all);
+		}
+		return nodes;
+	}
+
+	// Runs the calling thread on the CPUs of `node`, where the process is allowed them
+	inline void run_on_node(const numa_node& node)
+	{
+		cpu_set_t allowed;
+		CPU_ZERO(&allowed);
+		if (::sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		bool any = false;
+		for (int cpu : node.cpus)
+		{
+			if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) {
+				CPU_SET(cpu, &cpus);
+				any = true;
+			}
+		}
+		if (any) ::sched_setaffinity(0, sizeof(cpus), &cpus);
+	}
+
+	// As numaif.h, which may not be installed
+	constexpr int numa_mpol_bind = 2;
+	constexpr int numa_mpol_mf_move = 1 << 1;
+
+	inline bool bind_to_node(void* addr, size_t length, int node)
+	{
+		const size_t bits = 8 * sizeof(unsigned long);
+		std::vector<unsigned long> mask(size_t(node) / bits + 1, 0);
+		mask[size_t(node) / bits] |= 1ul << (size_t(node) % bits);
+		// The kernel takes one more than the number of bits in the mask
+		return ::syscall(SYS_mbind, addr, length, numa_mpol_bind, mask.data(), mask.size() * bits + 1, 0) == 0;
+	}
+
+	// Calls fn(slab, first, last) over `parts` equal parts of each of the `slabs` ranges of [0, n),
+	// each on a thread running on the node of the slab
+	template <typename Fn>
+	void run_on_slabs(const std::vector<numa_node>& nodes, const std::vector<std::ptrdiff_t>& begins,
+	                  unsigned parts, Fn&& fn)
+	{
+		std::vector<std::thread> workers;
+		for (size_t slab=0; slab+1<begins.size(); ++slab)
+		{
+			const std::ptrdiff_t begin = begins[slab];
+			const std::ptrdiff_t rows = begins[slab + 1] - begin;
+			for (unsigned part=0; part<parts; ++part)
+			{
+				const std::ptrdiff_t first = begin + rows * part / parts;
+				const std::ptrdiff_t last = begin + rows * (part + 1) / parts;
+				if (first == last) continue;
+				workers.emplace_back([&fn, &nodes, slab, first, last] {
+					run_on_node(nodes[slab]);
+					fn(slab, first, last);
+				});
+			}
+		}
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+	}
+
+} // namespace
+
+inline const std::vector<numa_node>& numa_nodes()
+{
+	static const std::vector<numa_node> nodes = read_numa_nodes();
+	return nodes;
+}
+
+// Pages are placed where they are first written, so a large array allocated and initialized by one
+// thread lies entirely on that thread's node, and threads on other nodes then reach all of it over
+// the interconnect.  Here dimension 0 is divided into a slab per node, and each slab is first written
+// by threads on its node, as `parallel_for_slabs` later visits it; with `bind`, each slab is also
+// bound to its node, so that its pages stay there even if first written elsewhere.  On a single
+// node, there is just the one slab.  Elements start as zero.
+template <typename T, size_t Rank = 1>
+class numa_array
+{
+public:
+	static_assert(std::is_trivial<T>::value, "Elements of a numa_array must be of a trivial type");
+
+	numa_array() noexcept {}
+
+	explicit numa_array(const av::bounds<Rank>& b, numa_placement placement = numa_placement::first_touch,
+	                    unsigned threads_per_node = 1, page_size_hint pages = page_size_hint::normal)
+		: bounds_(b), placement_(placement)
+	{
+		const std::vector<numa_node>& nodes = numa_nodes();
+		const std::ptrdiff_t rows = b[0];
+		for (size_t slab=0; slab<=nodes.size(); ++slab) {
+			begins_.push_back(rows * std::ptrdiff_t(slab) / std::ptrdiff_t(nodes.size()));
+		}
+
+		if (b.size() == 0) return;
+
+		void* mapping = map_pages(b.size() * sizeof(T), pages, pages_);
+		if (!mapping) {
+			bounds_ = {};
+			return;
+		}
+		data_ = static_cast<T*>(mapping);
+		length_ = mapped_length(b.size() * sizeof(T), pages_);
+
+		if (placement_ == numa_placement::bind)
+		{
+			for (size_t slab=0; slab<slabs(); ++slab)
+			{
+				const std::pair<char*, char*> range = slab_pages(slab);
+				if (range.first < range.second && !bind_to_node(range.first, size_t(range.second - range.first), nodes[slab].id)) {
+					placement_ = numa_placement::first_touch;
+				}
+			}
+		}
+
+		// Write a byte of each page from a thread on the node of its slab: its first byte, then the
+		// start of each page after it, as a slab need not begin on a page boundary
+		const std::uintptr_t page = system_page_size();
+		run_on_slabs(nodes, begins_, threads_per_node == 0 ? 1 : threads_per_node,
+		             [this, page](size_t, std::ptrdiff_t first, std::ptrdiff_t last) {
+			const std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(data_ + first * row_size());
+			const std::uintptr_t end = reinterpret_cast<std::uintptr_t>(data_ + last * row_size());
+			*reinterpret_cast<volatile char*>(begin) = 0;
+			for (std::uintptr_t p = round_up(begin + 1, page); p < end; p += page) {
+				*reinterpret_cast<volatile char*>(p) = 0;
+			}
+		});
+	}
+
+	numa_array(const numa_array&) = delete;
+	numa_array& operator=(const numa_array&) = delete;
+
+	numa_array(numa_array&& rhs) noexcept { swap(rhs); }
+	numa_array& operator=(numa_array&& rhs) noexcept { swap(rhs); return *this; }
+
+	~numa_array()
+	{
+		unmap_pages(data_, length_, pages_);
+	}
+
+	array_view<T, Rank> view() const noexcept { return array_view<T, Rank>(data_, bounds_); }
+	av::bounds<Rank> bounds() const noexcept { return bounds_; }
+	numa_placement placement() const noexcept { return placement_; }
+	page_size_hint pages() const noexcept { return pages_; }
+	size_t huge_page_bytes() const { return data_ ? av::huge_page_bytes(data_, length_) : 0; }
+
+	size_t slabs() const noexcept { return begins_.empty() ? 0 : begins_.size() - 1; }
+	const numa_node& node_of(size_t slab) const { return numa_nodes()[slab]; }
+	std::ptrdiff_t slab_begin(size_t slab) const noexcept { return begins_[slab]; }
+
+	array_view<T, Rank> slab(size_t n) const noexcept
+	{
+		av::bounds<Rank> b = bounds_;
+		b[0] = begins_[n + 1] - begins_[n];
+		return array_view<T, Rank>(data_ + begins_[n] * row_size(), b);
+	}
+
+	std::vector<int> page_nodes() const
+	{
+		std::vector<void*> pages;
+		for (char* p = reinterpret_cast<char*>(data_); p < reinterpret_cast<char*>(data_) + length_; p += system_page_size()) {
+			pages.push_back(p);
+		}
+		std::vector<int> status(pages.size(), -1);
+		if (!pages.empty() &&
+		    ::syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr, status.data(), 0) != 0) {
+			std::fill(status.begin(), status.end(), -1);
+		}
+		return status;
+	}
+
+	bool migrate()
+	{
+		std::vector<void*> pages;
+		std::vector<int> targets;
+		for (size_t slab=0; slab<slabs(); ++slab)
+		{
+			const std::pair<char*, char*> range = slab_pages(slab);
+			for (char* p = range.first; p < range.second; p += system_page_size()) {
+				pages.push_back(p);
+				targets.push_back(node_of(slab).id);
+			}
+		}
+		if (pages.empty()) return true;
+
+		std::vector<int> status(pages.size());
+		return ::syscall(SYS_move_pages, 0, pages.size(), pages.data(), targets.data(), status.data(),
+		                 numa_mpol_mf_move) >= 0;
+	}
+
+private:
+	std::ptrdiff_t row_size() const noexcept
+	{ return bounds_[0] == 0 ? 0 : std::ptrdiff_t(bounds_.size()) / bounds_[0]; }
+
+	// The pages of a slab, as those that start within it, with the first page the first slab's
+	std::pair<char*, char*> slab_pages(size_t slab) const
+	{
+		const std::uintptr_t page = system_page_size();
+		const auto start_of = [&](size_t s) {
+			if (s == 0) return reinterpret_cast<std::uintptr_t>(data_);
+			if (s == slabs()) return reinterpret_cast<std::uintptr_t>(data_) + length_;
+			const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(data_ + begins_[s] * row_size());
+			return (address + page - 1) / page * page;
+		};
+		return {reinterpret_cast<char*>(start_of(slab)), reinterpret_cast<char*>(start_of(slab + 1))};
+	}
+
+	void swap(numa_array& rhs) noexcept
+	{
+		std::swap(data_, rhs.data_);
+		std::swap(length_, rhs.length_);
+		std::swap(bounds_, rhs.bounds_);
+		std::swap(placement_, rhs.placement_);
+		std::swap(pages_, rhs.pages_);
+		std::swap(begins_, rhs.begins_);
+	}
+
+	T* data_ = nullptr;
+	size_t length_ = 0;
+	av::bounds<Rank> bounds_;
+	numa_placement placement_ = numa_placement::first_touch;
+	page_size_hint pages_ = page_size_hint::normal;
+	std::vector<std::ptrdiff_t> begins_;
+};
+
+// Each slab is divided between `threads_per_node` threads on its node, as when the array was first
+// written, so each thread reaches the same pages it placed
+template <typename T, size_t Rank, typename Fn>
+void parallel_for_slabs(const numa_array<T, Rank>& array, Fn fn, unsigned threads_per_node = 1)
+{
+	std::vector<std::ptrdiff_t> begins;
+	for (size_t slab=0; slab<=array.slabs(); ++slab) {
+		begins.push_back(slab == array.slabs() ? array.bounds()[0] : array.slab_begin(slab));
+	}
+
+	const array_view<T, Rank> view = array.view();
+	run_on_slabs(numa_nodes(), begins, threads_per_node == 0 ? 1 : threads_per_node,
+	             [&](size_t, std::ptrdiff_t first, std::ptrdiff_t last) {
+		av::bounds<Rank> b = view.bounds();
+		b[0] = last - first;
+		offset<Rank> origin;
+		origin[0] = first;
+		fn(array_view<T, Rank>(&view[origin], b), first);
+	});
+}
+
+}
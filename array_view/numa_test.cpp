@@ -0,0 +1,102 @@
+#include "array_view/numa.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace av;
+
+TEST(numa_test, Nodes)
+{
+	EXPECT_EQ((vector<int>{0, 1, 2, 3, 8, 10, 11}), parse_cpu_list("0-3,8,10-11\n"));
+	EXPECT_EQ((vector<int>{5}), parse_cpu_list("5"));
+
+	// Every machine has at least one node, with a CPU
+	const vector<numa_node>& nodes = numa_nodes();
+	ASSERT_FALSE(nodes.empty());
+	for (const numa_node& node : nodes) {
+		EXPECT_FALSE(node.cpus.empty());
+	}
+}
+
+TEST(numa_test, Slabs)
+{
+	// A slab per node, together covering dimension 0, with every element zero
+	const bounds<2> b = {1001, 300};
+	numa_array<int, 2> array(b, numa_placement::first_touch, 2);
+	EXPECT_EQ(b, array.bounds());
+	EXPECT_EQ(numa_placement::first_touch, array.placement());
+	ASSERT_EQ(numa_nodes().size(), array.slabs());
+
+	ptrdiff_t rows = 0;
+	for (size_t slab=0; slab<array.slabs(); ++slab)
+	{
+		EXPECT_EQ(rows, array.slab_begin(slab));
+		EXPECT_EQ((&array.view()[{rows, 0}]), array.slab(slab).data());
+		EXPECT_EQ(300, array.slab(slab).bounds()[1]);
+		rows += array.slab(slab).bounds()[0];
+	}
+	EXPECT_EQ(1001, rows);
+
+	const array_view<int, 2> view = array.view();
+	EXPECT_TRUE(all_of(view.data(), view.data() + view.size(), [](int v) { return v == 0; }));
+
+	// Each page that the kernel reports is on the node of a slab
+	for (int node : array.page_nodes())
+	{
+		if (node < 0) continue;
+		EXPECT_TRUE(any_of(numa_nodes().begin(), numa_nodes().end(), [&](const numa_node& n) { return n.id == node; }));
+	}
+}
+
+TEST(numa_test, ParallelForSlabs)
+{
+	numa_array<float, 2> array({513, 64}, numa_placement::bind);
+	if (array.placement() == numa_placement::bind)
+	{
+		// Bound pages are on the one node of a single-node machine
+		if (array.slabs() == 1) {
+			for (int node : array.page_nodes()) EXPECT_TRUE(node < 0 || node == array.node_of(0).id);
+		}
+	}
+	EXPECT_TRUE(array.migrate() || array.placement() == numa_placement::first_touch);
+
+	// Each row is visited once, by one of 3 threads per node
+	std::atomic<ptrdiff_t> visited{0};
+	parallel_for_slabs(array, [&](array_view<float, 2> section, ptrdiff_t first) {
+		for (ptrdiff_t i=0; i<section.bounds()[0]; ++i) {
+			for (ptrdiff_t j=0; j<64; ++j) section[{i, j}] = float(first + i);
+		}
+		visited += section.bounds()[0];
+	}, 3);
+
+	EXPECT_EQ(513, visited.load());
+	for (ptrdiff_t i=0; i<513; ++i) {
+		ASSERT_EQ(float(i), (array.view()[{i, 63}]));
+	}
+
+	// Moving leaves an empty array behind
+	numa_array<float, 2> moved(std::move(array));
+	EXPECT_EQ(512.f, (moved.view()[{512, 0}]));
+	EXPECT_EQ(nullptr, array.view().data());
+}
+
+TEST(numa_test, HugePages)
+{
+	// 8MB of rows, in huge pages where the kernel allows, otherwise as normal
+	numa_array<double, 2> array({1024, 1024}, numa_placement::first_touch, 1, page_size_hint::transparent_huge);
+	ASSERT_NE(nullptr, array.view().data());
+	EXPECT_NE(page_size_hint::hugetlb, array.pages());
+	if (array.pages() == page_size_hint::transparent_huge) {
+		EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(array.view().data()) % huge_page_size);
+	}
+	EXPECT_LE(array.huge_page_bytes(), array.view().size() * sizeof(double));
+	EXPECT_EQ(0., (array.view()[{1023, 1023}]));
+
+	numa_array<double, 2> normal({1024, 1024});
+	EXPECT_EQ(page_size_hint::normal, normal.pages());
+	EXPECT_EQ(0u, normal.huge_page_bytes());
+}
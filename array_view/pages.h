@@ -0,0 +1,188 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+#include "array_view.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*
+enum class page_size_hint
+{
+	normal,            // the system's base pages
+	transparent_huge,  // 2MB aligned, and advised to the kernel as suited to transparent huge pages
+	hugetlb            // reserved huge pages from hugetlbfs, or else as transparent_huge
+};
+
+constexpr size_t huge_page_size = 2 << 20;
+
+// An anonymous, zeroed, read-write mapping of at least `length` bytes, as near to `hint` as is
+// possible, which `achieved` is set to.  Returns nullptr if there is no memory at all.
+void* map_pages(size_t length, page_size_hint hint, page_size_hint& achieved);
+void unmap_pages(void* addr, size_t length, page_size_hint achieved);
+
+// Advises the kernel that [addr, addr + length) is suited to transparent huge pages
+bool advise_huge_pages(void* addr, size_t length);
+
+// The bytes of [addr, addr + length) that are resident in huge pages, as reported by
+// /proc/self/smaps, or zero where that is not available
+size_t huge_page_bytes(const void* addr, size_t length);
+*/
+
+namespace av
+{
+
+enum class page_size_hint
+{
+	normal,
+	transparent_huge,
+	hugetlb
+};
+
+constexpr size_t huge_page_size = 2 << 20;
+
+namespace {
+
+	inline size_t system_page_size()
+	{
+		const long size = ::sysconf(_SC_PAGESIZE);
+		return size > 0 ? size_t(size) : size_t(AV_PAGE_SIZE);
+	}
+
+	constexpr size_t round_up(size_t n, size_t multiple) noexcept
+	{
+		return (n + multiple - 1) / multiple * multiple;
+	}
+
+	// The length of a mapping of `length` bytes with the given pages
+	inline size_t mapped_length(size_t length, page_size_hint pages)
+	{
+		return round_up(length, pages == page_size_hint::normal ? system_page_size() : huge_page_size);
+	}
+
+	// A mapping starting on a huge page boundary, by mapping a huge page more than needed and
+	// unmapping either side of the boundary
+	inline void* map_huge_aligned(size_t length)
+	{
+		void* mapping = ::mmap(nullptr, length + huge_page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (mapping == MAP_FAILED) return nullptr;
+
+		char* first = static_cast<char*>(mapping);
+		char* aligned = reinterpret_cast<char*>(round_up(reinterpret_cast<std::uintptr_t>(first), huge_page_size));
+		if (aligned != first) ::munmap(first, size_t(aligned - first));
+		const size_t after = size_t(first + length + huge_page_size - (aligned + length));
+		if (after > 0) ::munmap(aligned + length, after);
+		return aligned;
+	}
+
+} // namespace
+
+inline bool advise_huge_pages(void* addr, size_t length)
+{
+#if defined(MADV_HUGEPAGE)
+	return ::madvise(addr, length, MADV_HUGEPAGE) == 0;
+#else
+	(void)addr;
+	(void)length;
+	return false;
+#endif
+}
+
+// hugetlbfs pages must be reserved by the administrator beforehand, so a request for them falls
+// back to transparent huge pages, which the kernel provides where it can (depending on
+// /sys/kernel/mm/transparent_hugepage/enabled), and those fall back to base pages.  Huge pages
+// must be aligned to their size to be used at all, so those mappings are.
+inline void* map_pages(size_t length, page_size_hint hint, page_size_hint& achieved)
+{
+	if (length == 0) length = 1;
+
+#if defined(MAP_HUGETLB)
+	if (hint == page_size_hint::hugetlb)
+	{
+		void* mapping = ::mmap(nullptr, mapped_length(length, hint), PROT_READ | PROT_WRITE,
+		                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (mapping != MAP_FAILED) {
+			achieved = page_size_hint::hugetlb;
+			return mapping;
+		}
+	}
+#endif
+
+	if (hint != page_size_hint::normal)
+	{
+		const size_t huge_length = mapped_length(length, page_size_hint::transparent_huge);
+		if (void* mapping = map_huge_aligned(huge_length))
+		{
+			if (advise_huge_pages(mapping, huge_length)) {
+				achieved = page_size_hint::transparent_huge;
+				return mapping;
+			}
+			::munmap(mapping, huge_length);
+		}
+	}
+
+	void* mapping = ::mmap(nullptr, mapped_length(length, page_size_hint::normal), PROT_READ | PROT_WRITE,
+	                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	achieved = page_size_hint::normal;
+	return mapping == MAP_FAILED ? nullptr : mapping;
+}
+
+inline void unmap_pages(void* addr, size_t length, page_size_hint achieved)
+{
+	if (addr) ::munmap(addr, mapped_length(length == 0 ? 1 : length, achieved));
+}
+
+// Each mapping in smaps starts with a line of its address range, followed by lines of fields in kB.
+// Huge pages are counted as AnonHugePages (transparent, anonymous), FilePmdMapped (transparent, of
+// files) and Private_ or Shared_Hugetlb (hugetlbfs).  Fields are for the whole of each mapping, so
+// are prorated where the range covers only part of one.
+inline size_t huge_page_bytes(const void* addr, size_t length)
+{
+	std::ifstream smaps("/proc/self/smaps");
+	if (!smaps) return 0;
+
+	const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(addr);
+	const std::uintptr_t last = first + length;
+
+	double total = 0;
+	double share = 0;  // of the current mapping within the range
+	std::string line;
+	while (std::getline(smaps, line))
+	{
+		unsigned long long start, end;
+		char dash;
+		if (std::sscanf(line.c_str(), "%llx%c%llx", &start, &dash, &end) == 3 && dash == '-')
+		{
+			const std::uintptr_t lo = std::max<std::uintptr_t>(first, start);
+			const std::uintptr_t hi = std::min<std::uintptr_t>(last, end);
+			share = hi > lo ? double(hi - lo) / double(end - start) : 0;
+			continue;
+		}
+		if (share == 0) continue;
+
+		char field[64];
+		unsigned long long kb;
+		if (std::sscanf(line.c_str(), "%63[^:]: %llu kB", field, &kb) != 2) continue;
+		if (std::strcmp(field, "AnonHugePages") == 0 || std::strcmp(field, "FilePmdMapped") == 0 ||
+		    std::strcmp(field, "Private_Hugetlb") == 0 || std::strcmp(field, "Shared_Hugetlb") == 0) {
+			total += share * double(kb) * 1024;
+		}
+	}
+	return std::min(length, size_t(total));
+}
+
+}
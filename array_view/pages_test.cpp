@@ -0,0 +1,66 @@
+#include "array_view/pages.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace av;
+
+namespace {
+
+	// Whether the kernel may back any anonymous mapping with transparent huge pages, advised or not
+	bool huge_pages_always()
+	{
+		FILE* file = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+		if (!file) return false;
+		char mode[128] = {};
+		const bool read = fgets(mode, sizeof(mode), file) != nullptr;
+		fclose(file);
+		return read && strstr(mode, "[always]") != nullptr;
+	}
+
+} // namespace
+
+TEST(pages_test, MapPages)
+{
+	const size_t length = 3 * huge_page_size + 100;
+	for (page_size_hint hint : {page_size_hint::normal, page_size_hint::transparent_huge, page_size_hint::hugetlb})
+	{
+		// Huge pages fall back to smaller ones, never the other way
+		page_size_hint achieved = page_size_hint::hugetlb;
+		void* mapping = map_pages(length, hint, achieved);
+		ASSERT_NE(nullptr, mapping);
+		EXPECT_LE(int(achieved), int(hint));
+		if (achieved != page_size_hint::normal) {
+			EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(mapping) % huge_page_size);
+		}
+
+		// Zeroed and writable
+		unsigned char* bytes = static_cast<unsigned char*>(mapping);
+		EXPECT_EQ(0, bytes[0]);
+		EXPECT_EQ(0, bytes[length - 1]);
+		memset(bytes, 1, length);
+		EXPECT_EQ(1, bytes[length - 1]);
+
+		EXPECT_LE(huge_page_bytes(mapping, length), length);
+		if (hint == page_size_hint::normal && !huge_pages_always()) {
+			EXPECT_EQ(0u, huge_page_bytes(mapping, length));
+		}
+		unmap_pages(mapping, length, achieved);
+	}
+}
+
+TEST(pages_test, HugePageBytes)
+{
+	// None of a range outside any mapping
+	EXPECT_EQ(0u, huge_page_bytes(nullptr, 4096));
+
+	page_size_hint achieved;
+	void* mapping = map_pages(0, page_size_hint::normal, achieved);
+	ASSERT_NE(nullptr, mapping);
+	EXPECT_EQ(0u, huge_page_bytes(mapping, 1));
+	unmap_pages(mapping, 0, achieved);
+}
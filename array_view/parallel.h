@@ -0,0 +1,54 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+/*
+// Calls fn(thread, first, last) over `threads` roughly equal parts of [0, n), the first on the
+// calling thread
+template <typename Fn>
+void parallel_partition(size_t n, unsigned threads, Fn&& fn);
+
+// `threads`, or where that is 0 the number of hardware threads (at least 1)
+unsigned default_thread_count(unsigned threads);
+*/
+
+namespace av
+{
+
+namespace {
+
+	template <typename Fn>
+	void parallel_partition(size_t n, unsigned threads, Fn&& fn)
+	{
+		std::vector<std::thread> workers;
+		workers.reserve(threads - 1);
+		for (unsigned t=1; t<threads; ++t) {
+			workers.emplace_back([&fn, n, t, threads] { fn(t, n * t / threads, n * (t+1) / threads); });
+		}
+		fn(0u, size_t{0}, n / threads);
+
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+	}
+
+	inline unsigned default_thread_count(unsigned threads)
+	{
+		if (threads == 0) threads = std::thread::hardware_concurrency();
+		return threads == 0 ? 1 : threads;
+	}
+
+} // namespace
+
+}
@@ -0,0 +1,37 @@
+#include "array_view/parallel.h"
+
+#include <atomic>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace av;
+
+TEST(parallel_test, PartitionCoversEachIndexOnce)
+{
+	for (size_t n : {0, 1, 5, 1000})
+	{
+		for (unsigned threads : {1u, 3u, 8u})
+		{
+			vector<atomic<int>> visits(n);
+			vector<int> calls(threads);
+			parallel_partition(n, threads, [&](unsigned t, size_t first, size_t last) {
+				++calls[t];
+				for (size_t i=first; i<last; ++i) ++visits[i];
+			});
+			for (size_t i=0; i<n; ++i) {
+				EXPECT_EQ(1, visits[i].load());
+			}
+			for (int c : calls) {
+				EXPECT_EQ(1, c);
+			}
+		}
+	}
+}
+
+TEST(parallel_test, DefaultThreadCount)
+{
+	EXPECT_EQ(3u, default_thread_count(3));
+	EXPECT_LE(1u, default_thread_count(0));
+}
@@ -0,0 +1,279 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+#include "array_view.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+// A fixed-capacity lock-free queue between one producer thread and one consumer thread
+template <typename T>
+class spsc_ring
+{
+public:
+	explicit spsc_ring(size_t capacity);  // rounded up to a power of two
+
+	size_t capacity() const noexcept;
+
+	bool try_push(const T& value);  // false if full
+	bool try_pop(T& value);         // false if empty
+};
+
+struct stage_stats
+{
+	std::string name;
+	size_t slabs;           // processed
+	size_t stalls;          // times the stage waited for a slab
+	double busy_seconds;    // in the stage's function
+	double stalled_seconds; // waiting for a slab
+
+	double slabs_per_second() const;  // while busy
+};
+
+// Stages on their own threads, passing slabs of a fixed bounds from a pool between them
+template <typename T, size_t Rank = 1>
+class slab_pipeline
+{
+public:
+	slab_pipeline(const bounds<Rank>& slab_bounds, size_t slabs);
+
+	// The first stage fills each slab, returning false when there are no more
+	slab_pipeline& source(std::string name, std::function<bool(array_view<T, Rank>)> fn);
+	// Later stages process each slab in turn, in place
+	slab_pipeline& stage(std::string name, std::function<void(array_view<T, Rank>)> fn);
+
+	// Runs the stages to completion
+	void run();
+
+	const std::vector<stage_stats>& stats() const noexcept;
+};
+*/
+
+namespace av
+{
+
+// Each index is written by one thread and read by the other.  Each thread also keeps a copy of the
+// other's index, refreshed only when the ring appears full (or empty), so that the cache line of
+// the other's index is touched rarely.
+template <typename T>
+class spsc_ring
+{
+public:
+	explicit spsc_ring(size_t capacity)
+	{
+		size_t rounded = 1;
+		while (rounded < capacity) rounded *= 2;
+		slots_.resize(rounded);
+		mask_ = rounded - 1;
+	}
+
+	size_t capacity() const noexcept { return slots_.size(); }
+
+	bool try_push(const T& value)
+	{
+		const size_t tail = producer_.index.load(std::memory_order_relaxed);
+		if (tail - producer_.cached_other == slots_.size())
+		{
+			producer_.cached_other = consumer_.index.load(std::memory_order_acquire);
+			if (tail - producer_.cached_other == slots_.size()) return false;
+		}
+		slots_[tail & mask_] = value;
+		producer_.index.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool try_pop(T& value)
+	{
+		const size_t head = consumer_.index.load(std::memory_order_relaxed);
+		if (head == consumer_.cached_other)
+		{
+			consumer_.cached_other = producer_.index.load(std::memory_order_acquire);
+			if (head == consumer_.cached_other) return false;
+		}
+		value = slots_[head & mask_];
+		consumer_.index.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	// Padded to keep the ends on separate cache lines (without over-aligning the ring, which C++14
+	// cannot allocate)
+	struct end
+	{
+		std::atomic<size_t> index{0};
+		size_t cached_other = 0;
+		char padding[AV_CACHE_LINE_SIZE];
+	};
+
+	std::vector<T> slots_;
+	size_t mask_ = 0;
+	end producer_;
+	end consumer_;
+};
+
+struct stage_stats
+{
+	std::string name;
+	size_t slabs = 0;
+	size_t stalls = 0;
+	double busy_seconds = 0.0;
+	double stalled_seconds = 0.0;
+
+	double slabs_per_second() const
+	{ return busy_seconds > 0.0 ? double(slabs) / busy_seconds : 0.0; }
+};
+
+// A chain of stages, each on its own thread, passing slabs between them in order.  The slabs come
+// from a pool allocated up front and return to the source once the last stage is done with them, so
+// the number of slabs in flight (and so the memory used) is bounded: a source that runs ahead
+// stalls until a slab is free.  Stages are connected by single-producer/single-consumer rings of
+// slab indices, so there is no allocation or locking once running.  Waiting stages spin briefly,
+// then yield.
+template <typename T, size_t Rank = 1>
+class slab_pipeline
+{
+public:
+	slab_pipeline(const bounds<Rank>& slab_bounds, size_t slabs)
+		: slab_bounds_(slab_bounds), slabs_(slabs), pool_(slabs * slab_bounds.size())
+	{
+		assert(slabs > 0);
+	}
+
+	slab_pipeline& source(std::string name, std::function<bool(array_view<T, Rank>)> fn)
+	{
+		assert(!source_ && "A pipeline has a single source");
+		source_ = std::move(fn);
+		stats_.insert(stats_.begin(), stage_stats{});
+		stats_.front().name = std::move(name);
+		return *this;
+	}
+
+	slab_pipeline& stage(std::string name, std::function<void(array_view<T, Rank>)> fn)
+	{
+		stages_.push_back(std::move(fn));
+		stats_.push_back(stage_stats{});
+		stats_.back().name = std::move(name);
+		return *this;
+	}
+
+	void run()
+	{
+		assert(source_ && "A pipeline requires a source");
+
+		// rings_[0] returns free slabs to the source, rings_[i] feeds stage i
+		const size_t n = stages_.size() + 1;
+		std::vector<std::unique_ptr<spsc_ring<size_t>>> rings;
+		for (size_t i=0; i<n; ++i) {
+			rings.emplace_back(new spsc_ring<size_t>(slabs_));
+		}
+		for (size_t slab=0; slab<slabs_; ++slab) {
+			rings[0]->try_push(slab);
+		}
+
+		for (stage_stats& stats : stats_)
+		{
+			const std::string name = stats.name;
+			stats = stage_stats{};
+			stats.name = name;
+		}
+
+		std::vector<std::thread> threads;
+		threads.emplace_back([&] {
+			run_stage(stats_[0], *rings[0], *rings[1 % n], n == 1, [&](array_view<T, Rank> slab) {
+				return source_(slab);
+			});
+		});
+		for (size_t i=1; i<n; ++i) {
+			threads.emplace_back([&, i] {
+				run_stage(stats_[i], *rings[i], *rings[(i + 1) % n], i == n-1, [&](array_view<T, Rank> slab) {
+					stages_[i-1](slab);
+					return true;
+				});
+			});
+		}
+		for (std::thread& thread : threads) {
+			thread.join();
+		}
+	}
+
+	// Valid once `run` has returned
+	const std::vector<stage_stats>& stats() const noexcept { return stats_; }
+
+private:
+	static constexpr size_t end_of_stream = ~size_t{0};
+
+	array_view<T, Rank> slab(size_t index)
+	{ return array_view<T, Rank>(pool_.data() + index * slab_bounds_.size(), slab_bounds_); }
+
+	static size_t pop(spsc_ring<size_t>& ring, stage_stats& stats)
+	{
+		using clock = std::chrono::steady_clock;
+
+		size_t index;
+		if (ring.try_pop(index)) return index;
+
+		++stats.stalls;
+		const clock::time_point start = clock::now();
+		for (unsigned spins=0; !ring.try_pop(index); ++spins) {
+			if (spins >= 64) std::this_thread::yield();
+		}
+		stats.stalled_seconds += std::chrono::duration<double>(clock::now() - start).count();
+		return index;
+	}
+
+	// Rings are as large as the pool, so pushing never waits
+	static void push(spsc_ring<size_t>& ring, size_t index)
+	{
+		const bool pushed = ring.try_push(index);
+		assert(pushed);
+		(void)pushed;
+	}
+
+	// Processes slabs from `in` to `out` until the end of the stream, which the source marks when
+	// `fn` returns false, and other stages pass on when they see it.  The last stage returns slabs
+	// to the source, which has no further need of them at the end.
+	template <typename Fn>
+	void run_stage(stage_stats& stats, spsc_ring<size_t>& in, spsc_ring<size_t>& out, bool last, Fn fn)
+	{
+		using clock = std::chrono::steady_clock;
+
+		for (;;)
+		{
+			const size_t index = pop(in, stats);
+			if (index == end_of_stream) break;
+
+			const clock::time_point start = clock::now();
+			const bool more = fn(slab(index));
+			stats.busy_seconds += std::chrono::duration<double>(clock::now() - start).count();
+			if (!more) break;
+
+			++stats.slabs;
+			push(out, index);
+		}
+
+		if (!last) push(out, end_of_stream);
+	}
+
+	bounds<Rank> slab_bounds_;
+	size_t slabs_;
+	std::vector<T> pool_;
+	std::function<bool(array_view<T, Rank>)> source_;
+	std::vector<std::function<void(array_view<T, Rank>)>> stages_;
+	std::vector<stage_stats> stats_;
+};
+
+}
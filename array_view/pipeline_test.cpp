@@ -0,0 +1,125 @@
+#include "array_view/pipeline.h"
+
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace av;
+
+TEST(spsc_ring_test, Capacity)
+{
+	spsc_ring<int> ring(5);
+	EXPECT_EQ(8u, ring.capacity());
+
+	int value = 0;
+	EXPECT_FALSE(ring.try_pop(value));
+	for (int i=0; i<8; ++i) EXPECT_TRUE(ring.try_push(i));
+	EXPECT_FALSE(ring.try_push(8));
+
+	for (int i=0; i<8; ++i)
+	{
+		ASSERT_TRUE(ring.try_pop(value));
+		EXPECT_EQ(i, value);
+	}
+	EXPECT_FALSE(ring.try_pop(value));
+}
+
+TEST(spsc_ring_test, Concurrent)
+{
+	// Values arrive once each, in order
+	const int n = 200000;
+	spsc_ring<int> ring(64);
+
+	thread producer([&] {
+		for (int i=0; i<n; ++i) {
+			while (!ring.try_push(i)) this_thread::yield();
+		}
+	});
+
+	int expected = 0;
+	while (expected < n)
+	{
+		int value;
+		if (!ring.try_pop(value)) {
+			this_thread::yield();
+			continue;
+		}
+		ASSERT_EQ(expected, value);
+		++expected;
+	}
+	producer.join();
+}
+
+TEST(slab_pipeline_test, LoadFilterReduce)
+{
+	// Slabs of rows of a 2D array, through a pool smaller than their number
+	const ptrdiff_t rows = 1000, columns = 64, slab_rows = 16;
+	vector<int> input(rows * columns);
+	iota(input.begin(), input.end(), 0);
+
+	slab_pipeline<int, 2> pipeline({slab_rows, columns}, 3);
+
+	ptrdiff_t next_row = 0;
+	vector<ptrdiff_t> filled_rows;
+	long long sum = 0;
+	size_t reduced = 0;
+
+	pipeline
+		.source("load", [&](array_view<int, 2> slab) {
+			if (next_row >= rows) return false;
+
+			// The last slab is partial, and padded with zeros
+			const ptrdiff_t n = min(slab_rows, rows - next_row);
+			for (ptrdiff_t i=0; i<slab_rows; ++i) {
+				for (ptrdiff_t j=0; j<columns; ++j) {
+					slab[{i,j}] = i < n ? input[(next_row + i) * columns + j] : 0;
+				}
+			}
+			filled_rows.push_back(n);
+			next_row += n;
+			return true;
+		})
+		.stage("filter", [](array_view<int, 2> slab) {
+			for (const offset<2>& idx : slab.bounds()) slab[idx] *= 2;
+		})
+		.stage("reduce", [&](array_view<int, 2> slab) {
+			for (const offset<2>& idx : slab.bounds()) sum += slab[idx];
+			++reduced;
+		});
+
+	pipeline.run();
+
+	const long long n = rows * columns;
+	EXPECT_EQ(n * (n - 1), sum);
+	EXPECT_EQ(filled_rows.size(), reduced);
+
+	const vector<stage_stats>& stats = pipeline.stats();
+	ASSERT_EQ(3u, stats.size());
+	EXPECT_EQ("load", stats[0].name);
+	EXPECT_EQ("reduce", stats[2].name);
+	for (const stage_stats& stage : stats)
+	{
+		EXPECT_EQ(reduced, stage.slabs);
+		EXPECT_GE(stage.busy_seconds, 0.0);
+		EXPECT_GE(stage.stalled_seconds, 0.0);
+	}
+
+	// Running again starts afresh
+	next_row = 0;
+	sum = 0;
+	pipeline.run();
+	EXPECT_EQ(n * (n - 1), sum);
+	EXPECT_EQ(reduced, pipeline.stats()[1].slabs * 2);
+}
+
+TEST(slab_pipeline_test, SourceOnly)
+{
+	slab_pipeline<float> pipeline({8}, 2);
+	int count = 0;
+	pipeline.source("count", [&](array_view<float>) { return ++count <= 10; });
+	pipeline.run();
+	EXPECT_EQ(10u, pipeline.stats()[0].slabs);
+}
@@ -0,0 +1,410 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+#include "array_view.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*
+enum class filter
+{
+	nearest,  // the element nearest to the coordinates
+	linear    // linear in each dimension: bilinear in 2D, trilinear in 3D
+};
+
+// Where the taps of a sample fall outside the view
+enum class boundary
+{
+	clamp,    // the nearest element on the edge
+	wrap,     // the view repeats
+	mirror,   // the view repeats, reflected at each edge (so the edge elements are repeated)
+	constant  // the border value
+};
+
+// Interpolates between the elements of a view at fractional coordinates, where coordinates equal
+// to an index are exactly the element there
+template <typename T, size_t Rank>
+class sampler
+{
+public:
+	sampler(const strided_array_view<const T, Rank>& view, filter f = filter::linear,
+	        boundary b = boundary::clamp, T border = T{});
+
+	// observers
+	strided_array_view<const T, Rank> view() const noexcept;
+	filter   filtering() const noexcept;
+	boundary boundary_policy() const noexcept;
+
+	// One sample, at coordinates in the order of the dimensions of the view
+	T operator()(const float (&coords)[Rank]) const;
+
+	// A sample for each row of `coords`, of bounds {n, Rank}, into `out`, of bounds {n}
+	void operator()(const strided_array_view<const float, 2>& coords, const strided_array_view<T, 1>& out) const;
+};
+*/
+
+namespace av
+{
+
+enum class filter
+{
+	nearest,
+	linear
+};
+
+enum class boundary
+{
+	clamp,
+	wrap,
+	mirror,
+	constant
+};
+
+namespace {
+
+	// The index of a tap in a dimension of `n` elements, as a whole number, under `policy`, and
+	// whether the tap lies within the view.  Indices are clamped last of all, which also takes
+	// NaNs to 0, so that no coordinates read outside the view.
+	inline float bound_tap(float i, float n, boundary policy, bool& inside)
+	{
+		inside = true;
+		switch (policy)
+		{
+		case boundary::clamp:
+			break;
+		case boundary::wrap:
+			i -= n * std::floor(i / n);
+			break;
+		case boundary::mirror:
+			i -= 2 * n * std::floor(i / (2 * n));
+			if (i >= n) i = 2 * n - 1 - i;
+			break;
+		case boundary::constant:
+			inside = i >= 0 && i <= n - 1;
+			break;
+		}
+		return !(i > 0) ? 0 : (i > n - 1 ? n - 1 : i);
+	}
+
+	// Taps are the elements that a sample is interpolated from, one in each dimension for nearest
+	// and two for linear, with the weight and element offset of each
+	template <size_t Rank>
+	struct sample_taps
+	{
+		std::ptrdiff_t offset[Rank][2];
+		float          weight[Rank][2];
+		bool           inside[Rank][2];
+	};
+
+	template <typename T, size_t Rank>
+	T sample_one(const strided_array_view<const T, Rank>& view, const float* x, filter f, boundary policy, T border)
+	{
+		const size_t taps = f == filter::nearest ? 1 : 2;
+
+		sample_taps<Rank> s;
+		for (size_t dim=0; dim<Rank; ++dim)
+		{
+			const float n = float(view.bounds()[dim]);
+			const float first = std::floor(f == filter::nearest ? x[dim] + 0.5f : x[dim]);
+			const float frac = x[dim] - first;
+			for (size_t k=0; k<taps; ++k)
+			{
+				const float i = bound_tap(first + float(k), n, policy, s.inside[dim][k]);
+				s.offset[dim][k] = std::ptrdiff_t(i) * view.stride()[dim];
+			}
+			s.weight[dim][0] = f == filter::nearest ? 1.f : 1.f - frac;
+			s.weight[dim][1] = frac;
+		}
+
+		T result = 0;
+		for (size_t tap=0; tap<(size_t(1) << (Rank * (taps - 1))); ++tap)
+		{
+			std::ptrdiff_t off = 0;
+			float weight = 1;
+			bool inside = true;
+			for (size_t dim=0; dim<Rank; ++dim)
+			{
+				const size_t k = (tap >> dim) & (taps - 1);
+				off += s.offset[dim][k];
+				weight *= s.weight[dim][k];
+				inside = inside && s.inside[dim][k];
+			}
+			result += T(weight) * (inside ? view.data()[off] : border);
+		}
+		return result;
+	}
+
+#if defined(__AVX2__)
+
+	// The operations of the batched sampler, over a register of floats and one of int32 offsets,
+	// for the widest vectors available.  Masks are registers of all ones or zeros (AVX2) or mask
+	// registers (AVX-512).
+#if defined(__AVX512F__)
+	struct sample_lanes
+	{
+		static constexpr std::ptrdiff_t width = 16;
+		using vf   = __m512;
+		using vi   = __m512i;
+		using mask = __mmask16;
+
+		static vf   set(float x) { return _mm512_set1_ps(x); }
+		static vi   set(int x) { return _mm512_set1_epi32(x); }
+		static vi   lane_ids() { return _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15); }
+		static vf   floor(vf x) { return _mm512_roundscale_ps(x, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+		static vf   add(vf a, vf b) { return _mm512_add_ps(a, b); }
+		static vf   sub(vf a, vf b) { return _mm512_sub_ps(a, b); }
+		static vf   mul(vf a, vf b) { return _mm512_mul_ps(a, b); }
+		static vf   div(vf a, vf b) { return _mm512_div_ps(a, b); }
+		static vf   min(vf a, vf b) { return _mm512_min_ps(a, b); }
+		static vf   max(vf a, vf b) { return _mm512_max_ps(a, b); }
+		static mask ge(vf a, vf b) { return _mm512_cmp_ps_mask(a, b, _CMP_GE_OQ); }
+		static mask le(vf a, vf b) { return _mm512_cmp_ps_mask(a, b, _CMP_LE_OQ); }
+		static mask all() { return mask(0xffff); }
+		static mask both(mask a, mask b) { return mask(a & b); }
+		static vf   select(mask m, vf a, vf b) { return _mm512_mask_blend_ps(m, b, a); }
+		static vi   to_int(vf x) { return _mm512_cvttps_epi32(x); }
+		static vi   add(vi a, vi b) { return _mm512_add_epi32(a, b); }
+		static vi   mul(vi a, vi b) { return _mm512_mullo_epi32(a, b); }
+		static vf   gather(const float* base, vi off) { return _mm512_i32gather_ps(off, base, 4); }
+		static vf   load(const float* p) { return _mm512_loadu_ps(p); }
+		static void store(float* p, vf v) { _mm512_storeu_ps(p, v); }
+	};
+#else
+	struct sample_lanes
+	{
+		static constexpr std::ptrdiff_t width = 8;
+		using vf   = __m256;
+		using vi   = __m256i;
+		using mask = __m256;
+
+		static vf   set(float x) { return _mm256_set1_ps(x); }
+		static vi   set(int x) { return _mm256_set1_epi32(x); }
+		static vi   lane_ids() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+		static vf   floor(vf x) { return _mm256_floor_ps(x); }
+		static vf   add(vf a, vf b) { return _mm256_add_ps(a, b); }
+		static vf   sub(vf a, vf b) { return _mm256_sub_ps(a, b); }
+		static vf   mul(vf a, vf b) { return _mm256_mul_ps(a, b); }
+		static vf   div(vf a, vf b) { return _mm256_div_ps(a, b); }
+		static vf   min(vf a, vf b) { return _mm256_min_ps(a, b); }
+		static vf   max(vf a, vf b) { return _mm256_max_ps(a, b); }
+		static mask ge(vf a, vf b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+		static mask le(vf a, vf b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+		static mask all() { return _mm256_castsi256_ps(_mm256_set1_epi32(-1)); }
+		static mask both(mask a, mask b) { return _mm256_and_ps(a, b); }
+		static vf   select(mask m, vf a, vf b) { return _mm256_blendv_ps(b, a, m); }
+		static vi   to_int(vf x) { return _mm256_cvttps_epi32(x); }
+		static vi   add(vi a, vi b) { return _mm256_add_epi32(a, b); }
+		static vi   mul(vi a, vi b) { return _mm256_mullo_epi32(a, b); }
+		static vf   gather(const float* base, vi off) { return _mm256_i32gather_ps(base, off, 4); }
+		static vf   load(const float* p) { return _mm256_loadu_ps(p); }
+		static void store(float* p, vf v) { _mm256_storeu_ps(p, v); }
+	};
+#endif
+
+	// As bound_tap, for a register of taps
+	template <typename L>
+	typename L::vf bound_taps(typename L::vf i, float extent, boundary policy, typename L::mask& inside)
+	{
+		const typename L::vf zero = L::set(0.f);
+		const typename L::vf n = L::set(extent);
+		const typename L::vf last = L::set(extent - 1);
+
+		inside = L::all();
+		switch (policy)
+		{
+		case boundary::clamp:
+			break;
+		case boundary::wrap:
+			i = L::sub(i, L::mul(n, L::floor(L::div(i, n))));
+			break;
+		case boundary::mirror:
+		{
+			const typename L::vf period = L::set(2 * extent);
+			i = L::sub(i, L::mul(period, L::floor(L::div(i, period))));
+			i = L::select(L::ge(i, n), L::sub(L::sub(period, L::set(1.f)), i), i);
+			break;
+		}
+		case boundary::constant:
+			inside = L::both(L::ge(i, zero), L::le(i, last));
+			break;
+		}
+		return L::min(L::max(i, zero), last);
+	}
+
+	// Samples `n` sets of coordinates, a register at a time, where coords[dim] points to the first
+	// coordinate in dimension `dim` and successive coordinates are `coord_stride` apart.  Returns
+	// the number sampled, which is a multiple of the width.
+	template <typename L, size_t Rank>
+	std::ptrdiff_t sample_batches(const strided_array_view<const float, Rank>& view, const float* const* coords,
+	                              std::ptrdiff_t coord_stride, float* out, std::ptrdiff_t out_stride, std::ptrdiff_t n,
+	                              filter f, boundary policy, float border)
+	{
+		using vf = typename L::vf;
+		using vi = typename L::vi;
+		constexpr std::ptrdiff_t w = L::width;
+		const size_t taps = f == filter::nearest ? 1 : 2;
+		const vi coord_offsets = L::mul(L::lane_ids(), L::set(int(coord_stride)));
+
+		std::ptrdiff_t i = 0;
+		for (; i+w<=n; i+=w)
+		{
+			vi offset[Rank][2];
+			vf weight[Rank][2];
+			typename L::mask inside[Rank][2];
+			for (size_t dim=0; dim<Rank; ++dim)
+			{
+				const float* first_coord = coords[dim] + i * coord_stride;
+				const vf x = coord_stride == 1 ? L::load(first_coord) : L::gather(first_coord, coord_offsets);
+				const vf first = L::floor(f == filter::nearest ? L::add(x, L::set(0.5f)) : x);
+				const vf frac = L::sub(x, first);
+				for (size_t k=0; k<taps; ++k)
+				{
+					const vf tap = bound_taps<L>(L::add(first, L::set(float(k))), float(view.bounds()[dim]), policy, inside[dim][k]);
+					offset[dim][k] = L::mul(L::to_int(tap), L::set(int(view.stride()[dim])));
+				}
+				weight[dim][0] = f == filter::nearest ? L::set(1.f) : L::sub(L::set(1.f), frac);
+				weight[dim][1] = frac;
+			}
+
+			vf result = L::set(0.f);
+			for (size_t tap=0; tap<(size_t(1) << (Rank * (taps - 1))); ++tap)
+			{
+				vi off = L::set(0);
+				vf tap_weight = L::set(1.f);
+				typename L::mask tap_inside = L::all();
+				for (size_t dim=0; dim<Rank; ++dim)
+				{
+					const size_t k = (tap >> dim) & (taps - 1);
+					off = L::add(off, offset[dim][k]);
+					tap_weight = L::mul(tap_weight, weight[dim][k]);
+					tap_inside = L::both(tap_inside, inside[dim][k]);
+				}
+
+				vf value = L::gather(view.data(), off);
+				if (policy == boundary::constant) value = L::select(tap_inside, value, L::set(border));
+				result = L::add(result, L::mul(tap_weight, value));
+			}
+
+			if (out_stride == 1) {
+				L::store(out + i, result);
+			}
+			else
+			{
+				float lanes[w];
+				L::store(lanes, result);
+				for (std::ptrdiff_t lane=0; lane<w; ++lane) out[(i + lane) * out_stride] = lanes[lane];
+			}
+		}
+		return i;
+	}
+
+#endif
+
+	// Whether the element offsets of a view, and the coordinates of a batch, fit the int32 lanes of
+	// a gather
+	template <typename T, size_t Rank>
+	bool fits_gather(const strided_array_view<const T, Rank>& view, std::ptrdiff_t coord_stride)
+	{
+		const std::ptrdiff_t limit = std::numeric_limits<std::int32_t>::max();
+		std::ptrdiff_t extent = 0;
+		for (size_t dim=0; dim<Rank; ++dim)
+		{
+			const std::ptrdiff_t stride = view.stride()[dim] < 0 ? -view.stride()[dim] : view.stride()[dim];
+			if (view.bounds()[dim] > 0 && stride > limit / view.bounds()[dim]) return false;
+			extent += (view.bounds()[dim] - 1) * stride;
+			if (extent > limit) return false;
+		}
+		return coord_stride >= 0 && coord_stride <= limit / 16;
+	}
+
+} // namespace
+
+// Each batch computes the taps of a register of samples at once, with the offsets of the taps in
+// int32 lanes, and fetches the elements at them with gathers.  Float views whose offsets fit in
+// int32 take this path where AVX2 is available, and the remainder of a batch (and other views)
+// are sampled one at a time.
+template <typename T, size_t Rank>
+class sampler
+{
+public:
+	static_assert(std::is_floating_point<T>::value, "Elements to interpolate must be floating point");
+
+	sampler(const strided_array_view<const T, Rank>& view, filter f = filter::linear,
+	        boundary b = boundary::clamp, T border = T{})
+		: view_(view), filter_(f), boundary_(b), border_(border)
+	{
+		assert(view.size() > 0 && "Cannot sample an empty view");
+	}
+
+	// observers
+	strided_array_view<const T, Rank> view() const noexcept { return view_; }
+	filter   filtering() const noexcept { return filter_; }
+	boundary boundary_policy() const noexcept { return boundary_; }
+
+	T operator()(const float (&coords)[Rank]) const
+	{
+		return sample_one(view_, coords, filter_, boundary_, border_);
+	}
+
+	void operator()(const strided_array_view<const float, 2>& coords, const strided_array_view<T, 1>& out) const
+	{
+		assert(coords.bounds()[1] == std::ptrdiff_t(Rank) && coords.bounds()[0] == out.bounds()[0]);
+
+		const std::ptrdiff_t n = out.bounds()[0];
+		if (n == 0) return;
+
+		const float* columns[Rank];
+		for (size_t dim=0; dim<Rank; ++dim) columns[dim] = &coords[{0, std::ptrdiff_t(dim)}];
+		const std::ptrdiff_t coord_stride = coords.stride()[0];
+		const std::ptrdiff_t out_stride = out.stride()[0];
+
+		std::ptrdiff_t i = sample_vectorized(columns, coord_stride, out.data(), out_stride, n, std::is_same<T, float>{});
+		for (; i<n; ++i)
+		{
+			float x[Rank];
+			for (size_t dim=0; dim<Rank; ++dim) x[dim] = columns[dim][i * coord_stride];
+			out.data()[i * out_stride] = sample_one(view_, x, filter_, boundary_, border_);
+		}
+	}
+
+private:
+	std::ptrdiff_t sample_vectorized(const float* const*, std::ptrdiff_t, T*, std::ptrdiff_t, std::ptrdiff_t, std::false_type) const
+	{
+		return 0;
+	}
+
+	// The number of samples taken, from the first
+	std::ptrdiff_t sample_vectorized(const float* const* columns, std::ptrdiff_t coord_stride, float* out,
+	                                 std::ptrdiff_t out_stride, std::ptrdiff_t n, std::true_type) const
+	{
+	#if defined(__AVX2__)
+		if (fits_gather(view_, coord_stride)) {
+			return sample_batches<sample_lanes>(view_, columns, coord_stride, out, out_stride, n, filter_, boundary_, border_);
+		}
+	#else
+		(void)columns; (void)coord_stride; (void)out; (void)out_stride; (void)n;
+	#endif
+		return 0;
+	}
+
+	strided_array_view<const T, Rank> view_;
+	filter   filter_;
+	boundary boundary_;
+	T        border_;
+};
+
+}
@@ -0,0 +1,112 @@
+#include "array_view/sampler.h"
+
+#include <cmath>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace av;
+
+TEST(sampler_test, Nearest)
+{
+	vector<float> vec = {0, 1, 2,
+	                     3, 4, 5};
+	const array_view<float, 2> image(vec, {2, 3});
+	const sampler<float, 2> s(image, filter::nearest);
+
+	EXPECT_EQ(4.f, s({1.f, 1.f}));
+	EXPECT_EQ(4.f, s({0.6f, 1.4f}));
+	EXPECT_EQ(2.f, s({0.4f, 1.6f}));
+	EXPECT_EQ(5.f, s({9.f, 9.f}));  // clamped
+}
+
+TEST(sampler_test, Linear)
+{
+	vector<float> vec = {0, 1, 2,
+	                     3, 4, 5};
+	const array_view<float, 2> image(vec, {2, 3});
+	const sampler<float, 2> s(image);
+
+	// Coordinates at an index are the element there, and between elements are the weighted mean
+	EXPECT_FLOAT_EQ(4.f, s({1.f, 1.f}));
+	EXPECT_FLOAT_EQ(0.5f, s({0.f, 0.5f}));
+	EXPECT_FLOAT_EQ(2.f, s({0.5f, 0.5f}));
+	EXPECT_FLOAT_EQ(0.25f * 1 + 0.75f * 4 + 0.25f, s({0.75f, 1.25f}));
+
+	// Trilinear, of a linear function, is exact
+	vector<double> volume(4 * 5 * 6);
+	const array_view<double, 3> v(volume, {4, 5, 6});
+	for (const offset<3>& idx : v.bounds()) v[idx] = 2. * idx[0] - 3. * idx[1] + 0.5 * idx[2];
+	const sampler<double, 3> trilinear(v);
+	EXPECT_NEAR(2. * 1.25 - 3. * 3.5 + 0.5 * 4.75, trilinear({1.25f, 3.5f, 4.75f}), 1e-6);
+}
+
+TEST(sampler_test, Boundaries)
+{
+	vector<float> vec = {1, 2, 3, 4};
+	const array_view<float, 2> row(vec, {1, 4});
+
+	auto at = [&](boundary b, float x) { return sampler<float, 2>(row, filter::nearest, b, -1.f)({0.f, x}); };
+	EXPECT_EQ(1.f, at(boundary::clamp, -2));
+	EXPECT_EQ(4.f, at(boundary::clamp, 7));
+	EXPECT_EQ(3.f, at(boundary::wrap, -2));
+	EXPECT_EQ(4.f, at(boundary::wrap, 7));
+	EXPECT_EQ(2.f, at(boundary::mirror, -2));   // 2 1 | 1 2 3 4 | 4 3
+	EXPECT_EQ(3.f, at(boundary::mirror, 5));
+	EXPECT_EQ(1.f, at(boundary::mirror, 8));
+	EXPECT_EQ(-1.f, at(boundary::constant, -1));
+	EXPECT_EQ(4.f, at(boundary::constant, 3));
+
+	// A linear sample half outside takes half the border
+	const sampler<float, 2> border(row, filter::linear, boundary::constant, 0.f);
+	EXPECT_FLOAT_EQ(2.f, border({0.f, 3.5f}));
+
+	// NaNs read inside the view
+	const float nan = numeric_limits<float>::quiet_NaN();
+	EXPECT_EQ(1.f, at(boundary::clamp, nan));
+}
+
+// Batches match single samples, for every filter and boundary, contiguous or strided views and
+// coordinates (including those of each dimension contiguous, which are loaded rather than gathered),
+// and any remainder of a batch.  Built with AVX2, as av_avx2_test, so the vector path is compared.
+template <typename T>
+void test_batches()
+{
+	vector<T> vec(13 * 17 * 2);
+	for (size_t i=0; i<vec.size(); ++i) vec[i] = T(std::sin(double(i)));
+	const array_view<T, 3> whole(vec, {13, 17, 2});
+	const strided_array_view<T, 2> strided = whole.template slice<2>(1);
+
+	const ptrdiff_t n = 101;
+	vector<float> coords(size_t(n) * 3);
+	for (size_t i=0; i<coords.size(); ++i) coords[i] = float(std::fmod(double(i) * 7.31, 24.0)) - 4.f;
+	const array_view<const float, 2> rows(coords.data(), {n, 2});                                 // contiguous
+	const strided_array_view<const float, 2> wide(coords.data(), {n, 2}, {3, 1});                  // strided
+	const strided_array_view<const float, 2> columns(coords.data(), {n, 2}, {1, n});               // by dimension
+
+	for (filter f : {filter::nearest, filter::linear}) {
+		for (boundary b : {boundary::clamp, boundary::wrap, boundary::mirror, boundary::constant}) {
+			for (const strided_array_view<const T, 2>& view : {strided_array_view<const T, 2>(whole[1]), strided_array_view<const T, 2>(strided)})
+			{
+				const sampler<T, 2> s(view, f, b, T(7));
+				for (const strided_array_view<const float, 2>& c : {strided_array_view<const float, 2>(rows), wide, columns})
+				{
+					vector<T> out(size_t(n) * 2);
+					s(c, strided_array_view<T, 1>(out.data(), {n}, {2}));
+					for (ptrdiff_t i=0; i<n; ++i)
+					{
+						const float x[2] = {c[{i, 0}], c[{i, 1}]};
+						ASSERT_NEAR(double(s(x)), double(out[size_t(i) * 2]), 1e-5) << "sample " << i;
+					}
+				}
+			}
+		}
+	}
+}
+
+TEST(sampler_test, Batches)
+{
+	test_batches<float>();
+	test_batches<double>();
+}
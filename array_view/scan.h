@@ -0,0 +1,260 @@
+/*
+ * array_view -- https://github.com/wardw/array_view
+ *
+ * Copyright (c) 2015, Tom Ward - All rights reserved.
+ * BSD 2-clause “Simplified” License
+ *
+ * See array_view.h for the full license text.
+ */
+
+#pragma once
+
+#include "array_view.h"
+#include "parallel.h"
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/*
+// Writes to each element of `dst` the sum of the elements of `src` up to and including the same
+// index along dimension Dim, using up to `threads` threads.  dst may be src.
+template <size_t Dim, typename SrcView, typename DstView>
+void inclusive_scan(const SrcView& src, const DstView& dst, unsigned threads = 0);
+
+// As above, with each sum excluding the element at the index itself, and starting from `init`
+template <size_t Dim, typename SrcView, typename DstView>
+void exclusive_scan(const SrcView& src, const DstView& dst, typename DstView::value_type init = {}, unsigned threads = 0);
+*/
+
+namespace av
+{
+
+namespace {
+
+	// Views of rank 1 of at least this many elements are scanned in parallel
+	constexpr std::ptrdiff_t scan_parallel_threshold = std::ptrdiff_t{1} << 20;
+
+	// Scans `n` elements from `in` to `out`, continuing from the running sum `carry`, and returns the
+	// sum at the end
+	template <typename T>
+	T scan_row_serial(const T* in, std::ptrdiff_t in_stride, T* out, std::ptrdiff_t out_stride,
+	                  std::ptrdiff_t n, T carry, bool inclusive)
+	{
+		for (std::ptrdiff_t i=0; i<n; ++i)
+		{
+			const T value = in[i * in_stride];
+			if (inclusive) {
+				carry += value;
+				out[i * out_stride] = carry;
+			}
+			else {
+				out[i * out_stride] = carry;
+				carry += value;
+			}
+		}
+		return carry;
+	}
+
+	// Elements that scan a vector register at a time, as four or two lanes of 128 bits
+	template <typename T>
+	struct is_vector_scannable : std::integral_constant<bool,
+	#if defined(__SSE2__)
+		std::is_same<T, float>::value || std::is_same<T, double>::value ||
+		(std::is_integral<T>::value && !std::is_same<T, bool>::value && (sizeof(T) == 4 || sizeof(T) == 8))
+	#else
+		false
+	#endif
+		> {};
+
+	template <typename T>
+	T scan_contiguous(const T* in, T* out, std::ptrdiff_t n, T carry, bool inclusive, std::false_type)
+	{
+		return scan_row_serial(in, 1, out, 1, n, carry, inclusive);
+	}
+
+#if defined(__SSE2__)
+	template <typename T>
+	__m128i add_lanes(__m128i a, __m128i b)
+	{
+		return std::is_same<T, float>::value  ? _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))) :
+		       std::is_same<T, double>::value ? _mm_castpd_si128(_mm_add_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))) :
+		       sizeof(T) == 4                 ? _mm_add_epi32(a, b) : _mm_add_epi64(a, b);
+	}
+
+	// The last lane of `v` in every lane
+	template <typename T>
+	__m128i broadcast_last(__m128i v)
+	{
+		return sizeof(T) == 4 ? _mm_shuffle_epi32(v, 0xff) : _mm_shuffle_epi32(v, 0xee);
+	}
+
+	// A register at a time, by summing each lane with those shifted up by one lane, then by two,
+	// so that only the add of the carry is serial from one register to the next
+	template <typename T>
+	T scan_contiguous(const T* in, T* out, std::ptrdiff_t n, T carry, bool inclusive, std::true_type)
+	{
+		constexpr std::ptrdiff_t w = 16 / sizeof(T);
+
+		T carry_lanes[w];
+		for (T& lane : carry_lanes) lane = carry;
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(carry_lanes));
+
+		std::ptrdiff_t i = 0;
+		for (; i+w<=n; i+=w)
+		{
+			__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+			x = add_lanes<T>(x, _mm_slli_si128(x, sizeof(T)));
+			if (w == 4) x = add_lanes<T>(x, _mm_slli_si128(x, 8));
+
+			const __m128i sums = add_lanes<T>(x, c);
+			const __m128i result = inclusive ? sums : add_lanes<T>(_mm_slli_si128(x, sizeof(T)), c);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), result);
+			c = broadcast_last<T>(sums);
+		}
+
+		std::memcpy(&carry, &c, sizeof(T));
+		return scan_row_serial(in + i, 1, out + i, 1, n - i, carry, inclusive);
+	}
+#endif
+
+	template <typename T>
+	T scan_row(const T* in, std::ptrdiff_t in_stride, T* out, std::ptrdiff_t out_stride,
+	           std::ptrdiff_t n, T carry, bool inclusive)
+	{
+		if (in_stride == 1 && out_stride == 1) return scan_contiguous(in, out, n, carry, inclusive, is_vector_scannable<T>{});
+		return scan_row_serial(in, in_stride, out, out_stride, n, carry, inclusive);
+	}
+
+	// Scans along an outer dimension, a row of the innermost at a time, so that each step adds one
+	// row to the running sums of all the independent lines it crosses
+	template <size_t Dim, typename T, size_t Rank>
+	void scan_outer(const strided_array_view<const T, Rank>& src, const strided_array_view<T, Rank>& dst,
+	                T init, bool inclusive)
+	{
+		const bounds<Rank> b = src.bounds();
+		const std::ptrdiff_t n = b[Rank-1];
+		const std::ptrdiff_t in_stride = src.stride()[Rank-1];
+		const std::ptrdiff_t out_stride = dst.stride()[Rank-1];
+		if (b.size() == 0) return;
+
+		std::vector<T> sums(static_cast<size_t>(n));
+
+		bounds<Rank> lines{b};
+		lines[Dim] = 1;
+		for_each_row(lines, [&](offset<Rank> idx) {
+			std::fill(sums.begin(), sums.end(), init);
+			for (std::ptrdiff_t step=0; step<b[Dim]; ++step)
+			{
+				idx[Dim] = step;
+				const T* in = &view_access(src.data(), idx, src.stride());
+				T* out = &view_access(dst.data(), idx, dst.stride());
+				T* sum = sums.data();
+
+				if (in_stride == 1 && out_stride == 1) {
+					for (std::ptrdiff_t i=0; i<n; ++i) {
+						const T value = in[i];
+						if (inclusive) { sum[i] += value; out[i] = sum[i]; }
+						else { out[i] = sum[i]; sum[i] += value; }
+					}
+				}
+				else {
+					for (std::ptrdiff_t i=0; i<n; ++i) {
+						const T value = in[i * in_stride];
+						if (inclusive) { sum[i] += value; out[i * out_stride] = sum[i]; }
+						else { out[i * out_stride] = sum[i]; sum[i] += value; }
+					}
+				}
+			}
+		});
+	}
+
+	// Scans a long row in two passes over equal parts, one to each thread: the first sums each part,
+	// and the second scans each part from the sum of those before it
+	template <typename T>
+	void scan_parallel(const T* in, std::ptrdiff_t in_stride, T* out, std::ptrdiff_t out_stride,
+	                   std::ptrdiff_t n, T init, bool inclusive, unsigned threads)
+	{
+		std::vector<T> totals(threads, T{});
+		parallel_partition(size_t(n), threads, [&](unsigned t, size_t first, size_t last) {
+			T total{};
+			for (size_t i=first; i<last; ++i) total += in[std::ptrdiff_t(i) * in_stride];
+			totals[t] = total;
+		});
+
+		T carry = init;
+		for (T& total : totals)
+		{
+			const T next = carry + total;
+			total = carry;
+			carry = next;
+		}
+
+		parallel_partition(size_t(n), threads, [&](unsigned t, size_t first, size_t last) {
+			const std::ptrdiff_t begin = std::ptrdiff_t(first);
+			scan_row(in + begin * in_stride, in_stride, out + begin * out_stride, out_stride,
+			         std::ptrdiff_t(last - first), totals[t], inclusive);
+		});
+	}
+
+	template <size_t Dim, typename SrcView, typename DstView>
+	void scan(const SrcView& src, const DstView& dst, typename DstView::value_type init, bool inclusive, unsigned threads)
+	{
+		constexpr size_t Rank = SrcView::rank;
+		static_assert(Rank == DstView::rank, "Rank of the source and destination views must match");
+		static_assert(Dim < Rank, "The dimension scanned must be less than the rank of the views");
+
+		using T = typename DstView::value_type;
+		static_assert(std::is_same<typename std::remove_const<typename SrcView::value_type>::type, T>::value,
+		              "Value types of the source and destination views must match");
+
+		const strided_array_view<const T, Rank> from(src);
+		const strided_array_view<T, Rank> to(dst);
+		assert(from.bounds() == to.bounds());
+
+		if (Dim != Rank-1)
+		{
+			scan_outer<Dim>(from, to, init, inclusive);
+			return;
+		}
+
+		const std::ptrdiff_t n = from.bounds()[Rank-1];
+		const std::ptrdiff_t in_stride = from.stride()[Rank-1];
+		const std::ptrdiff_t out_stride = to.stride()[Rank-1];
+
+		threads = default_thread_count(threads);
+		if (Rank == 1 && threads > 1 && n >= scan_parallel_threshold)
+		{
+			scan_parallel(from.data(), in_stride, to.data(), out_stride, n, init, inclusive, threads);
+			return;
+		}
+
+		for_each_row(from.bounds(), [&](const offset<Rank>& idx) {
+			scan_row(&view_access(from.data(), idx, from.stride()), in_stride,
+			         &view_access(to.data(), idx, to.stride()), out_stride, n, init, inclusive);
+		});
+	}
+
+} // namespace
+
+// Scans along the innermost dimension go a row at a time, a vector register at a time where rows
+// are contiguous, and long views of rank 1 divide between threads.  Scans along an outer dimension
+// add a row of the innermost at a time, so vectorize across the lines they cross.  Floating point
+// sums may so be associated differently from a serial loop, and with the number of threads.
+template <size_t Dim, typename SrcView, typename DstView>
+void inclusive_scan(const SrcView& src, const DstView& dst, unsigned threads = 0)
+{
+	scan<Dim>(src, dst, typename DstView::value_type{}, true, threads);
+}
+
+template <size_t Dim, typename SrcView, typename DstView>
+void exclusive_scan(const SrcView& src, const DstView& dst, typename DstView::value_type init = {}, unsigned threads = 0)
+{
+	scan<Dim>(src, dst, init, false, threads);
+}
+
+}
@@ -0,0 +1,131 @@
+#include "array_view/scan.h"
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace std;
+using namespace av;
+
+namespace {
+
+	// The sum along `dim` up to (or, if exclusive, short of) each index, by the bounds iterator
+	template <typename View>
+	vector<typename remove_const<typename View::value_type>::type>
+	serial_scan(const View& src, size_t dim, bool inclusive, typename remove_const<typename View::value_type>::type init)
+	{
+		using T = typename remove_const<typename View::value_type>::type;
+		constexpr size_t Rank = View::rank;
+		vector<T> result(src.size());
+		const array_view<T, Rank> out(result, src.bounds());
+		for (const offset<Rank>& idx : src.bounds())
+		{
+			offset<Rank> prev = idx;
+			--prev[dim];
+			const T before = idx[dim] == 0 ? init : out[prev] + (inclusive ? T{} : src[prev]);
+			out[idx] = before + (inclusive ? src[idx] : T{});
+		}
+		return result;
+	}
+
+	template <typename T, size_t Rank>
+	vector<T> values(const bounds<Rank>& b)
+	{
+		vector<T> vec(b.size());
+		for (size_t i=0; i<vec.size(); ++i) vec[i] = T((i * 7919) % 23) - T(5);
+		return vec;
+	}
+
+} // namespace
+
+TEST(scan_test, Dimensions)
+{
+	// Each dimension of a volume, with rows not a multiple of a vector register
+	const bounds<3> b = {4, 6, 11};
+	const vector<int32_t> input = values<int32_t>(b);
+	const array_view<const int32_t, 3> src(input, b);
+	vector<int32_t> output(b.size());
+	const array_view<int32_t, 3> dst(output, b);
+
+	inclusive_scan<0>(src, dst);
+	EXPECT_EQ(serial_scan(src, 0, true, 0), output);
+	inclusive_scan<1>(src, dst);
+	EXPECT_EQ(serial_scan(src, 1, true, 0), output);
+	inclusive_scan<2>(src, dst);
+	EXPECT_EQ(serial_scan(src, 2, true, 0), output);
+
+	exclusive_scan<0>(src, dst, 100);
+	EXPECT_EQ(serial_scan(src, 0, false, 100), output);
+	exclusive_scan<1>(src, dst);
+	EXPECT_EQ(serial_scan(src, 1, false, 0), output);
+	exclusive_scan<2>(src, dst, -3);
+	EXPECT_EQ(serial_scan(src, 2, false, -3), output);
+}
+
+TEST(scan_test, Types)
+{
+	// Vectorized and not, with values whose sums are exact in floating point
+	const bounds<2> b = {3, 37};
+	const vector<double> doubles = values<double>(b);
+	vector<double> double_out(b.size());
+	exclusive_scan<1>(array_view<const double, 2>(doubles, b), array_view<double, 2>(double_out, b), 0.5);
+	EXPECT_EQ(serial_scan(array_view<const double, 2>(doubles, b), 1, false, 0.5), double_out);
+
+	const vector<float> floats = values<float>(b);
+	vector<float> float_out(b.size());
+	inclusive_scan<1>(array_view<const float, 2>(floats, b), array_view<float, 2>(float_out, b));
+	EXPECT_EQ(serial_scan(array_view<const float, 2>(floats, b), 1, true, 0.f), float_out);
+
+	const vector<int64_t> longs = values<int64_t>(b);
+	vector<int64_t> long_out(b.size());
+	inclusive_scan<1>(array_view<const int64_t, 2>(longs, b), array_view<int64_t, 2>(long_out, b));
+	EXPECT_EQ(serial_scan(array_view<const int64_t, 2>(longs, b), 1, true, 0), long_out);
+
+	const vector<int16_t> shorts = values<int16_t>(b);
+	vector<int16_t> short_out(b.size());
+	exclusive_scan<1>(array_view<const int16_t, 2>(shorts, b), array_view<int16_t, 2>(short_out, b));
+	EXPECT_EQ(serial_scan(array_view<const int16_t, 2>(shorts, b), 1, false, 0), short_out);
+}
+
+TEST(scan_test, StridedInPlace)
+{
+	// The columns of a transposed view, scanned in place
+	const bounds<2> b = {9, 14};
+	vector<int> vec = values<int>(b);
+	const vector<int> input = vec;
+	const strided_array_view<int, 2> transposed(vec.data(), {14, 9}, {1, 14});
+	const strided_array_view<const int, 2> original(input.data(), {14, 9}, {1, 14});
+
+	const vector<int> expected = serial_scan(original, 1, true, 0);
+	inclusive_scan<1>(transposed, transposed);
+	for (const offset<2>& idx : transposed.bounds()) {
+		ASSERT_EQ(expected[size_t(idx[0] * 9 + idx[1])], (transposed[idx]));
+	}
+
+	vec = input;
+	const vector<int> expected_rows = serial_scan(original, 0, false, 0);
+	exclusive_scan<0>(transposed, transposed);
+	for (const offset<2>& idx : transposed.bounds()) {
+		ASSERT_EQ(expected_rows[size_t(idx[0] * 9 + idx[1])], (transposed[idx]));
+	}
+}
+
+TEST(scan_test, Parallel)
+{
+	// Long enough to divide between threads, and the same for any number of them
+	const ptrdiff_t n = (ptrdiff_t{1} << 20) + 13;
+	vector<int64_t> input(static_cast<size_t>(n));
+	iota(input.begin(), input.end(), 0);
+	vector<int64_t> serial(input.size()), parallel(input.size());
+
+	exclusive_scan<0>(array_view<const int64_t>(input), array_view<int64_t>(serial), int64_t{7}, 1);
+	exclusive_scan<0>(array_view<const int64_t>(input), array_view<int64_t>(parallel), int64_t{7}, 3);
+	EXPECT_EQ(serial, parallel);
+	EXPECT_EQ(7 + (n - 1) * (n - 2) / 2, parallel.back());
+
+	inclusive_scan<0>(array_view<int64_t>(input), array_view<int64_t>(input), 4);
+	EXPECT_EQ(n * (n - 1) / 2, input.back());
+	EXPECT_EQ(serial[5] - 7 + 5, input[5]);
+}